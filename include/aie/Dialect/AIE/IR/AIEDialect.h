@@ -196,6 +196,9 @@ std::unique_ptr<OperationPass<DeviceOp>>
 createAIEObjectFifoStatefulTransformPass();
 std::unique_ptr<OperationPass<DeviceOp>>
 createAIEObjectFifoRegisterProcessPass();
+std::unique_ptr<OperationPass<DeviceOp>>
+createAIEObjectFifoDepthSelectionPass();
+std::unique_ptr<OperationPass<DeviceOp>> createAIEDMABDCompactionPass();
 
 /// Generate the code for registering passes.
 #define GEN_PASS_REGISTRATION
@@ -111,6 +111,14 @@ public:
   virtual bool isLegalMemAffinity(int coreCol, int coreRow, int memCol,
                                   int memRow) const = 0;
 
+  /// Return true if the core in the src tile can send values to the core in
+  /// the dst tile through its cascade stream
+  virtual bool isLegalCascade(int srcCol, int srcRow, int dstCol,
+                              int dstRow) const = 0;
+
+  /// Return the width (in bits) of the values sent on the cascade stream.
+  virtual uint32_t getCascadeWidth() const = 0;
+
   /// Return the base address in the local address map of differnet memories.
   virtual uint32_t getMemInternalBaseAddress(TileID src) const = 0;
   virtual uint32_t getMemSouthBaseAddress() const = 0;
@@ -131,6 +139,9 @@ public:
   virtual uint32_t getNumMemTileRows() const = 0;
   /// Return the size (in bytes) of a MemTile.
   virtual uint32_t getMemTileSize() const = 0;
+  /// Return the number of equally sized banks that the data memory of the
+  /// given tile is divided into. Accesses to different banks do not conflict.
+  virtual uint32_t getNumBanks(int col, int row) const = 0;
   /// Return the number of destinations of connections inside a switchbox. These
   /// are the targets of connect operations in the switchbox.
   virtual uint32_t getNumDestSwitchboxConnections(int col, int row,
@@ -176,6 +187,9 @@ public:
 
   bool isLegalMemAffinity(int coreCol, int coreRow, int memCol,
                           int memRow) const override;
+  bool isLegalCascade(int srcCol, int srcRow, int dstCol,
+                      int dstRow) const override;
+  uint32_t getCascadeWidth() const override { return 384; }
 
   uint32_t getMemInternalBaseAddress(TileID src) const override {
     bool IsEvenRow = ((src.second % 2) == 0);
@@ -195,6 +209,7 @@ public:
   uint32_t getNumBDs(int col, int row) const override { return 16; }
   uint32_t getNumMemTileRows() const override { return 0; }
   uint32_t getMemTileSize() const override { return 0; }
+  uint32_t getNumBanks(int col, int row) const override { return 8; }
 
   uint32_t getNumDestSwitchboxConnections(int col, int row,
                                           WireBundle bundle) const override;
@@ -226,6 +241,9 @@ public:
 
   bool isLegalMemAffinity(int coreCol, int coreRow, int memCol,
                           int memRow) const override;
+  bool isLegalCascade(int srcCol, int srcRow, int dstCol,
+                      int dstRow) const override;
+  uint32_t getCascadeWidth() const override { return 512; }
 
   uint32_t getMemInternalBaseAddress(TileID src) const override {
     return getMemEastBaseAddress();
@@ -242,6 +260,9 @@ public:
     return isMemTile(col, row) ? 48 : 16;
   }
   uint32_t getMemTileSize() const override { return 0x00080000; }
+  uint32_t getNumBanks(int col, int row) const override {
+    return isMemTile(col, row) ? 16 : 8;
+  }
 
   uint32_t getNumDestSwitchboxConnections(int col, int row,
                                           WireBundle bundle) const override;
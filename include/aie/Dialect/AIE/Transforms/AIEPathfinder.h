@@ -16,29 +16,13 @@
 #include <utility> //for std::pair
 #include <vector>
 
-// builds against at least boost graph 1.7.1
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-local-typedef"
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-#pragma GCC diagnostic ignored "-Wdeprecated-copy"
-#pragma GCC diagnostic ignored "-Wsuggest-override"
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/dijkstra_shortest_paths.hpp>
-#include <boost/graph/graph_traits.hpp>
-#pragma GCC diagnostic pop
-
 #include "aie/Dialect/AIE/IR/AIEDialect.h" // for WireBundle and Port
 
 namespace xilinx {
 namespace AIE {
 
-using namespace boost;
-
 struct Switchbox { // acts as a vertex
   unsigned short col, row;
-  // int dist;
-  unsigned int pred; // predecessor for dijkstra's
-  bool processed;    // denotes this switchbox has already been processed
 };
 
 struct Channel { // acts as an edge
@@ -49,17 +33,71 @@ struct Channel { // acts as an edge
   std::set<short> fixed_capacity;     // channels not available to the algorithm
   unsigned short over_capacity_count; // history of Channel being over capacity
   WireBundle bundle;
+  unsigned int src, target; // indices of the Switchboxes this Channel joins
 };
 
-// create a graph type that uses Switchboxes as vertices and Channels as edges
-typedef adjacency_list<vecS, vecS, bidirectionalS, Switchbox, Channel>
-    SwitchboxGraph;
+struct SearchState;
+
+// SwitchboxGraph is a flat routing graph for the rectangular AIE switchbox
+// mesh. Switchboxes are stored row-major, so the vertex of tile (col, row) is
+// found by index arithmetic. Every switchbox has at most one outgoing Channel
+// per cardinal direction, which is found through a (vertex, direction) table.
+// Channel capacities come from the switchbox connections of the target model,
+// and directions without any connection (e.g. East/West of AIE2 mem tiles)
+// have no Channel.
+// The outgoing Channels of each vertex are also kept in a compressed adjacency
+// array, in South, West, East, North order, which is the order in which the
+// searches in Pathfinder relax them.
+class SwitchboxGraph {
+public:
+  static constexpr int NO_EDGE = -1;
+
+  void initialize(int maxcol, int maxrow,
+                  const AIETargetModel *targetModel = nullptr);
+
+  unsigned numVertices() const { return vertices.size(); }
+  unsigned numEdges() const { return edges.size(); }
+  int numCols() const { return cols; }
+  int numRows() const { return rows; }
+
+  // return the vertex of tile (col, row), or -1 if outside the grid
+  int vertexIndex(int col, int row) const {
+    if (col < 0 || row < 0 || col >= cols || row >= rows)
+      return -1;
+    return row * cols + col;
+  }
+
+  Switchbox &vertex(unsigned v) { return vertices[v]; }
+  Channel &edge(unsigned e) { return edges[e]; }
+  std::vector<Switchbox> &getVertices() { return vertices; }
+  std::vector<Channel> &getEdges() { return edges; }
 
-typedef graph_traits<SwitchboxGraph>::vertex_descriptor vertex_descriptor;
-typedef graph_traits<SwitchboxGraph>::edge_descriptor edge_descriptor;
-typedef graph_traits<SwitchboxGraph>::vertex_iterator vertex_iterator;
-typedef graph_traits<SwitchboxGraph>::edge_iterator edge_iterator;
-typedef graph_traits<SwitchboxGraph>::in_edge_iterator in_edge_iterator;
+  // outgoing Channels of a vertex, as indices into the edge array
+  const unsigned *outEdgesBegin(unsigned v) const {
+    return outEdgeList.data() + outEdgeOffsets[v];
+  }
+  const unsigned *outEdgesEnd(unsigned v) const {
+    return outEdgeList.data() + outEdgeOffsets[v + 1];
+  }
+
+  // return the Channel leaving vertex v in the given direction, or NO_EDGE
+  int edgeIndex(unsigned v, WireBundle bundle) const;
+  // return the Channel joining two adjacent vertices, or NO_EDGE
+  int edgeBetween(unsigned src, unsigned dst) const;
+
+  // find the shortest paths from src to dsts, using Channel demands as weights
+  void shortestPaths(SearchState &state, unsigned src,
+                     const std::vector<unsigned> &dsts, int heuristicTarget,
+                     int priority) const;
+
+private:
+  int cols = 0, rows = 0;
+  std::vector<Switchbox> vertices;
+  std::vector<Channel> edges;
+  std::vector<int> edgeByDirection; // 4 entries per vertex
+  std::vector<unsigned> outEdgeOffsets;
+  std::vector<unsigned> outEdgeList;
+};
 
 typedef std::pair<int, int> Coord;
 // A SwitchSetting defines the required settings for a Switchbox for a flow
@@ -73,34 +111,141 @@ typedef std::map<Switchbox *, SwitchSetting> SwitchSettings;
 typedef std::pair<Switchbox *, Port> PathEndPoint;
 typedef std::pair<PathEndPoint, std::vector<PathEndPoint>> Flow;
 
+// A ChannelPath is the sequence of Channels, as indices into the edge array of
+// the SwitchboxGraph, that connects one destination of a flow to its source
+// or to a Switchbox already on the route of the flow.
+typedef std::vector<unsigned> ChannelPath;
+
+struct PathfinderOptions {
+  // Route with a goal-directed A* search using a Manhattan distance heuristic
+  // instead of a full Dijkstra search from each source. Routes may differ from
+  // the default search where several paths have the same cost.
+  bool useAStar = false;
+  // After the first iteration, only rip up and reroute the flows that use an
+  // over-capacity Channel and keep the routes of all other flows.
+  bool incremental = false;
+  // Number of flows routed concurrently on the thread pool of the context.
+  // Routes only depend on the number of threads, not on their scheduling.
+  unsigned numThreads = 1;
+  MLIRContext *context = nullptr;
+};
+
+// Scratch state of a shortest path search. Each thread routing flows has its
+// own, so that the SwitchboxGraph is only read during the search.
+struct SearchState {
+  std::vector<float> distance;
+  std::vector<float> heapKey;
+  std::vector<unsigned char> color;
+  std::vector<size_t> indexInHeap;
+  std::vector<unsigned> heap;
+  std::vector<unsigned> pred;  // predecessor for dijkstra's
+  std::vector<bool> processed; // vertex is already on the route of the flow
+};
+
+// Statistics of one iteration of the negotiation loop in findPaths
+struct PathfinderIterationStats {
+  unsigned flowsRouted;   // flows ripped up and routed again
+  unsigned overusedEdges; // Channels over capacity after routing
+};
+
 class Pathfinder {
 private:
   SwitchboxGraph graph;
   std::vector<Flow> flows;
+  std::vector<int> flowPriorities; // routing priority of each flow
   bool maxIterReached;
+  PathfinderOptions options;
+  // the current route of each flow, one ChannelPath per destination
+  std::vector<std::vector<ChannelPath>> routes;
+  std::vector<PathfinderIterationStats> iterationStats;
+  // one search state per thread
+  std::vector<SearchState> searchStates;
+  // in parallel, each thread routes this many flows between two commits
+  static constexpr unsigned flowsPerThread = 16;
+
+  unsigned vertexOf(Switchbox *sb) { return sb - graph.getVertices().data(); }
+  void findRoute(unsigned flowIndex, SearchState &state);
+  void commitFlow(unsigned flowIndex, SwitchSettings &settings);
+  void commitPath(const ChannelPath &path, SwitchSettings &settings);
+  bool usesOverusedChannel(unsigned flowIndex);
+  bool usesFullChannel(unsigned flowIndex);
 
 public:
   Pathfinder();
-  Pathfinder(int maxcol, int maxrow);
-  void initializeGraph(int maxcol, int maxrow);
-  void addFlow(Coord srcCoords, Port srcPort, Coord dstCoords, Port dstPort);
+  Pathfinder(int maxcol, int maxrow,
+             const AIETargetModel *targetModel = nullptr);
+  void initializeGraph(int maxcol, int maxrow,
+                       const AIETargetModel *targetModel = nullptr);
+  void addFlow(Coord srcCoords, Port srcPort, Coord dstCoords, Port dstPort,
+               int priority = 0);
   void addFixedConnection(Coord coord, Port port);
   bool isLegal();
   std::map<PathEndPoint, SwitchSettings>
   findPaths(const int MAX_ITERATIONS = 1000);
 
+  void setOptions(const PathfinderOptions &opts) { options = opts; }
+  const std::vector<PathfinderIterationStats> &getIterationStats() const {
+    return iterationStats;
+  }
+
   Switchbox *getSwitchbox(TileID coords) {
-    auto vpair = vertices(graph);
-    Switchbox *sb;
-    for (vertex_iterator v = vpair.first; v != vpair.second; v++) {
-      sb = &graph[*v];
-      if (sb->col == coords.first && sb->row == coords.second)
-        return sb;
-    }
-    return nullptr;
+    int v = graph.vertexIndex(coords.first, coords.second);
+    if (v < 0)
+      return nullptr;
+    return &graph.vertex(v);
   }
 };
 
+// A PacketFlow delivers the packets with the given ID that enter the
+// Switchbox of its source at the source port to any number of destinations
+struct PacketFlow {
+  PathEndPoint source;
+  int id;
+  std::vector<PathEndPoint> dests;
+};
+
+// PacketPathfinder routes packet flows on the same graph and with the same
+// search as Pathfinder. Up to maxIDsPerPort packet flows can share a port, so
+// instead of negotiating exclusive use of Channels, the demand of a Channel
+// grows with the number of packet flows per port available to packets, and
+// with the number of packet flows leaving the Switchbox, which all need an
+// arbiter and msel there. Flows are ripped up and rerouted until no Channel
+// carries more flows than its ports can, and no Switchbox needs more arbiters
+// and msels, or slots of a slave port, than it has.
+class PacketPathfinder {
+public:
+  static constexpr unsigned maxIDsPerPort = 32;
+  static constexpr unsigned numAMSels = 24; // 6 arbiters with 4 msels each
+  static constexpr unsigned numSlotsPerPort = 4;
+
+  PacketPathfinder(int maxcol, int maxrow,
+                   const AIETargetModel *targetModel = nullptr);
+  void addFlow(Coord srcCoords, Port srcPort, int id, Coord dstCoords,
+               Port dstPort);
+  // ports already used by circuit-switched connections
+  void addFixedConnection(Coord coord, Port port);
+  // returns false if the flows could not be routed within capacity
+  bool findPaths(const int MAX_ITERATIONS = 1000);
+  // the connections of the routed flows in each Switchbox, together with the
+  // ID of the packet flow they carry
+  std::map<Coord, std::vector<std::pair<Connect, int>>> getConnections();
+
+private:
+  SwitchboxGraph graph;
+  std::vector<PacketFlow> flows;
+  std::vector<std::vector<ChannelPath>> routes;
+  SearchState state;
+  std::vector<unsigned> channelLoad;   // packet flows using each Channel
+  std::vector<unsigned> switchboxLoad; // packet flows leaving each Switchbox
+
+  unsigned vertexOf(Switchbox *sb) { return sb - graph.getVertices().data(); }
+  unsigned availablePorts(const Channel &ch) const;
+  void updateDemand(unsigned e);
+  bool findRoute(unsigned flowIndex);
+  void commitFlow(unsigned flowIndex);
+  bool checkSwitchboxes();
+};
+
 } // namespace AIE
 } // namespace xilinx
 #endif
@@ -430,6 +430,15 @@ LogicalResult xilinx::AIE::ObjectFifoCreateOp::verify() {
                          "and for each consumer.");
   }
 
+  if (getDimensionsToStream() || getDimensionsFromStreamPerConsumer()) {
+    if (getTargetModel(*this).getTargetArch() == AIEArch::AIE1)
+      return emitOpError("DMA dimensions are not supported on AIE1 devices");
+    if (auto dims = getDimensionsFromStreamPerConsumer())
+      if (dims->size() != getConsumerTiles().size())
+        return emitOpError("does not have fromStream dimensions for each "
+                           "consumer.");
+  }
+
   return success();
 }
 xilinx::AIE::TileOp xilinx::AIE::ObjectFifoCreateOp::getProducerTileOp() {
@@ -1405,6 +1414,30 @@ LogicalResult xilinx::AIE::UseLockOp::verify() {
   }
 }
 
+// Cascade operations can be used in a CoreOp, or some FuncOp called from a
+// CoreOp
+LogicalResult xilinx::AIE::GetCascadeOp::verify() {
+  if (HasSomeParent<xilinx::AIE::CoreOp, func::FuncOp>::verifyTrait(*this)
+          .failed())
+    return (*this)->emitOpError(
+        "expects some parent op to be one of AIE::core or func::func");
+  unsigned width = getTargetModel(*this).getCascadeWidth();
+  if (!getCascadeValue().getType().isInteger(width))
+    return emitOpError("expects a cascade value of ") << width << " bits";
+  return success();
+}
+
+LogicalResult xilinx::AIE::PutCascadeOp::verify() {
+  if (HasSomeParent<xilinx::AIE::CoreOp, func::FuncOp>::verifyTrait(*this)
+          .failed())
+    return (*this)->emitOpError(
+        "expects some parent op to be one of AIE::core or func::func");
+  unsigned width = getTargetModel(*this).getCascadeWidth();
+  if (!getCascadeValue().getType().isInteger(width))
+    return emitOpError("expects a cascade value of ") << width << " bits";
+  return success();
+}
+
 #include "aie/Dialect/AIE/IR/AIEEnums.cpp.inc"
 #include "aie/Dialect/AIE/IR/AIEInterfaces.cpp.inc"
 
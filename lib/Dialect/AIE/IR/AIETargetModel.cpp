@@ -103,6 +103,16 @@ bool AIE1TargetModel::isLegalMemAffinity(int coreCol, int coreRow, int memCol,
 
   return IsMemSouth || IsMemNorth || IsMemWest || IsMemEast;
 }
+bool AIE1TargetModel::isLegalCascade(int srcCol, int srcRow, int dstCol,
+                                     int dstRow) const {
+  // The cascade streams of a row run from west to east in odd rows and from
+  // east to west in even rows.
+  if (!isCoreTile(srcCol, srcRow) || !isCoreTile(dstCol, dstRow) ||
+      srcRow != dstRow)
+    return false;
+  bool IsOddRow = ((srcRow % 2) == 1);
+  return dstCol == (IsOddRow ? srcCol + 1 : srcCol - 1);
+}
 uint32_t
 AIE1TargetModel::getNumDestSwitchboxConnections(int col, int row,
                                                 WireBundle bundle) const {
@@ -325,6 +335,14 @@ bool AIE2TargetModel::isLegalMemAffinity(int coreCol, int coreRow, int memCol,
     return (IsMemSouth && !isMemTile(memCol, memRow)) || IsMemNorth ||
            IsMemWest || IsMemEast;
 }
+bool AIE2TargetModel::isLegalCascade(int srcCol, int srcRow, int dstCol,
+                                     int dstRow) const {
+  // A cascade stream leaves a core to the east or to the south.
+  if (!isCoreTile(srcCol, srcRow) || !isCoreTile(dstCol, dstRow))
+    return false;
+  return (dstRow == srcRow && dstCol == srcCol + 1) ||
+         (dstCol == srcCol && dstRow == srcRow - 1);
+}
 uint32_t
 AIE2TargetModel::getNumDestSwitchboxConnections(int col, int row,
                                                 WireBundle bundle) const {
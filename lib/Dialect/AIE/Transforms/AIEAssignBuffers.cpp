@@ -12,9 +12,13 @@
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/LoopLikeInterface.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Support/MathExtras.h"
 
 #define DEBUG_TYPE "aie-assign-buffers"
 
@@ -37,12 +41,414 @@ static int64_t assignAddress(AIE::BufferOp op, int64_t lastAddress,
   return endAddr;
 }
 
+// Pairs of buffers that are accessed at the same time, in both orders.
+typedef DenseSet<std::pair<Operation *, Operation *>> ConcurrentBuffers;
+
+// Buffers are accessed concurrently if they are used by the same DMA channel,
+// like the ping and pong buffers of an objectFifo, or in the same loop of a
+// core, like the operands of a kernel.
+static void collectConcurrentBuffers(DeviceOp device,
+                                     ConcurrentBuffers &concurrent) {
+  auto addGroup = [&](ArrayRef<Operation *> group) {
+    for (Operation *a : group)
+      for (Operation *b : group)
+        if (a != b)
+          concurrent.insert(std::make_pair(a, b));
+  };
+
+  // Follow the chain of block descriptors of each DMA channel.
+  device.walk([&](DMAStartOp dmaStart) {
+    SmallVector<Operation *, 4> group;
+    SmallPtrSet<Block *, 8> visited;
+    Block *bd = dmaStart.getDest();
+    while (bd && visited.insert(bd).second) {
+      for (auto dmaBd : bd->getOps<DMABDOp>())
+        if (auto buffer = dmaBd.getBuffer().getDefiningOp<BufferOp>())
+          group.push_back(buffer);
+      Operation *next = bd->getTerminator();
+      bd = next->getNumSuccessors() == 1 ? next->getSuccessor(0) : nullptr;
+    }
+    addGroup(group);
+  });
+
+  // Group the buffers used in cores by their innermost loop.
+  DenseMap<Operation *, SmallVector<Operation *, 4>> scopes;
+  for (auto buffer : device.getOps<BufferOp>())
+    for (Operation *user : buffer->getUsers()) {
+      Operation *scope = user->getParentOfType<CoreOp>();
+      if (!scope)
+        continue;
+      if (auto loop = user->getParentOfType<LoopLikeOpInterface>())
+        scope = loop;
+      auto &group = scopes[scope];
+      if (!llvm::is_contained(group, buffer.getOperation()))
+        group.push_back(buffer);
+    }
+  for (auto &scope : scopes)
+    addGroup(scope.second);
+}
+
+// The live range of a buffer that is only used by one core, as positions in a
+// pre-order walk of the core. Buffers without a live range are always live.
+struct LiveRange {
+  Operation *core;
+  int64_t start, end;
+};
+typedef DenseMap<Operation *, LiveRange> LiveRanges;
+
+// Collect the users of a buffer and of the memrefs derived from it, and
+// optionally these memrefs.
+static void collectUsers(BufferOp buffer, SmallVectorImpl<Operation *> &users,
+                         DenseSet<Value> *memrefs = nullptr) {
+  SmallVector<Value, 4> worklist = {buffer.getResult()};
+  while (!worklist.empty()) {
+    Value memref = worklist.pop_back_val();
+    if (memrefs)
+      memrefs->insert(memref);
+    for (Operation *user : memref.getUsers()) {
+      users.push_back(user);
+      for (Value result : user->getResults())
+        if (result.getType().isa<MemRefType>())
+          worklist.push_back(result);
+    }
+  }
+}
+
+// Return whether an operation may read and whether it may write the given
+// memrefs. Operations with unknown effects, like calls, may do both.
+static std::pair<bool, bool> getAccess(Operation *op,
+                                       const DenseSet<Value> &memrefs) {
+  auto effectOp = dyn_cast<MemoryEffectOpInterface>(op);
+  if (!effectOp)
+    return std::make_pair(true, true);
+  SmallVector<MemoryEffects::EffectInstance, 4> effects;
+  effectOp.getEffects(effects);
+  bool reads = false, writes = false;
+  for (auto &effect : effects) {
+    if (effect.getValue() && !memrefs.count(effect.getValue()))
+      continue;
+    reads |= isa<MemoryEffects::Read>(effect.getEffect());
+    writes |= isa<MemoryEffects::Write>(effect.getEffect());
+  }
+  return std::make_pair(reads, writes);
+}
+
+// Return the core that all the users of a buffer are in, if there is one.
+static CoreOp getOnlyCore(ArrayRef<Operation *> users) {
+  if (users.empty())
+    return nullptr;
+  auto core = users.front()->getParentOfType<CoreOp>();
+  if (llvm::any_of(users, [&](Operation *user) {
+        return user->getParentOfType<CoreOp>() != core;
+      }))
+    return nullptr;
+  return core;
+}
+
+// Buffers used by a DMA or by more than one core are always live, and so are
+// buffers without uses, which kernels may access by name. The live range of
+// any other buffer spans the uses of the buffer and of the memrefs derived
+// from it, widened to the outermost loop around them, since the contents of
+// the buffer may be carried from one iteration to the next. A buffer that
+// may be read before the core writes it holds contents from before the core
+// starts, like inputs written by the host, and is live from the start of the
+// core. A buffer that the core writes last may be read by the host when the
+// core is done, and is live until the end of the core.
+static void computeLiveRanges(DeviceOp device, LiveRanges &liveRanges) {
+  DenseMap<Operation *, int64_t> position;
+  for (auto core : device.getOps<CoreOp>()) {
+    int64_t counter = 0;
+    core.walk<WalkOrder::PreOrder>(
+        [&](Operation *op) { position[op] = counter++; });
+  }
+  auto lastPosition = [&](Operation *op) {
+    int64_t last = position[op];
+    op->walk([&](Operation *nested) {
+      last = std::max(last, position[nested]);
+    });
+    return last;
+  };
+
+  for (auto buffer : device.getOps<BufferOp>()) {
+    SmallVector<Operation *, 8> users;
+    DenseSet<Value> memrefs;
+    collectUsers(buffer, users, &memrefs);
+    Operation *core = getOnlyCore(users);
+    if (!core)
+      continue;
+
+    // Find the innermost block around all the uses.
+    Block *block = users.front()->getBlock();
+    for (Operation *user : users)
+      while (!block->findAncestorOpInBlock(*user))
+        block = block->getParentOp()->getBlock();
+    Operation *first = nullptr, *last = nullptr;
+    for (Operation *user : users) {
+      Operation *op = block->findAncestorOpInBlock(*user);
+      if (!first || position[op] < position[first])
+        first = op;
+      if (!last || position[op] > position[last])
+        last = op;
+    }
+    // Loops and control flow between blocks may repeat the uses.
+    for (Region *region = block->getParent();;) {
+      Operation *parent = region->getParentOp();
+      if (!region->hasOneBlock() || isa<LoopLikeOpInterface>(parent))
+        first = last = parent;
+      if (parent == core)
+        break;
+      region = parent->getParentRegion();
+    }
+    int64_t start = position[first], end = lastPosition(last);
+
+    // Find the first and last accesses, skipping the views of the buffer.
+    Operation *firstAccess = nullptr, *lastAccess = nullptr;
+    for (Operation *user : users) {
+      auto access = getAccess(user, memrefs);
+      if (!access.first && !access.second)
+        continue;
+      if (!firstAccess || position[user] < position[firstAccess])
+        firstAccess = user;
+      if (!lastAccess || position[user] > position[lastAccess])
+        lastAccess = user;
+    }
+    if (!firstAccess || getAccess(firstAccess, memrefs).first)
+      start = position[core];
+    if (!lastAccess || getAccess(lastAccess, memrefs).second)
+      end = lastPosition(core);
+    liveRanges[buffer] = {core, start, end};
+  }
+}
+
+// Return true if two buffers may be live at the same time.
+static bool interfere(const LiveRanges &liveRanges, Operation *a,
+                      Operation *b) {
+  auto rangeA = liveRanges.find(a);
+  auto rangeB = liveRanges.find(b);
+  if (rangeA == liveRanges.end() || rangeB == liveRanges.end())
+    return true;
+  return rangeA->second.core != rangeB->second.core ||
+         (rangeA->second.start <= rangeB->second.end &&
+          rangeB->second.start <= rangeA->second.end);
+}
+
+// Return the first and last memory bank holding a buffer.
+static std::pair<int64_t, int64_t> getBanks(int64_t address, int64_t size,
+                                            int64_t bankSize) {
+  return std::make_pair(address / bankSize,
+                        (address + std::max<int64_t>(size, 1) - 1) / bankSize);
+}
+
 struct AIEAssignBufferAddressesPass
     : public AIEAssignBufferAddressesBase<AIEAssignBufferAddressesPass> {
   void getDependentDialects(::mlir::DialectRegistry &registry) const override {
     registry.insert<func::FuncDialect>();
     registry.insert<xilinx::AIE::AIEDialect>();
   }
+
+  // Place the buffers, largest first, at the lowest aligned address where they
+  // overlap neither the stack nor a buffer that may be live at the same time.
+  // Without live ranges, all buffers are live at the same time. With bank-aware
+  // placement, the search starts at each bank in turn, and the buffer goes to
+  // the bank that holds the fewest buffers it is accessed concurrently with.
+  // Returns the buffers that could be placed, which are all the buffers unless
+  // the memory is full.
+  SmallVector<BufferOp, 4>
+  placeBuffers(ArrayRef<BufferOp> buffers, int stacksize, int64_t memorySize,
+               int numBanks, const ConcurrentBuffers &concurrent,
+               const LiveRanges *liveRanges, OpBuilder &builder) {
+    uint64_t alignment = std::max(1u, (unsigned)clAlignment);
+    int64_t bankSize = memorySize / numBanks;
+    SmallVector<BufferOp, 4> placed;
+
+    for (auto buffer : buffers) {
+      int64_t size = buffer.getAllocationSize();
+      int64_t bestAddress = -1;
+      unsigned bestConflicts = 0;
+      for (int bank = 0; bank < (clBankAware ? numBanks : 1); bank++) {
+        int64_t address = llvm::alignTo(bank * bankSize, alignment);
+        for (bool moved = true; moved;) {
+          moved = false;
+          if (address < stacksize) {
+            address = llvm::alignTo(stacksize, alignment);
+            moved = true;
+          }
+          for (auto other : placed) {
+            int64_t otherEnd = other.address() + other.getAllocationSize();
+            if (address < otherEnd && other.address() < address + size &&
+                (!liveRanges || interfere(*liveRanges, buffer, other))) {
+              address = llvm::alignTo(otherEnd, alignment);
+              moved = true;
+            }
+          }
+        }
+        if (address + size > memorySize)
+          continue;
+
+        auto banks = getBanks(address, size, bankSize);
+        unsigned conflicts = 0;
+        for (auto other : placed) {
+          auto otherBanks =
+              getBanks(other.address(), other.getAllocationSize(), bankSize);
+          if (concurrent.count(std::make_pair(buffer.getOperation(),
+                                              other.getOperation())) &&
+              banks.first <= otherBanks.second &&
+              otherBanks.first <= banks.second)
+            conflicts++;
+        }
+        if (bestAddress < 0 || conflicts < bestConflicts) {
+          bestAddress = address;
+          bestConflicts = conflicts;
+        }
+      }
+      if (bestAddress < 0)
+        break;
+      assignAddress(buffer, bestAddress, builder);
+      placed.push_back(buffer);
+    }
+
+    // Count the bytes that overlaid buffers share.
+    SmallVector<std::pair<int64_t, int64_t>, 8> ranges;
+    for (auto buffer : placed)
+      ranges.push_back(std::make_pair(
+          buffer.address(), buffer.address() + buffer.getAllocationSize()));
+    std::sort(ranges.begin(), ranges.end());
+    int64_t covered = 0;
+    for (auto range : ranges) {
+      numOverlaidBytes += range.second - range.first;
+      covered = std::max(covered, range.first);
+      if (range.second > covered) {
+        numOverlaidBytes -= range.second - covered;
+        covered = range.second;
+      }
+    }
+    return placed;
+  }
+
+  // Count the pairs of concurrently accessed buffers that share a bank, and
+  // report the banks of each buffer if requested.
+  void checkBanks(ArrayRef<BufferOp> buffers, int64_t memorySize, int numBanks,
+                  const ConcurrentBuffers &concurrent) {
+    int64_t bankSize = memorySize / numBanks;
+    for (unsigned i = 0; i < buffers.size(); i++) {
+      auto banks = getBanks(buffers[i].address(),
+                            buffers[i].getAllocationSize(), bankSize);
+      for (unsigned j = i + 1; j < buffers.size(); j++) {
+        auto otherBanks = getBanks(buffers[j].address(),
+                                   buffers[j].getAllocationSize(), bankSize);
+        if (concurrent.count(std::make_pair(buffers[i].getOperation(),
+                                            buffers[j].getOperation())) &&
+            banks.first <= otherBanks.second &&
+            otherBanks.first <= banks.second)
+          numBankConflicts++;
+      }
+      if (clBankReport) {
+        auto remark = buffers[i].emitRemark()
+                      << "placed at 0x" << llvm::utohexstr(buffers[i].address())
+                      << " in bank " << banks.first;
+        if (banks.second != banks.first)
+          remark << "-" << banks.second;
+        remark << " of " << numBanks;
+      }
+    }
+  }
+
+  // Move buffers that only one core uses out of tiles whose memory is too
+  // small for their buffers, into a memory module of a neighbouring core tile
+  // that the core can access and that has enough free space. The space needed
+  // in each tile is estimated as for packing all its buffers after the stack.
+  void spillBuffers(DeviceOp device, OpBuilder &builder) {
+    const auto &targetModel = device.getTargetModel();
+    uint64_t alignment =
+        clBankAware || clOverlay ? std::max(1u, (unsigned)clAlignment) : 1;
+    int64_t memorySize = targetModel.getLocalMemorySize();
+
+    DenseMap<TileID, TileOp> tiles;
+    DenseMap<TileID, int64_t> usage;
+    for (auto tile : device.getOps<TileOp>()) {
+      TileID coord = std::make_pair(tile.colIndex(), tile.rowIndex());
+      tiles[coord] = tile;
+      if (auto core = tile.getCoreOp())
+        usage[coord] = llvm::alignTo(core.getStackSize(), alignment);
+    }
+    for (auto buffer : device.getOps<BufferOp>()) {
+      TileOp tile = buffer.getTileOp();
+      usage[std::make_pair(tile.colIndex(), tile.rowIndex())] +=
+          llvm::alignTo(buffer.getAllocationSize(), alignment);
+    }
+
+    SmallVector<TileOp, 16> fullTiles;
+    for (auto tile : device.getOps<TileOp>())
+      if (!tile.isMemTile() &&
+          usage[std::make_pair(tile.colIndex(), tile.rowIndex())] > memorySize)
+        fullTiles.push_back(tile);
+
+    for (auto tile : fullTiles) {
+      TileID coord = std::make_pair(tile.colIndex(), tile.rowIndex());
+      if (usage[coord] <= memorySize)
+        continue;
+      SmallVector<BufferOp, 4> buffers;
+      for (auto buffer : device.getOps<BufferOp>())
+        if (buffer.getTileOp() == tile)
+          buffers.push_back(buffer);
+      std::stable_sort(buffers.begin(), buffers.end(),
+                       [](BufferOp a, BufferOp b) {
+                         return a.getAllocationSize() > b.getAllocationSize();
+                       });
+
+      for (auto buffer : buffers) {
+        if (usage[coord] <= memorySize)
+          break;
+        SmallVector<Operation *, 8> users;
+        collectUsers(buffer, users);
+        CoreOp core = getOnlyCore(users);
+        if (!core)
+          continue;
+        TileOp coreTile = core.getTileOp();
+        TileID coreCoord =
+            std::make_pair(coreTile.colIndex(), coreTile.rowIndex());
+        int64_t size = llvm::alignTo(buffer.getAllocationSize(), alignment);
+
+        // Pick the accessible memory with the most free space.
+        Optional<TileID> best;
+        for (auto neighbour : {targetModel.getMemSouth(coreCoord),
+                               targetModel.getMemWest(coreCoord),
+                               targetModel.getMemNorth(coreCoord),
+                               targetModel.getMemEast(coreCoord)}) {
+          if (!neighbour || *neighbour == coord ||
+              !targetModel.isCoreTile(neighbour->first, neighbour->second) ||
+              !targetModel.isLegalMemAffinity(coreCoord.first,
+                                              coreCoord.second,
+                                              neighbour->first,
+                                              neighbour->second) ||
+              usage[*neighbour] + size > memorySize)
+            continue;
+          if (!best || usage[*neighbour] < usage[*best])
+            best = neighbour;
+        }
+        if (!best)
+          continue;
+
+        TileOp &newTile = tiles[*best];
+        if (!newTile) {
+          builder.setInsertionPointToStart(device.getBody());
+          newTile = builder.create<TileOp>(builder.getUnknownLoc(),
+                                           best->first, best->second);
+        } else if (buffer->isBeforeInBlock(newTile)) {
+          newTile->moveBefore(buffer);
+        }
+        buffer.getTileMutable().assign(newTile.getResult());
+        usage[coord] -= size;
+        usage[*best] += size;
+        numSpilledBuffers++;
+        LLVM_DEBUG(llvm::dbgs()
+                   << "Spill " << buffer.name() << " from tile ("
+                   << coord.first << ", " << coord.second << ") to tile ("
+                   << best->first << ", " << best->second << ")\n");
+      }
+    }
+  }
+
   void runOnOperation() override {
     DeviceOp device = getOperation();
     OpBuilder builder = OpBuilder::atBlockEnd(device.getBody());
@@ -57,6 +463,15 @@ struct AIEAssignBufferAddressesPass
       }
     }
 
+    if (clSpill)
+      spillBuffers(device, builder);
+
+    ConcurrentBuffers concurrent;
+    collectConcurrentBuffers(device, concurrent);
+    LiveRanges liveRanges;
+    if (clOverlay)
+      computeLiveRanges(device, liveRanges);
+
     for (auto tile : device.getOps<TileOp>()) {
       const auto &target_model = getTargetModel(tile);
       int max_data_memory_size = 0;
@@ -83,8 +498,19 @@ struct AIEAssignBufferAddressesPass
         stacksize = core.getStackSize();
         address += stacksize;
       }
-      for (auto buffer : buffers)
-        address = assignAddress(buffer, address, builder);
+      int numBanks =
+          target_model.getNumBanks(tile.colIndex(), tile.rowIndex());
+      SmallVector<BufferOp, 4> placed(buffers);
+      if (clBankAware || clOverlay) {
+        placed = placeBuffers(buffers, stacksize, max_data_memory_size,
+                              numBanks, concurrent,
+                              clOverlay ? &liveRanges : nullptr, builder);
+        if (placed.size() < buffers.size())
+          address = max_data_memory_size + 1;
+      } else {
+        for (auto buffer : buffers)
+          address = assignAddress(buffer, address, builder);
+      }
       if (address > max_data_memory_size) {
         InFlightDiagnostic error =
             tile.emitOpError("allocated buffers exceeded available memory\n");
@@ -100,11 +526,16 @@ struct AIEAssignBufferAddressesPass
         else
           error << "(no stack allocated)\n";
 
-        for (auto buffer : buffers)
+        for (auto buffer : placed)
           printbuffer(buffer.name(), buffer.address(),
                       buffer.getAllocationSize());
+        for (unsigned i = placed.size(); i < buffers.size(); i++)
+          note << "\t" << buffers[i].name() << " \t: does not fit ("
+               << buffers[i].getAllocationSize() << " bytes)\n";
         return signalPassFailure();
       }
+      if (max_data_memory_size > 0)
+        checkBanks(buffers, max_data_memory_size, numBanks, concurrent);
     }
   }
 };
@@ -152,13 +152,29 @@ struct AIEPutCascadeToStdLowering : public OpConversionPattern<PutCascadeOp> {
   matchAndRewrite(PutCascadeOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     Operation *Op = op.getOperation();
+    auto device = op->getParentOfType<DeviceOp>();
+    if (!device)
+      return module.emitOpError("Device Not found!");
+    bool isAIE2 = device.getTargetModel().getTargetArch() == AIEArch::AIE2;
 
-    std::string funcName = "llvm.aie.put.mcd";
+    std::string funcName =
+        isAIE2 ? "llvm.aie2.mcd.write.vec" : "llvm.aie.put.mcd";
     auto putMCDFunc = module.lookupSymbol<func::FuncOp>(funcName);
     if (!putMCDFunc)
       return module.emitOpError("Could not find the intrinsic function!");
     SmallVector<Value, 2> args;
     args.push_back(op.getCascadeValue());
+    if (isAIE2) {
+      // The 512-bit cascade value of AIE2 is written as a vector of 16 words,
+      // together with the enable flag of the write.
+      Type int32Type = rewriter.getI32Type();
+      Value wide = rewriter.create<vector::BroadcastOp>(
+          op.getLoc(), VectorType::get({1}, args[0].getType()), args[0]);
+      args[0] = rewriter.create<vector::BitCastOp>(
+          op.getLoc(), VectorType::get({16}, int32Type), wide);
+      args.push_back(rewriter.create<arith::ConstantOp>(
+          op.getLoc(), int32Type, rewriter.getI32IntegerAttr(1)));
+    }
     rewriter.create<func::CallOp>(rewriter.getUnknownLoc(), putMCDFunc, args);
     rewriter.eraseOp(Op);
     return success();
@@ -176,13 +192,33 @@ struct AIEGetCascadeToStdLowering : public OpConversionPattern<GetCascadeOp> {
   LogicalResult
   matchAndRewrite(GetCascadeOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
-    std::string funcName = "llvm.aie.get.scd";
+    auto device = op->getParentOfType<DeviceOp>();
+    if (!device)
+      return module.emitOpError("Device Not found!");
+    bool isAIE2 = device.getTargetModel().getTargetArch() == AIEArch::AIE2;
+
+    std::string funcName =
+        isAIE2 ? "llvm.aie2.scd.read.vec" : "llvm.aie.get.scd";
     auto getSCDFunc = module.lookupSymbol<func::FuncOp>(funcName);
     if (!getSCDFunc)
       return module.emitOpError("Could not find the intrinsic function!");
-    auto getSCDCall = rewriter.create<func::CallOp>(rewriter.getUnknownLoc(),
-                                                    getSCDFunc, ValueRange({}));
-    rewriter.replaceOp(op, getSCDCall.getResult(0));
+    if (!isAIE2) {
+      auto getSCDCall = rewriter.create<func::CallOp>(
+          rewriter.getUnknownLoc(), getSCDFunc, ValueRange({}));
+      rewriter.replaceOp(op, getSCDCall.getResult(0));
+      return success();
+    }
+
+    // The 512-bit cascade value of AIE2 is read as a vector of 16 words.
+    Value enable = rewriter.create<arith::ConstantOp>(
+        op.getLoc(), rewriter.getI32Type(), rewriter.getI32IntegerAttr(1));
+    auto getSCDCall = rewriter.create<func::CallOp>(
+        rewriter.getUnknownLoc(), getSCDFunc, ValueRange({enable}));
+    Value wide = rewriter.create<vector::BitCastOp>(
+        op.getLoc(), VectorType::get({1}, op.getCascadeValue().getType()),
+        getSCDCall.getResult(0));
+    rewriter.replaceOpWithNewOp<vector::ExtractOp>(op, wide,
+                                                   ArrayRef<int64_t>{0});
     return success();
   }
 };
@@ -425,6 +461,7 @@ struct AIECoreToStandardPass
     Type int32Type = IntegerType::get(builder.getContext(), 32);
     Type int128Type = IntegerType::get(builder.getContext(), 128);
     Type int384Type = IntegerType::get(builder.getContext(), 384);
+    Type int32x16Type = VectorType::get({16}, int32Type);
     Type floatType = FloatType::getF32(builder.getContext());
 
     // Note that not all of these are valid for a particular design, or needed.
@@ -508,6 +545,23 @@ struct AIECoreToStandardPass
             FunctionType::get(builder.getContext(), {}, {int384Type}))
         .setPrivate();
 
+    // llvm.func @llvm.aie2.mcd.write.vec(%cd_val: !llvm.v16i32, %en:
+    // !llvm.i32) -> ()
+    builder
+        .create<func::FuncOp>(
+            builder.getUnknownLoc(), "llvm.aie2.mcd.write.vec",
+            FunctionType::get(builder.getContext(), {int32x16Type, int32Type},
+                              {}))
+        .setPrivate();
+
+    // llvm.func @llvm.aie2.scd.read.vec(%en: !llvm.i32) -> !llvm.v16i32
+    builder
+        .create<func::FuncOp>(
+            builder.getUnknownLoc(), "llvm.aie2.scd.read.vec",
+            FunctionType::get(builder.getContext(), {int32Type},
+                              {int32x16Type}))
+        .setPrivate();
+
     // llvm.func @llvm.aie.lock.acquire.reg(%lock_id: !llvm.i32, %lock_val:
     // !llvm.i32) ->()
     builder
@@ -10,6 +10,7 @@
 
 #include "aie/Dialect/AIE/AIENetlistAnalysis.h"
 #include "aie/Dialect/AIE/IR/AIEDialect.h"
+#include "aie/Dialect/AIE/Transforms/AIEPathfinder.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Location.h"
 #include "mlir/IR/PatternMatch.h"
@@ -17,6 +18,7 @@
 #include "mlir/Tools/mlir-translate/MlirTranslateMain.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Support/MathExtras.h"
 
 #define DEBUG_TYPE "aie-create-packet-flows"
 
@@ -218,6 +220,89 @@ void buildPSRoute(
       std::make_pair(std::make_pair(lastPort, destPort), flowID));
 }
 
+// A packet rule (mask, ID) matches the 5-bit packet IDs that agree with ID on
+// the bits set in mask, i.e. a cube of the 5-dimensional Boolean space.
+typedef std::pair<int, int> PacketRuleCube;
+
+// Extend cover with at most depth of the given cubes to cover uncovered,
+// branching on the cubes matching the lowest ID not covered yet.
+static bool searchRuleCover(ArrayRef<uint32_t> primes, uint32_t uncovered,
+                            unsigned depth, SmallVectorImpl<uint32_t> &cover) {
+  if (!uncovered)
+    return true;
+  if (depth == 0)
+    return false;
+  uint32_t lowest = uncovered & (~uncovered + 1);
+  for (uint32_t prime : primes) {
+    if (!(prime & lowest))
+      continue;
+    cover.push_back(prime);
+    if (searchRuleCover(primes, uncovered & ~prime, depth - 1, cover))
+      return true;
+    cover.pop_back();
+  }
+  return false;
+}
+
+// Find a minimum set of rules matching every ID in onSet and no ID in offSet,
+// as a minimum cover of onSet with the cubes disjoint from offSet. IDs in
+// neither set never reach the slave port and are don't cares. Each rule of
+// the cover is then shrunk to the smallest cube of the IDs it is needed for,
+// so that a single ID keeps a full mask. Sets are bitsets of the 32 IDs.
+static SmallVector<PacketRuleCube, 4> minimizePacketRules(uint32_t onSet,
+                                                          uint32_t offSet) {
+  // the IDs matched by each cube that matches no ID of offSet, keeping only
+  // the cubes whose onSet IDs are not all matched by a larger cube
+  SmallVector<uint32_t, 32> cubes;
+  for (int mask = 0; mask < 32; mask++) {
+    for (int value = 0; value < 32; value++) {
+      if (value & ~mask)
+        continue;
+      uint32_t matched = 0;
+      for (int id = 0; id < 32; id++)
+        if ((id & mask) == value)
+          matched |= 1u << id;
+      if (matched & offSet || !(matched & onSet))
+        continue;
+      cubes.push_back(matched & onSet);
+    }
+  }
+  SmallVector<uint32_t, 32> primes;
+  for (uint32_t cube : cubes) {
+    bool dominated = false;
+    for (uint32_t other : cubes)
+      if (other != cube && (other & cube) == cube)
+        dominated = true;
+    if (!dominated && std::find(primes.begin(), primes.end(), cube) ==
+                          primes.end())
+      primes.push_back(cube);
+  }
+
+  // iterative deepening search for a minimum cover
+  SmallVector<uint32_t, 4> cover;
+  for (unsigned depth = 1; !searchRuleCover(primes, onSet, depth, cover);
+       depth++)
+    ;
+
+  SmallVector<PacketRuleCube, 4> rules;
+  uint32_t covered = 0;
+  for (uint32_t cube : cover) {
+    uint32_t ids = cube & ~covered;
+    covered |= cube;
+    int first = llvm::countTrailingZeros(ids);
+    int mask = 31;
+    for (int id = 0; id < 32; id++)
+      if (ids & (1u << id))
+        mask &= ~(id ^ first);
+    rules.push_back(std::make_pair(mask, first & mask));
+  }
+  std::sort(rules.begin(), rules.end(),
+            [](const PacketRuleCube &a, const PacketRuleCube &b) {
+              return a.second < b.second;
+            });
+  return rules;
+}
+
 SwitchboxOp getOrCreateSwitchbox(OpBuilder &builder, TileOp tile) {
   for (auto i : tile.getResult().getUsers()) {
     if (llvm::isa<SwitchboxOp>(*i)) {
@@ -269,12 +354,49 @@ struct AIERoutePacketFlowsPass
     SmallVector<std::pair<PhysPort, int>, 4> slavePorts;
     DenseMap<std::pair<PhysPort, int>, int> slaveAMSels;
 
+    int maxcol = 0, maxrow = 0;
     for (auto tileOp : device.getOps<TileOp>()) {
       int col = tileOp.colIndex();
       int row = tileOp.rowIndex();
       tiles[std::make_pair(col, row)] = tileOp;
+      maxcol = std::max(maxcol, col);
+      maxrow = std::max(maxrow, row);
     }
 
+    // With pathfinder, the ports used by circuit-switched connections are not
+    // available to packet flows
+    PacketPathfinder router(maxcol, maxrow, &device.getTargetModel());
+    if (clUsePathfinder)
+      for (SwitchboxOp switchboxOp : device.getOps<SwitchboxOp>())
+        for (ConnectOp connectOp : switchboxOp.getOps<ConnectOp>())
+          router.addFixedConnection(
+              std::make_pair(switchboxOp.colIndex(), switchboxOp.rowIndex()),
+              std::make_pair(connectOp.getDestBundle(),
+                             connectOp.getDestChannel()));
+
+    // Destination ports that drop the outer packet header, together with the
+    // flow that is relayed through them. With pathfinder, they are not
+    // available to other packet flows.
+    DenseMap<PhysPort, std::pair<int, PacketDestOp>> dropHeaderPorts;
+    for (auto pktflow : device.getOps<PacketFlowOp>())
+      for (auto pktDest : pktflow.getOps<PacketDestOp>()) {
+        if (!pktDest.dropsHeader())
+          continue;
+        TileOp destTile = dyn_cast<TileOp>(pktDest.getTile().getDefiningOp());
+        PhysPort destPort =
+            std::make_pair(destTile.getOperation(), pktDest.port());
+        if (dropHeaderPorts.count(destPort)) {
+          pktDest.emitError("port drops the header of more than one packet "
+                            "flow");
+          return signalPassFailure();
+        }
+        dropHeaderPorts[destPort] = std::make_pair(pktflow.IDInt(), pktDest);
+        if (clUsePathfinder)
+          router.addFixedConnection(
+              std::make_pair(destTile.colIndex(), destTile.rowIndex()),
+              pktDest.port());
+      }
+
     // The logical model of all the switchboxes.
     DenseMap<std::pair<int, int>, SmallVector<std::pair<Connect, int>, 8>>
         switchboxes;
@@ -298,12 +420,25 @@ struct AIERoutePacketFlowsPass
           int yDest = destTile.rowIndex();
           Port destPort = pktDest.port();
 
-          buildPSRoute(xSrc, ySrc, sourcePort, xDest, yDest, destPort, flowID,
-                       switchboxes);
+          if (clUsePathfinder)
+            router.addFlow(std::make_pair(xSrc, ySrc), sourcePort, flowID,
+                           std::make_pair(xDest, yDest), destPort);
+          else
+            buildPSRoute(xSrc, ySrc, sourcePort, xDest, yDest, destPort,
+                         flowID, switchboxes);
         }
       }
     }
 
+    if (clUsePathfinder) {
+      if (!router.findPaths()) {
+        device.emitError("Unable to find a legal routing for packet flows");
+        return signalPassFailure();
+      }
+      for (auto &[coord, connects] : router.getConnections())
+        switchboxes[coord].append(connects.begin(), connects.end());
+    }
+
     LLVM_DEBUG(llvm::dbgs() << "Check switchboxes\n");
 
     for (auto swbox : switchboxes) {
@@ -332,6 +467,19 @@ struct AIERoutePacketFlowsPass
             std::make_pair(std::make_pair(tileOp, sourcePort), flowID);
         packetFlows[sourceFlow].push_back(std::make_pair(tileOp, destPort));
         slavePorts.push_back(sourceFlow);
+
+        // Packets of other flows would lose their header at a port that
+        // relays a nested flow.
+        auto dropHeaderPort =
+            dropHeaderPorts.find(std::make_pair(tileOp, destPort));
+        if (dropHeaderPort != dropHeaderPorts.end() &&
+            dropHeaderPort->second.first != flowID) {
+          dropHeaderPort->second.second.emitError()
+              << "port that drops the packet header is also used by packet "
+                 "flow "
+              << flowID;
+          return signalPassFailure();
+        }
       }
     }
 
@@ -352,6 +500,7 @@ struct AIERoutePacketFlowsPass
     DenseMap<Operation *, int> amselValues;
     int numMsels = 4;
     int numArbiters = 6;
+    int numRulesPerSlave = 4;
 
     // Check all multi-cast flows (same source, same ID). They should be
     // assigned the same arbiter and msel so that the flow can reach all the
@@ -503,57 +652,38 @@ struct AIERoutePacketFlowsPass
       }
     }
 
-    DenseMap<std::pair<PhysPort, int>, int> slaveMasks;
+    // The IDs of each group must be matched without matching the IDs of the
+    // other groups of the same slave port, which go to other destinations.
+    DenseMap<PhysPort, uint32_t> slaveIDs;
+    for (auto slave : slavePorts)
+      slaveIDs[slave.first] |= 1u << slave.second;
+    SmallVector<SmallVector<PacketRuleCube, 4>, 4> groupRules;
     for (auto group : slaveGroups) {
-      // Iterate over all the ID values in a group
-      // If bit n-th (n <= 5) of an ID value differs from bit n-th of another ID
-      // value, the bit position should be "don't care", and we will set the
-      // mask bit of that position to 0
-      int mask[5] = {-1, -1, -1, -1, -1};
-      for (auto port : group) {
-        int ID = port.second;
-        for (int i = 0; i < 5; i++) {
-          if (mask[i] == -1)
-            mask[i] = ((ID >> i) & 0x1);
-          else if (mask[i] != ((ID >> i) & 0x1))
-            mask[i] = 2; // found bit difference --> mark as "don't care"
-        }
-      }
-
-      int maskValue = 0;
-      for (int i = 4; i >= 0; i--) {
-        if (mask[i] == 2) // don't care
-          mask[i] = 0;
-        else
-          mask[i] = 1;
-        maskValue = (maskValue << 1) + mask[i];
-      }
+      uint32_t onSet = 0;
       for (auto port : group)
-        slaveMasks[port] = maskValue;
+        onSet |= 1u << port.second;
+      uint32_t offSet = slaveIDs[group.front().first] & ~onSet;
+      groupRules.push_back(minimizePacketRules(onSet, offSet));
+      numPacketRules += groupRules.back().size();
     }
+    numPacketRulesUnmerged = packetFlows.size();
 
 #ifndef NDEBUG
     LLVM_DEBUG(llvm::dbgs() << "CHECK Slave Masks\n");
-    for (auto map : slaveMasks) {
-      auto port = map.first.first;
+    for (unsigned i = 0; i < slaveGroups.size(); i++) {
+      auto port = slaveGroups[i].front().first;
       TileOp tile = dyn_cast<TileOp>(port.first);
       WireBundle bundle = port.second.first;
       int channel = port.second.second;
-      int ID = map.first.second;
-      int mask = map.second;
 
       LLVM_DEBUG(llvm::dbgs()
                  << "Port " << tile << " " << stringifyWireBundle(bundle) << " "
                  << channel << '\n');
-      LLVM_DEBUG(llvm::dbgs() << "Mask "
-                              << "0x" << llvm::Twine::utohexstr(mask) << '\n');
-      LLVM_DEBUG(llvm::dbgs() << "ID "
-                              << "0x" << llvm::Twine::utohexstr(ID) << '\n');
-      for (int i = 0; i < 31; i++) {
-        if ((i & mask) == (ID & mask))
-          LLVM_DEBUG(llvm::dbgs() << "matches flow ID "
-                                  << "0x" << llvm::Twine::utohexstr(i) << '\n');
-      }
+      for (auto rule : groupRules[i])
+        LLVM_DEBUG(llvm::dbgs()
+                   << "Mask "
+                   << "0x" << llvm::Twine::utohexstr(rule.first) << " ID "
+                   << "0x" << llvm::Twine::utohexstr(rule.second) << '\n');
     }
 #endif
 
@@ -611,14 +741,18 @@ struct AIERoutePacketFlowsPass
           amsels.push_back(amselOps[msel]);
         }
 
-        builder.create<MasterSetOp>(builder.getUnknownLoc(),
-                                    builder.getIndexType(), bundle, channel,
-                                    amsels);
+        auto masterSetOp = builder.create<MasterSetOp>(
+            builder.getUnknownLoc(), builder.getIndexType(), bundle, channel,
+            amsels);
+        if (dropHeaderPorts.count(std::make_pair(tileOp, tileMaster)))
+          masterSetOp->setAttr("drop_header", builder.getUnitAttr());
       }
 
       // Generate the packet rules
       DenseMap<Port, PacketRulesOp> slaveRules;
-      for (auto group : slaveGroups) {
+      DenseMap<Port, int> slaveRuleCounts;
+      for (unsigned i = 0; i < slaveGroups.size(); i++) {
+        auto &group = slaveGroups[i];
         builder.setInsertionPoint(b.getTerminator());
 
         auto port = group.front().first;
@@ -629,14 +763,6 @@ struct AIERoutePacketFlowsPass
         int channel = port.second.second;
         auto slave = port.second;
 
-        int mask = slaveMasks[group.front()];
-        int ID = group.front().second & mask;
-
-        // Verify that we actually map all the ID's correctly.
-#ifndef NDEBUG
-        for (auto slave : group)
-          assert((slave.second & mask) == ID);
-#endif
         Value amsel = amselOps[slaveAMSels[group.front()]];
 
         PacketRulesOp packetrules;
@@ -651,8 +777,18 @@ struct AIERoutePacketFlowsPass
 
         Block &rules = packetrules.getRules().front();
         builder.setInsertionPoint(rules.getTerminator());
-        builder.create<PacketRuleOp>(builder.getUnknownLoc(), mask, ID, amsel);
+        for (auto [mask, ID] : groupRules[i])
+          builder.create<PacketRuleOp>(builder.getUnknownLoc(), mask, ID,
+                                       amsel);
+        slaveRuleCounts[slave] += groupRules[i].size();
       }
+      for (auto count : slaveRuleCounts)
+        if (count.second > numRulesPerSlave)
+          tile.emitWarning("slave port ")
+              << stringifyWireBundle(count.first.first) << " : "
+              << count.first.second << " needs " << count.second
+              << " packet rules, but only " << numRulesPerSlave
+              << " are available";
     }
 
     // Add support for shimDMA
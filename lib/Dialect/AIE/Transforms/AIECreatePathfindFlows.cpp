@@ -16,7 +16,12 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Tools/mlir-translate/MlirTranslateMain.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/raw_os_ostream.h"
 
 #include <aie/Dialect/AIE/Transforms/AIEPathfinder.h>
@@ -31,16 +36,6 @@ static llvm::cl::opt<bool>
                llvm::cl::desc("Enable Debugging of Pathfinder routing process"),
                llvm::cl::init(false));
 
-#define BOOST_NO_EXCEPTIONS
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Winvalid-noreturn"
-#include <boost/throw_exception.hpp>
-void boost::throw_exception(std::exception const &e) {
-  // boost expects this exception to be defined.
-  assert(false);
-}
-#pragma clang diagnostic pop
-
 std::string stringifyDirs(std::set<Port> dirs) {
   unsigned int count = 0;
   std::string out = "{";
@@ -89,6 +84,113 @@ std::string stringifySwitchSettings(SwitchSettings settings) {
   return out + "\n";
 }
 
+// The routing cache stores the solution found by the Pathfinder in a file
+// named after a hash of everything the solution depends on: the device, the
+// flows, the existing connections and the routing options. This version
+// string is part of the hash, and must change whenever the routing algorithm
+// changes the solution it finds for the same input.
+static const char *routingCacheVersion = "aie-pathfinder-cache-2";
+
+// Write a solution as one 'flow' line per flow source, followed by one
+// 'switchbox' line per switchbox on its route.
+static void writeRoutingSolution(
+    llvm::raw_ostream &os,
+    const std::map<PathEndPoint, SwitchSettings> &solution) {
+  for (auto &flow : solution) {
+    os << "flow " << flow.first.first->col << " " << flow.first.first->row
+       << " " << stringifyWireBundle(flow.first.second.first) << " "
+       << flow.first.second.second << "\n";
+    for (auto &setting : flow.second) {
+      os << "switchbox " << setting.first->col << " " << setting.first->row
+         << " " << stringifyWireBundle(setting.second.first.first) << " "
+         << setting.second.first.second << " "
+         << setting.second.second.size();
+      for (Port port : setting.second.second)
+        os << " " << stringifyWireBundle(port.first) << " " << port.second;
+      os << "\n";
+    }
+  }
+}
+
+// Read a solution written by writeRoutingSolution, returning false if it is
+// malformed.
+static bool
+readRoutingSolution(StringRef text, Pathfinder &pathfinder,
+                    std::map<PathEndPoint, SwitchSettings> &solution) {
+  SmallVector<StringRef> lines, tokens;
+  text.split(lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  SwitchSettings *settings = nullptr;
+  for (StringRef line : lines) {
+    tokens.clear();
+    line.split(tokens, ' ', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    if (tokens.empty())
+      continue;
+    unsigned next = 1;
+    auto getInt = [&](int &value) {
+      return next < tokens.size() && !tokens[next++].getAsInteger(10, value);
+    };
+    auto getSwitchbox = [&](Switchbox *&sb) {
+      int col, row;
+      if (!getInt(col) || !getInt(row))
+        return false;
+      sb = pathfinder.getSwitchbox(std::make_pair(col, row));
+      return sb != nullptr;
+    };
+    auto getPort = [&](Port &port) {
+      if (next >= tokens.size())
+        return false;
+      auto bundle = symbolizeWireBundle(tokens[next++]);
+      if (!bundle)
+        return false;
+      port.first = *bundle;
+      return getInt(port.second);
+    };
+
+    Switchbox *sb;
+    Port port;
+    if (tokens[0] == "flow") {
+      if (!getSwitchbox(sb) || !getPort(port) || next != tokens.size())
+        return false;
+      settings = &solution[std::make_pair(sb, port)];
+    } else if (tokens[0] == "switchbox" && settings) {
+      int numOutputs;
+      if (!getSwitchbox(sb) || !getPort(port) || !getInt(numOutputs))
+        return false;
+      SwitchSetting &setting = (*settings)[sb];
+      setting.first = port;
+      for (int i = 0; i < numOutputs; i++) {
+        if (!getPort(port))
+          return false;
+        setting.second.insert(port);
+      }
+      if (next != tokens.size())
+        return false;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Write the solution to the cache through a temporary file, so that
+// concurrent compilations never read a partial file.
+static void
+writeRoutingCache(StringRef path,
+                  const std::map<PathEndPoint, SwitchSettings> &solution) {
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path)))
+    return;
+  int fd;
+  SmallString<128> tempPath;
+  if (llvm::sys::fs::createUniqueFile(path + ".%%%%%%", fd, tempPath))
+    return;
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    writeRoutingSolution(os, solution);
+  }
+  if (llvm::sys::fs::rename(tempPath, path))
+    llvm::sys::fs::remove(tempPath);
+}
+
 // DynamicTileAnalysis integrates the Pathfinder class into the MLIR
 // environment. It passes flows to the Pathfinder as ordered pairs of ints.
 // Detailed routing is received as SwitchboxSettings
@@ -108,7 +210,9 @@ public:
 
   const int MAX_ITERATIONS = 1000; // how long until declared unroutable
 
-  DynamicTileAnalysis(DeviceOp &d) : device(d) {
+  DynamicTileAnalysis(DeviceOp &d, const PathfinderOptions &options = {},
+                      StringRef cacheDir = "")
+      : device(d) {
     LLVM_DEBUG(llvm::dbgs()
                << "\t---Begin DynamicTileAnalysis Constructor---\n");
     // find the maxcol and maxrow
@@ -119,7 +223,16 @@ public:
       maxrow = std::max(maxrow, tileOp.rowIndex());
     }
 
-    pathfinder = Pathfinder(maxcol, maxrow);
+    pathfinder = Pathfinder(maxcol, maxrow, &d.getTargetModel());
+    pathfinder.setOptions(options);
+
+    // everything the routing solution depends on, in the order it is given
+    // to the Pathfinder
+    std::string routingKey;
+    llvm::raw_string_ostream key(routingKey);
+    key << routingCacheVersion << " " << stringifyAIEDevice(d.getDevice())
+        << " " << maxcol << " " << maxrow << " " << options.useAStar << " "
+        << options.incremental << " " << options.numThreads << "\n";
 
     // for each flow in the device, add it to pathfinder
     // each source can map to multiple different destinations (fanout)
@@ -139,7 +252,13 @@ public:
                  << " -> (" << dstCoords.first << ", " << dstCoords.second
                  << ")" << stringifyWireBundle(dstPort.first)
                  << (int)dstPort.second << "\n");
-      pathfinder.addFlow(srcCoords, srcPort, dstCoords, dstPort);
+      pathfinder.addFlow(srcCoords, srcPort, dstCoords, dstPort,
+                         flowOp.priority());
+      key << "flow " << srcCoords.first << " " << srcCoords.second << " "
+          << stringifyWireBundle(srcPort.first) << " " << srcPort.second
+          << " " << dstCoords.first << " " << dstCoords.second << " "
+          << stringifyWireBundle(dstPort.first) << " " << dstPort.second
+          << " " << flowOp.priority() << "\n";
     }
 
     // add existing connections so Pathfinder knows which resources are
@@ -151,15 +270,51 @@ public:
         Port existing_port = std::make_pair(connectOp.getDestBundle(),
                                             connectOp.getDestChannel());
         pathfinder.addFixedConnection(existing_coord, existing_port);
+        key << "fixed " << existing_coord.first << " "
+            << existing_coord.second << " "
+            << stringifyWireBundle(existing_port.first) << " "
+            << existing_port.second << "\n";
+      }
+    }
+
+    // reuse the solution from the routing cache if there is one
+    SmallString<128> cacheFile;
+    bool cacheHit = false;
+    if (!cacheDir.empty()) {
+      llvm::SHA1 hasher;
+      hasher.update(key.str());
+      std::string hash = llvm::toHex(hasher.final(), /*LowerCase=*/true);
+      cacheFile = cacheDir;
+      llvm::sys::path::append(cacheFile, hash + ".route");
+      if (auto buffer = llvm::MemoryBuffer::getFile(cacheFile)) {
+        cacheHit = readRoutingSolution((*buffer)->getBuffer(), pathfinder,
+                                       flow_solutions);
+        if (!cacheHit)
+          flow_solutions.clear();
       }
+      LLVM_DEBUG(llvm::dbgs() << "Routing cache " << (cacheHit ? "hit" : "miss")
+                              << ": " << cacheFile << "\n");
     }
 
     // all flows are now populated, call the congestion-aware pathfinder
     // algorithm
     // check whether the pathfinder algorithm creates a legal routing
-    flow_solutions = pathfinder.findPaths(MAX_ITERATIONS);
-    if (!pathfinder.isLegal())
-      d.emitError("Unable to find a legal routing");
+    if (!cacheHit) {
+      flow_solutions = pathfinder.findPaths(MAX_ITERATIONS);
+      if (!pathfinder.isLegal())
+        d.emitError("Unable to find a legal routing");
+      else if (!cacheFile.empty())
+        writeRoutingCache(cacheFile, flow_solutions);
+    }
+
+    if (debugRoute) {
+      int iteration = 0;
+      for (auto &stats : pathfinder.getIterationStats())
+        llvm::errs() << "Pathfinder iteration #" << iteration++
+                     << ": flows routed = " << stats.flowsRouted
+                     << ", channels over capacity = " << stats.overusedEdges
+                     << "\n";
+    }
 
     // initialize all flows as unprocessed to prep for rewrite
     for (auto iter = flow_solutions.begin(); iter != flow_solutions.end();
@@ -202,6 +357,48 @@ public:
   int getMaxCol() { return maxcol; }
   int getMaxRow() { return maxrow; }
 
+  // return the number of switchbox hops from the source of a routed flow to
+  // the switchbox of one of its destinations, or -1 if it is not routed there
+  int getHopCount(Coord srcCoords, Port srcPort, Coord dstCoords) {
+    Switchbox *srcSB = pathfinder.getSwitchbox(srcCoords);
+    Switchbox *dstSB = pathfinder.getSwitchbox(dstCoords);
+    auto solution = flow_solutions.find(std::make_pair(srcSB, srcPort));
+    if (!srcSB || !dstSB || solution == flow_solutions.end())
+      return -1;
+
+    // walk the route of the flow breadth first from its source
+    std::map<Switchbox *, int> hops;
+    std::vector<Switchbox *> worklist = {srcSB};
+    hops[srcSB] = 0;
+    for (unsigned i = 0; i < worklist.size(); i++) {
+      Switchbox *sb = worklist[i];
+      if (sb == dstSB)
+        return hops[sb];
+      auto setting = solution->second.find(sb);
+      if (setting == solution->second.end())
+        continue;
+      for (const Port &out : setting->second.second) {
+        Coord next = std::make_pair(sb->col, sb->row);
+        if (out.first == WireBundle::North)
+          next.second++;
+        else if (out.first == WireBundle::South)
+          next.second--;
+        else if (out.first == WireBundle::East)
+          next.first++;
+        else if (out.first == WireBundle::West)
+          next.first--;
+        else
+          continue;
+        Switchbox *nextSB = pathfinder.getSwitchbox(next);
+        if (!nextSB || hops.count(nextSB))
+          continue;
+        hops[nextSB] = hops[sb] + 1;
+        worklist.push_back(nextSB);
+      }
+    }
+    return -1;
+  }
+
   TileOp getTile(OpBuilder &builder, int col, int row) {
     if (coordToTile.count(std::make_pair(col, row))) {
       return coordToTile[std::make_pair(col, row)];
@@ -452,7 +649,31 @@ struct AIEPathfinderPass
     LLVM_DEBUG(llvm::dbgs() << "---Begin AIEPathfinderPass---\n");
 
     DeviceOp d = getOperation();
-    DynamicTileAnalysis analyzer(d);
+    PathfinderOptions options;
+    options.useAStar = clUseAStar;
+    options.incremental = clIncremental;
+    options.context = &getContext();
+    options.numThreads =
+        clNumThreads == 0 ? getContext().getNumThreads() : clNumThreads;
+    DynamicTileAnalysis analyzer(d, options, clCacheDir);
+    numIterations = analyzer.pathfinder.getIterationStats().size();
+    for (auto &stats : analyzer.pathfinder.getIterationStats())
+      numFlowsRouted += stats.flowsRouted;
+
+    if (clHopReport) {
+      for (FlowOp flowOp : d.getOps<FlowOp>()) {
+        TileOp srcTile = cast<TileOp>(flowOp.getSource().getDefiningOp());
+        TileOp dstTile = cast<TileOp>(flowOp.getDest().getDefiningOp());
+        int hops = analyzer.getHopCount(
+            std::make_pair(srcTile.colIndex(), srcTile.rowIndex()),
+            std::make_pair(flowOp.getSourceBundle(),
+                           (int)flowOp.getSourceChannel()),
+            std::make_pair(dstTile.colIndex(), dstTile.rowIndex()));
+        flowOp.emitRemark() << "routed through " << hops
+                            << " switchbox hops with priority "
+                            << flowOp.priority();
+      }
+    }
     OpBuilder builder = OpBuilder::atBlockEnd(d.getBody());
 
     // Apply rewrite rule to switchboxes to add assignments to every 'connect'
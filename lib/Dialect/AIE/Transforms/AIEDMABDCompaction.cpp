@@ -0,0 +1,157 @@
+//===- AIEDMABDCompaction.cpp -----------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "aie/Dialect/AIE/IR/AIEDialect.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+
+#include <algorithm>
+
+#define DEBUG_TYPE "aie-dma-bd-compaction"
+
+using namespace mlir;
+using namespace xilinx;
+using namespace xilinx::AIE;
+
+// Return the BD blocks of the chain that a DMA channel starts with, if the
+// chain is a cycle back to its first block in which all other blocks are
+// only reached from the previous one. Otherwise return an empty chain.
+static SmallVector<Block *, 16> getBDCycle(DMAStartOp start) {
+  SmallVector<Block *, 16> cycle;
+  Block *block = start.getDest();
+  while (!llvm::is_contained(cycle, block)) {
+    if (block->getOps<DMABDOp>().empty() ||
+        block->getTerminator()->getNumSuccessors() != 1)
+      return {};
+    if (!cycle.empty() && !block->getSinglePredecessor())
+      return {};
+    cycle.push_back(block);
+    block = block->getTerminator()->getSuccessor(0);
+  }
+  if (block != cycle.front())
+    return {};
+  return cycle;
+}
+
+// Return true if two BD blocks configure the same transfer, i.e. they have
+// the same operations on the same buffers and locks, apart from the BD that
+// follows them.
+static bool isEquivalentBD(Block *a, Block *b) {
+  if (a == b)
+    return true;
+  auto opsA = a->without_terminator();
+  auto opsB = b->without_terminator();
+  return std::equal(opsA.begin(), opsA.end(), opsB.begin(), opsB.end(),
+                    [](Operation &opA, Operation &opB) {
+                      return OperationEquivalence::isEquivalentTo(
+                          &opA, &opB, OperationEquivalence::exactValueMatch,
+                          /*markEquivalent=*/nullptr,
+                          OperationEquivalence::IgnoreLocations);
+                    });
+}
+
+// Erase BD blocks that no DMA channel reaches anymore.
+static int eraseBDs(ArrayRef<Block *> blocks) {
+  for (Block *block : blocks)
+    block->dropAllReferences();
+  for (Block *block : blocks)
+    block->erase();
+  return blocks.size();
+}
+
+// Compact the BD chains in the region of a MemOp, MemTileDMAOp or ShimDMAOp
+// and return the number of BDs saved.
+static int compactDMABDChains(Region &body) {
+  SmallVector<DMAStartOp, 4> starts;
+  for (auto &block : body)
+    for (auto start : block.getOps<DMAStartOp>())
+      starts.push_back(start);
+  int numSaved = 0;
+
+  // A cycle that repeats the same BDs several times only needs one period.
+  for (auto start : starts) {
+    SmallVector<Block *, 16> cycle = getBDCycle(start);
+    size_t length = cycle.size();
+    for (size_t period = 1; period < length; period++) {
+      if (length % period != 0)
+        continue;
+      bool periodic = true;
+      for (size_t i = period; i < length && periodic; i++)
+        periodic = isEquivalentBD(cycle[i], cycle[i - period]);
+      if (!periodic)
+        continue;
+      cycle[period - 1]->getTerminator()->setSuccessor(cycle.front(), 0);
+      numSaved += eraseBDs(ArrayRef<Block *>(cycle).drop_front(period));
+      break;
+    }
+  }
+
+  // Channels that run equivalent cycles can start at the same BD, as a BD
+  // only describes the transfer. Memtile channels can only use the BDs of
+  // channels with the same parity.
+  bool isMemTile = isa<MemTileDMAOp>(body.getParentOp());
+  for (size_t i = 0; i < starts.size(); i++) {
+    SmallVector<Block *, 16> cycle = getBDCycle(starts[i]);
+    if (cycle.empty())
+      continue;
+    for (size_t j = 0; j < i; j++) {
+      if (starts[j].getChannelDir() != starts[i].getChannelDir())
+        continue;
+      if (isMemTile && (starts[j].getChannelIndex() & 1) !=
+                           (starts[i].getChannelIndex() & 1))
+        continue;
+      SmallVector<Block *, 16> other = getBDCycle(starts[j]);
+      if (other.size() != cycle.size() || other.front() == cycle.front())
+        continue;
+      bool equivalent = true;
+      for (size_t k = 0; k < cycle.size() && equivalent; k++)
+        equivalent = isEquivalentBD(cycle[k], other[k]);
+      if (!equivalent)
+        continue;
+      starts[i]->setSuccessor(other.front(), 0);
+      numSaved += eraseBDs(cycle);
+      break;
+    }
+  }
+  return numSaved;
+}
+
+struct AIEDMABDCompactionPass
+    : public AIEDMABDCompactionBase<AIEDMABDCompactionPass> {
+  template <typename DMAOp>
+  void compact(DeviceOp device) {
+    for (auto dmaOp : device.getOps<DMAOp>()) {
+      int numBDs = 0;
+      for (auto &block : dmaOp.getBody())
+        if (!block.template getOps<DMABDOp>().empty())
+          numBDs++;
+      int numSaved = compactDMABDChains(dmaOp.getBody());
+      numSavedBDs += numSaved;
+      if (clReport && numSaved > 0) {
+        TileOp tile = dmaOp.getTileOp();
+        dmaOp.emitRemark() << "saved " << numSaved << " of " << numBDs
+                           << " BDs in tile (" << tile.colIndex() << ", "
+                           << tile.rowIndex() << ")";
+      }
+    }
+  }
+
+  void runOnOperation() override {
+    DeviceOp device = getOperation();
+    compact<MemOp>(device);
+    compact<MemTileDMAOp>(device);
+    compact<ShimDMAOp>(device);
+  }
+};
+
+std::unique_ptr<OperationPass<DeviceOp>>
+AIE::createAIEDMABDCompactionPass() {
+  return std::make_unique<AIEDMABDCompactionPass>();
+}
@@ -0,0 +1,371 @@
+//===- AIEObjectFifoDepthSelection.cpp --------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "aie/Dialect/AIE/IR/AIEDialect.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/Pass/Pass.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <map>
+#include <optional>
+
+#define DEBUG_TYPE "aie-objectFifo-depth-selection"
+
+using namespace mlir;
+using namespace xilinx;
+using namespace xilinx::AIE;
+
+// Cycles for a DMA to start the transfer of an element, and for the data to
+// cross each switchbox on the way to the other tile.
+static constexpr int64_t dmaSetupCycles = 32;
+static constexpr int64_t cyclesPerHop = 2;
+// Bytes a DMA channel moves in each cycle.
+static constexpr int64_t dmaBytesPerCycle = 4;
+// Estimates are saturated here, e.g. for the infinite loops of cores.
+static constexpr int64_t maxCycles = int64_t(1) << 40;
+
+// Estimate the cycles of one execution of a block. Loops with constant bounds
+// count their body once per iteration, calls count kernelCycles and all other
+// operations one cycle.
+static int64_t estimateCycles(Block &block, int64_t kernelCycles) {
+  int64_t cycles = 0;
+  for (Operation &op : block) {
+    int64_t opCycles = 1;
+    if (isa<func::CallOp>(op)) {
+      opCycles = kernelCycles;
+    } else if (auto forOp = dyn_cast<scf::ForOp>(op)) {
+      int64_t body = estimateCycles(*forOp.getBody(), kernelCycles);
+      auto lb = getConstantIntValue(forOp.getLowerBound());
+      auto ub = getConstantIntValue(forOp.getUpperBound());
+      auto step = getConstantIntValue(forOp.getStep());
+      int64_t trips = 1;
+      if (lb && ub && step && *step > 0)
+        trips = *ub > *lb ? llvm::divideCeil(*ub - *lb, *step) : 0;
+      opCycles = (body > 0 && trips > maxCycles / body) ? maxCycles
+                                                        : trips * body;
+    } else {
+      for (Region &region : op.getRegions())
+        for (Block &nested : region)
+          opCycles =
+              std::max(opCycles, 1 + estimateCycles(nested, kernelCycles));
+    }
+    cycles = std::min(cycles + opCycles, maxCycles);
+  }
+  return cycles;
+}
+
+// Size in bytes of the elements of an objectFifo.
+static int64_t getElementBytes(ObjectFifoCreateOp fifo) {
+  auto fifoType = fifo.getElemType().cast<AIEObjectFifoType>();
+  auto memref = fifoType.getElementType().cast<MemRefType>();
+  return memref.getNumElements() *
+         llvm::divideCeil(memref.getElementTypeBitWidth(), 8);
+}
+
+// The object pool of an objectFifo in one tile.
+struct ObjectPool {
+  TileOp tile;
+  int index = 0;       // index of the depth in an elemNumber array
+  int maxAcquire = 0;  // elements held by the core of the tile at once
+  int initial = 0;     // depth the objectFifo lowering would use
+  int minDepth = 0;    // smallest depth that does not deadlock
+  int depth = 0;       // selected depth
+  bool select = false; // depth is chosen by the analysis
+};
+
+struct ObjectFifoDepths {
+  ObjectFifoCreateOp fifo;
+  bool shared = false;
+  int64_t elementBytes = 0;
+  SmallVector<ObjectPool, 2> pools;
+};
+
+struct AIEObjectFifoDepthSelectionPass
+    : public AIEObjectFifoDepthSelectionBase<AIEObjectFifoDepthSelectionPass> {
+
+  /// Largest number of elements of the objectFifo acquired at once through
+  /// the port by the core of the tile, 0 if the core does not use the port.
+  int getMaxAcquire(TileOp tile, ObjectFifoCreateOp fifo,
+                    ObjectFifoPort port) {
+    int maxAcquire = 0;
+    if (CoreOp core = tile.getCoreOp())
+      core.walk([&](ObjectFifoAcquireOp acquire) {
+        if (acquire.getPort() == port && acquire.getObjectFifo() == fifo)
+          maxAcquire = std::max(maxAcquire, acquire.acqNumber());
+      });
+    return maxAcquire;
+  }
+
+  /// Estimated cycles between two elements of the objectFifo released through
+  /// the port by the core of the tile: the cycles of the block that releases
+  /// them divided by the number of elements released there. Returns
+  /// std::nullopt if the core does not release any elements.
+  std::optional<int64_t> getPeriod(TileOp tile, ObjectFifoCreateOp fifo,
+                                   ObjectFifoPort port) {
+    std::optional<int64_t> period;
+    if (CoreOp core = tile.getCoreOp())
+      core.walk([&](ObjectFifoReleaseOp release) {
+        if (release.getPort() != port || release.getObjectFifo() != fifo ||
+            release.relNumber() == 0)
+          return;
+        int64_t cycles = estimateCycles(*release->getBlock(), clKernelCycles);
+        int64_t elementPeriod =
+            std::max<int64_t>(cycles / release.relNumber(), 1);
+        period = period ? std::min(*period, elementPeriod) : elementPeriod;
+      });
+    return period;
+  }
+
+  /// The tile whose memory holds the elements of an objectFifo between two
+  /// tiles, or nullptr if the objectFifo lowering splits it in two, as in
+  /// AIEObjectFifoStatefulTransform.
+  TileOp getSharedMemoryTile(ObjectFifoCreateOp fifo) {
+    if (fifo.getConsumerTiles().size() != 1)
+      return nullptr;
+    TileOp producer = fifo.getProducerTileOp();
+    TileOp consumer = fifo.getConsumerTiles()[0].getDefiningOp<TileOp>();
+    if (producer.isShimTile() != consumer.isShimTile() ||
+        producer.isMemTile() != consumer.isMemTile())
+      return nullptr;
+    const auto &targetModel = getTargetModel(producer.getOperation());
+    if (targetModel.isLegalMemAffinity(consumer.colIndex(),
+                                       consumer.rowIndex(), producer.colIndex(),
+                                       producer.rowIndex()))
+      return producer;
+    if (targetModel.isLegalMemAffinity(producer.colIndex(),
+                                       producer.rowIndex(), consumer.colIndex(),
+                                       consumer.rowIndex()))
+      return consumer;
+    return nullptr;
+  }
+
+  /// Depth that the objectFifo lowering uses for a tile without explicit
+  /// depths, as in findObjectFifoSize of AIEObjectFifoStatefulTransform.
+  int getInitialDepth(DeviceOp device, ObjectFifoCreateOp fifo, TileOp tile,
+                      int maxAcquire) {
+    if (fifo.size() == 0 || tile.isMemTile())
+      return fifo.size();
+    if (tile.isShimTile()) {
+      for (auto regOp : device.getOps<ObjectFifoRegisterExternalBuffersOp>())
+        if (regOp.getTile() == tile.getResult() &&
+            regOp.getObjectFifo() == fifo)
+          return regOp.getExternalBuffers().size();
+      return fifo.size();
+    }
+    if (maxAcquire == 0)
+      return fifo.size();
+    if (maxAcquire == 1 && fifo.size() == 1)
+      return 1;
+    return maxAcquire + 1;
+  }
+
+  /// Select the depths of an objectFifo between two tiles that share memory.
+  /// The producer and the consumer can both work at full rate when each of
+  /// them holds the elements it acquires at the same time.
+  void selectSharedDepth(ObjectFifoDepths &depths, TileOp memoryTile) {
+    ObjectFifoCreateOp fifo = depths.fifo;
+    TileOp consumer = fifo.getConsumerTiles()[0].getDefiningOp<TileOp>();
+    int producerAcquire =
+        getMaxAcquire(fifo.getProducerTileOp(), fifo, ObjectFifoPort::Produce);
+    int consumerAcquire =
+        getMaxAcquire(consumer, fifo, ObjectFifoPort::Consume);
+
+    ObjectPool pool;
+    pool.tile = memoryTile;
+    pool.initial = fifo.size();
+    pool.depth = pool.initial;
+    if (producerAcquire > 0 && consumerAcquire > 0) {
+      pool.select = true;
+      pool.minDepth = std::max(producerAcquire, consumerAcquire);
+      pool.depth = producerAcquire + consumerAcquire;
+    }
+    depths.shared = true;
+    depths.pools.push_back(pool);
+  }
+
+  /// Select the depths of an objectFifo that is split into one object pool in
+  /// the producer tile and one in each consumer tile, connected by DMAs. The
+  /// steady-state period of the objectFifo is bounded by the slowest core and
+  /// by the DMA bandwidth. A core holds the elements it acquires at once, and
+  /// needs enough further elements to cover the latency of a DMA transfer,
+  /// i.e. its setup, the hops between the tiles and the transfer itself, at
+  /// that period.
+  void selectSplitDepths(DeviceOp device, ObjectFifoDepths &depths) {
+    ObjectFifoCreateOp fifo = depths.fifo;
+    bool explicitDepths = isa<ArrayAttr>(fifo.getElemNumber());
+    int64_t transferCycles =
+        llvm::divideCeil(depths.elementBytes, dmaBytesPerCycle);
+
+    TileOp producer = fifo.getProducerTileOp();
+    SmallVector<TileOp, 2> tiles{producer};
+    for (auto consumer : fifo.getConsumerTiles())
+      tiles.push_back(consumer.getDefiningOp<TileOp>());
+
+    // Tiles where the objectFifo is linked to another one keep their depths.
+    TileOp linkTile;
+    for (auto linkOp : device.getOps<ObjectFifoLinkOp>()) {
+      auto fifos = llvm::to_vector(linkOp.getInputObjectFifos());
+      llvm::append_range(fifos, linkOp.getOutputObjectFifos());
+      if (llvm::is_contained(fifos, fifo))
+        if (auto sharedTile = linkOp.getOptionalSharedTile())
+          linkTile = sharedTile->getDefiningOp<TileOp>();
+    }
+
+    int64_t period = std::max<int64_t>(transferCycles, 1);
+    for (unsigned index = 0; index < tiles.size(); index++) {
+      TileOp tile = tiles[index];
+      ObjectFifoPort port =
+          index == 0 ? ObjectFifoPort::Produce : ObjectFifoPort::Consume;
+      ObjectPool pool;
+      pool.tile = tile;
+      pool.index = index;
+      if (tile != linkTile)
+        pool.maxAcquire = getMaxAcquire(tile, fifo, port);
+      pool.initial = explicitDepths ? fifo.size(index)
+                                    : getInitialDepth(device, fifo, tile,
+                                                      pool.maxAcquire);
+      pool.depth = pool.initial;
+      if (pool.maxAcquire > 0) {
+        pool.select = true;
+        pool.minDepth = getInitialDepth(device, fifo, tile, pool.maxAcquire);
+        if (auto corePeriod = getPeriod(tile, fifo, port))
+          period = std::max(period, *corePeriod);
+      }
+      depths.pools.push_back(pool);
+    }
+
+    for (auto &pool : depths.pools) {
+      if (!pool.select)
+        continue;
+      // The longest path between this tile and the other end of the DMAs.
+      int hops = 0;
+      for (unsigned index = 0; index < tiles.size(); index++) {
+        if ((index == 0) == (pool.index == 0))
+          continue;
+        int colDistance = tiles[index].colIndex() - pool.tile.colIndex();
+        int rowDistance = tiles[index].rowIndex() - pool.tile.rowIndex();
+        hops = std::max(hops, std::abs(colDistance) + std::abs(rowDistance));
+      }
+      int64_t latency = dmaSetupCycles + cyclesPerHop * hops + transferCycles;
+      int64_t inFlight =
+          std::max<int64_t>(llvm::divideCeil(latency, period), 1);
+      pool.depth = std::max<int64_t>(pool.maxAcquire + inFlight, pool.minDepth);
+    }
+  }
+
+  /// Shrink the selected depths, largest first, in tiles whose memory or, on
+  /// AIE1, whose locks do not suffice for all their object pools.
+  void fitToTiles(DeviceOp device, std::vector<ObjectFifoDepths> &allDepths) {
+    const auto &targetModel = device.getTargetModel();
+    bool locksPerElement = targetModel.getTargetArch() == AIEArch::AIE1;
+
+    std::map<TileID, int64_t> fixedBytes;
+    std::map<TileID, int> fixedLocks;
+    for (auto core : device.getOps<CoreOp>())
+      fixedBytes[core.getTileOp().getTileID()] += core.getStackSize();
+    for (auto buffer : device.getOps<BufferOp>())
+      fixedBytes[buffer.getTileOp().getTileID()] += buffer.getAllocationSize();
+    for (auto lock : device.getOps<LockOp>())
+      fixedLocks[lock.getTileOp().getTileID()]++;
+
+    std::map<TileID, SmallVector<std::pair<ObjectPool *, int64_t>, 4>> pools;
+    for (auto &depths : allDepths)
+      for (auto &pool : depths.pools)
+        if (!pool.tile.isShimTile())
+          pools[pool.tile.getTileID()].push_back(
+              std::make_pair(&pool, depths.elementBytes));
+
+    for (auto &entry : pools) {
+      TileID coord = entry.first;
+      auto &tilePools = entry.second;
+      int col = coord.first, row = coord.second;
+      int64_t memorySize = targetModel.isMemTile(col, row)
+                               ? targetModel.getMemTileSize()
+                               : targetModel.getLocalMemorySize();
+      int numLocks = targetModel.getNumLocks(col, row);
+      auto fits = [&]() {
+        int64_t bytes = fixedBytes[coord];
+        int locks = fixedLocks[coord];
+        for (auto &[pool, elementBytes] : tilePools) {
+          bytes += pool->depth * elementBytes;
+          locks += locksPerElement ? pool->depth : 2;
+        }
+        return bytes <= memorySize && locks <= numLocks;
+      };
+      while (!fits()) {
+        ObjectPool *largest = nullptr;
+        for (auto &[pool, elementBytes] : tilePools)
+          if (pool->select && pool->depth > pool->minDepth &&
+              (!largest || pool->depth - pool->minDepth >
+                               largest->depth - largest->minDepth))
+            largest = pool;
+        if (!largest)
+          break;
+        largest->depth--;
+      }
+    }
+  }
+
+  void runOnOperation() override {
+    DeviceOp device = getOperation();
+    OpBuilder builder(device.getContext());
+
+    std::vector<ObjectFifoDepths> allDepths;
+    for (auto fifo : device.getOps<ObjectFifoCreateOp>()) {
+      ObjectFifoDepths depths;
+      depths.fifo = fifo;
+      depths.elementBytes = getElementBytes(fifo);
+      if (TileOp memoryTile = getSharedMemoryTile(fifo))
+        selectSharedDepth(depths, memoryTile);
+      else
+        selectSplitDepths(device, depths);
+      allDepths.push_back(std::move(depths));
+    }
+
+    fitToTiles(device, allDepths);
+
+    for (auto &depths : allDepths) {
+      ObjectFifoCreateOp fifo = depths.fifo;
+      bool changed = false;
+      for (auto &pool : depths.pools) {
+        if (!pool.select)
+          continue;
+        changed |= pool.depth != pool.initial;
+        if (clDryRun)
+          fifo.emitRemark() << "depth " << pool.initial << " -> " << pool.depth
+                            << " in tile (" << pool.tile.colIndex() << ", "
+                            << pool.tile.rowIndex() << ")";
+      }
+      if (!changed)
+        continue;
+      numChangedObjectFifos++;
+      if (clDryRun)
+        continue;
+      if (depths.shared) {
+        fifo->setAttr("elemNumber",
+                      builder.getI32IntegerAttr(depths.pools[0].depth));
+      } else {
+        SmallVector<Attribute, 4> elemNumber;
+        for (auto &pool : depths.pools)
+          elemNumber.push_back(builder.getI32IntegerAttr(pool.depth));
+        fifo->setAttr("elemNumber", builder.getArrayAttr(elemNumber));
+      }
+    }
+  }
+};
+
+std::unique_ptr<OperationPass<DeviceOp>>
+AIE::createAIEObjectFifoDepthSelectionPass() {
+  return std::make_unique<AIEObjectFifoDepthSelectionPass>();
+}
@@ -22,6 +22,7 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Tools/mlir-translate/MlirTranslateMain.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/Support/Debug.h"
 #include <numeric>
 
@@ -33,6 +34,14 @@ using namespace xilinx::AIE;
 
 #define LOOP_VAR_DEPENDENCY -2
 
+// Number of packet IDs that a DMA BD can send.
+static constexpr int maxPacketIDs = 32;
+
+// Marks the for-loops that are kept rolled and select the elements of their
+// objectFifos at runtime instead of being unrolled.
+static constexpr llvm::StringLiteral dynamicIndexAttr =
+    "dynamic_objectFifo_index";
+
 //===----------------------------------------------------------------------===//
 // Conversion Pattern
 //===----------------------------------------------------------------------===//
@@ -130,6 +139,17 @@ public:
     return dmaChan;
   }
 
+  /// Given an AIE tile, returns the number of its master channels that are
+  /// not used yet.
+  int getNumFreeMasterChannels(Value tile) {
+    TileOp tileOp = tile.getDefiningOp<TileOp>();
+    int numChannels = tileOp.getNumSourceConnections(WireBundle::DMA);
+    auto it = masterChannelsPerTile.find(tile);
+    if (it == masterChannelsPerTile.end())
+      return numChannels;
+    return numChannels - it->second - 1;
+  }
+
   /// Given an AIE tile, returns its next usable slave channel.
   xilinx::AIE::DMAChannel getSlaveDMAChannel(Value tile) {
     xilinx::AIE::DMAChannel dmaChan;
@@ -171,6 +191,12 @@ struct AIEObjectFifoStatefulTransformPass
   DenseMap<ObjectFifoLinkOp, ObjectFifoCreateOp>
       objFifoLinks; // maps each ObjectFifoLinkOp to objFifo whose elements
                     // have been created and should be used
+  DenseMap<ObjectFifoCreateOp, int>
+      packetIDs; // maps each objFifo sent on a shared DMA channel to the ID
+                 // of its packets
+  DenseMap<ObjectFifoCreateOp, std::vector<TileOp>>
+      sharedConsumers; // maps each broadcast objFifo whose elements are
+                       // shared to the consumer tiles that access them
 
   /// Function that returns true if two tiles in the AIE array share a memory
   /// module. share_direction is equal to:
@@ -208,6 +234,70 @@ struct AIEObjectFifoStatefulTransformPass
     return leftShared || rightShared;
   }
 
+  /// Function that finds the memory module in which the producer of a
+  /// broadcast objectFifo and some of its consumers can share its elements,
+  /// on AIE2 devices. The candidates are the memory of the producer tile and
+  /// that of each consumer tile; a consumer tile is only chosen if all
+  /// consumers can access it, because the DMA to the other consumers reads
+  /// the memory of the producer tile. Returns a null TileOp if no consumer
+  /// can share the elements, otherwise fills consumers with the tiles that
+  /// access them.
+  TileOp findBroadcastMemory(DeviceOp &device, ObjectFifoCreateOp op,
+                             std::vector<TileOp> &consumers) {
+    const auto &targetModel = getTargetModel(op.getOperation());
+    TileOp producer = op.getProducerTileOp();
+    if (targetModel.getTargetArch() == AIEArch::AIE1 ||
+        op.getConsumerTiles().size() < 2 ||
+        !targetModel.isCoreTile(producer.colIndex(), producer.rowIndex()) ||
+        getOptionalLinkOp(op) || op.getDimensionsToStream() ||
+        op.getDimensionsFromStreamPerConsumer())
+      return {};
+
+    // each consumer uses its own locks, so its accesses must be in its core
+    bool outsideCore = false;
+    device.walk([&](Operation *user) {
+      if (auto acquireOp = dyn_cast<ObjectFifoAcquireOp>(user))
+        if (acquireOp.getObjectFifo() == op &&
+            acquireOp.getPort() == ObjectFifoPort::Consume)
+          outsideCore |= !user->getParentOfType<CoreOp>();
+      if (auto releaseOp = dyn_cast<ObjectFifoReleaseOp>(user))
+        if (releaseOp.getObjectFifo() == op &&
+            releaseOp.getPort() == ObjectFifoPort::Consume)
+          outsideCore |= !user->getParentOfType<CoreOp>();
+    });
+    if (outsideCore)
+      return {};
+
+    auto canAccess = [&](TileOp core, TileOp memory) {
+      return targetModel.isCoreTile(core.colIndex(), core.rowIndex()) &&
+             targetModel.isLegalMemAffinity(core.colIndex(), core.rowIndex(),
+                                            memory.colIndex(),
+                                            memory.rowIndex());
+    };
+    std::vector<TileOp> candidates = {producer};
+    for (auto consumerTile : op.getConsumerTiles())
+      candidates.push_back(consumerTile.getDefiningOp<TileOp>());
+
+    TileOp memory;
+    for (auto candidate : candidates) {
+      if (!canAccess(producer, candidate))
+        continue;
+      std::vector<TileOp> accessing;
+      for (auto consumer : ArrayRef<TileOp>(candidates).drop_front())
+        if (consumer != producer && canAccess(consumer, candidate) &&
+            !llvm::is_contained(accessing, consumer))
+          accessing.push_back(consumer);
+      if (candidate != producer &&
+          accessing.size() != op.getConsumerTiles().size())
+        continue;
+      if (accessing.size() > consumers.size()) {
+        memory = candidate;
+        consumers = accessing;
+      }
+    }
+    return memory;
+  }
+
   /// Function to multiply all dimensions of a memref.
   int64_t getMemrefTypeSize(MemRefType memref) {
     int64_t size = 1;
@@ -384,6 +474,58 @@ struct AIEObjectFifoStatefulTransformPass
     locksPerFifo[op] = locks;
   }
 
+  /// Function used to create the elements of a broadcast objectFifo in the
+  /// memory of memoryTile, where its producer and sharedConsumers[op] access
+  /// them. Each consumer gets its own pair of producer and consumer locks,
+  /// after the pair of the DMA to the other consumers if there are any: the
+  /// producer acquires and releases all of them, so that an element is only
+  /// written again once every consumer has released it.
+  void createBroadcastElements(OpBuilder &builder, LockAnalysis &lockAnalysis,
+                               ObjectFifoCreateOp op, TileOp memoryTile,
+                               bool hasDMA) {
+    std::vector<BufferOp> buffers;
+    std::vector<LockOp> locks;
+    AIEObjectFifoType fifo = op.getElemType().cast<AIEObjectFifoType>();
+    MemRefType elemType = fifo.getElementType().cast<MemRefType>();
+    int numElem = op.size();
+
+    builder.setInsertionPointAfter(op);
+    for (int i = 0; i < numElem; i++) {
+      BufferOp buff = builder.create<BufferOp>(builder.getUnknownLoc(),
+                                               elemType, memoryTile);
+      buff.getOperation()->setAttr(
+          mlir::SymbolTable::getSymbolAttrName(),
+          builder.getStringAttr(op.name().str() + "_buff_" +
+                                std::to_string(i)));
+      buffers.push_back(buff);
+    }
+
+    auto createLock = [&](const std::string &name, int init) {
+      int lockID = lockAnalysis.getLockID(memoryTile);
+      assert(lockID >= 0 && "No more locks to allocate!");
+      LockOp lock = builder.create<LockOp>(builder.getUnknownLoc(),
+                                           memoryTile, lockID, init);
+      lock.getOperation()->setAttr(mlir::SymbolTable::getSymbolAttrName(),
+                                   builder.getStringAttr(name));
+      locks.push_back(lock);
+    };
+    std::vector<std::string> prefixes;
+    if (hasDMA)
+      prefixes.push_back(op.name().str());
+    auto consumerTiles = op.getConsumerTiles();
+    for (auto consumer : sharedConsumers[op]) {
+      auto position = llvm::find(consumerTiles, consumer.getResult()) -
+                      consumerTiles.begin();
+      prefixes.push_back(op.name().str() + "_" + std::to_string(position));
+    }
+    for (auto &prefix : prefixes) {
+      createLock(prefix + "_prod_lock", numElem);
+      createLock(prefix + "_cons_lock", 0);
+    }
+    buffersPerFifo[op] = buffers;
+    locksPerFifo[op] = locks;
+  }
+
   /// Function that returns a pointer to the block of a Region
   /// that contains the AIEEndOp.
   Block *findEndOpBlock(Region *r) {
@@ -395,13 +537,21 @@ struct AIEObjectFifoStatefulTransformPass
   }
 
   /// Function used to create a Bd block.
+  /// If dims is not empty, the BD transfers the buffer with these step sizes
+  /// and wraps. If packetID is not negative, the BD sends packets with that ID.
   template <typename MyOp>
   void createBd(OpBuilder &builder, LockOp acqLock, int acqMode,
                 LockAction acqLockAction, LockOp relLock, int relMode,
-                MyOp buff, int offset, int len, Block *succ) {
+                MyOp buff, int offset, int len, Block *succ,
+                DimTupleArrayAttr dims, int packetID = -1) {
     builder.create<UseLockOp>(builder.getUnknownLoc(), acqLock, acqMode,
                               acqLockAction);
-    builder.create<DMABDOp>(builder.getUnknownLoc(), buff, offset, len, 0);
+    if (packetID >= 0)
+      builder.create<DMABDPACKETOp>(builder.getUnknownLoc(), 0, packetID);
+    DMABDOp bd =
+        builder.create<DMABDOp>(builder.getUnknownLoc(), buff, offset, len, 0);
+    if (dims && !dims.getValue().empty())
+      bd.setDimensionsAttr(dims);
     builder.create<UseLockOp>(builder.getUnknownLoc(), relLock, relMode,
                               LockAction::Release);
     builder.create<NextBDOp>(builder.getUnknownLoc(), succ);
@@ -413,7 +563,8 @@ struct AIEObjectFifoStatefulTransformPass
   template <typename MyOp>
   void createBdBlock(OpBuilder &builder, ObjectFifoCreateOp op, int lockMode,
                      int acqNum, int relNum, MyOp buff, int offset, int len,
-                     DMAChannelDir channelDir, int blockIndex, Block *succ) {
+                     DMAChannelDir channelDir, int blockIndex, Block *succ,
+                     DimTupleArrayAttr dims, int packetID = -1) {
     LockOp acqLock;
     LockOp relLock;
     int acqMode = 1;
@@ -436,7 +587,18 @@ struct AIEObjectFifoStatefulTransformPass
                                                     : locksPerFifo[op][0];
     }
     createBd(builder, acqLock, acqMode, acqLockAction, relLock, relMode, buff,
-             offset, len, succ);
+             offset, len, succ, dims, packetID);
+  }
+
+  /// Function that returns the dimensions of the BDs of an objectFifo, see
+  /// createBdBlock() for lockMode. A split consumer objectFifo has the
+  /// fromStream dimensions of its consumer tile.
+  DimTupleArrayAttr getBdDimensions(ObjectFifoCreateOp op, int lockMode) {
+    if (lockMode == 0)
+      return op.getDimensionsToStreamAttr();
+    if (auto dims = op.getDimensionsFromStreamPerConsumerAttr())
+      return dims.getValue()[0];
+    return {};
   }
 
   /// Function that either calls createAIETileDMA(), createShimDMA() or
@@ -524,12 +686,184 @@ struct AIEObjectFifoStatefulTransformPass
       builder.setInsertionPointToStart(curr);
       createBdBlock<BufferOp>(builder, target, lockMode, acqNum, relNum,
                               buffersPerFifo[target][blockIndex], offset, len,
-                              channelDir, blockIndex, succ);
+                              channelDir, blockIndex, succ,
+                              getBdDimensions(op, lockMode));
       curr = succ;
       blockIndex++;
     }
   }
 
+  /// Function used to create a MemOp or MemTileDMAOp region with a DMA
+  /// channel that sends the elements of several objectFifos of the same tile
+  /// as packets, each objectFifo with its own packet ID. The BD chain sends
+  /// one element of each objectFifo in turn, so the objectFifos sharing the
+  /// channel must be produced at the same rate.
+  template <typename DMAOp>
+  void createPacketDMA(DeviceOp &device, OpBuilder &builder,
+                       ArrayRef<ObjectFifoCreateOp> fifos, int channelIndex) {
+    TileOp objFifoTileOp = fifos.front().getProducerTileOp();
+
+    // search for the DMA of the tile, if none exists, create one
+    DMAOp producerDMA;
+    for (auto dmaOp : device.getOps<DMAOp>()) {
+      if (dmaOp.getTile() == objFifoTileOp.getResult()) {
+        producerDMA = dmaOp;
+        break;
+      }
+    }
+    if (!producerDMA) {
+      builder.setInsertionPointToEnd(device.getBody());
+      producerDMA =
+          builder.create<DMAOp>(builder.getUnknownLoc(), objFifoTileOp);
+      Region &r = producerDMA.getBody();
+      r.push_back(new Block);
+      // add terminator operation to end block
+      builder.setInsertionPointToStart(&r.back());
+      builder.create<EndOp>(builder.getUnknownLoc());
+    }
+
+    Block *endBlock = findEndOpBlock(&(producerDMA.getBody()));
+    Block *lastDmaBlock = endBlock->getSinglePredecessor();
+    Block *dmaBlock = builder.createBlock(endBlock);
+    Block *bdBlock = builder.createBlock(endBlock);
+
+    // create DMA channel
+    builder.setInsertionPointToStart(dmaBlock);
+    builder.create<DMAStartOp>(builder.getUnknownLoc(), DMAChannelDir::MM2S,
+                               channelIndex, bdBlock, endBlock);
+    if (lastDmaBlock != nullptr)
+      lastDmaBlock->getTerminator()->setSuccessor(dmaBlock, 1);
+
+    // create Bd blocks, until the elements of all objectFifos line up again
+    int64_t numRounds = 1;
+    for (auto fifo : fifos)
+      numRounds = std::lcm(numRounds, (int64_t)fifo.size());
+    Block *curr = bdBlock;
+    for (int64_t round = 0; round < numRounds; round++) {
+      for (size_t i = 0; i < fifos.size(); i++) {
+        ObjectFifoCreateOp fifo = fifos[i];
+        Block *succ = bdBlock;
+        if (round < numRounds - 1 || i < fifos.size() - 1)
+          succ = builder.createBlock(endBlock);
+
+        MemRefType elemType = fifo.getElemType()
+                                  .cast<AIEObjectFifoType>()
+                                  .getElementType()
+                                  .cast<MemRefType>();
+        int blockIndex = round % fifo.size();
+        builder.setInsertionPointToStart(curr);
+        createBdBlock<BufferOp>(builder, fifo, 0, 1, 1,
+                                buffersPerFifo[fifo][blockIndex], 0,
+                                getMemrefTypeSize(elemType),
+                                DMAChannelDir::MM2S, blockIndex, succ,
+                                getBdDimensions(fifo, 0), packetIDs[fifo]);
+        curr = succ;
+      }
+    }
+  }
+
+  /// Function that returns true if an objectFifo can be sent as packets on
+  /// a DMA channel shared with other objectFifos of its producer tile.
+  bool canSendAsPackets(ObjectFifoCreateOp op) {
+    return !op.getProducerTileOp().isShimTile() && !getOptionalLinkOp(op);
+  }
+
+  /// Function that returns how the producer of an objectFifo accesses it:
+  /// for each acquire and release operation through the produce port, in
+  /// order, the number of elements and the trip counts of the for-loops
+  /// around the operation, innermost first (-1 if not constant).
+  std::vector<std::vector<int64_t>> getProductionRate(DeviceOp &device,
+                                                      ObjectFifoCreateOp op) {
+    std::vector<std::vector<int64_t>> rate;
+    device.walk([&](Operation *user) {
+      std::vector<int64_t> access;
+      if (auto acquireOp = dyn_cast<ObjectFifoAcquireOp>(user)) {
+        if (acquireOp.getObjectFifo() != op ||
+            acquireOp.getPort() != ObjectFifoPort::Produce)
+          return;
+        access = {0, acquireOp.acqNumber()};
+      } else if (auto releaseOp = dyn_cast<ObjectFifoReleaseOp>(user)) {
+        if (releaseOp.getObjectFifo() != op ||
+            releaseOp.getPort() != ObjectFifoPort::Produce)
+          return;
+        access = {1, releaseOp.relNumber()};
+      } else {
+        return;
+      }
+      for (Operation *parent = user->getParentOp();
+           parent && !isa<CoreOp, func::FuncOp>(parent);
+           parent = parent->getParentOp())
+        if (auto loop = dyn_cast<scf::ForOp>(parent))
+          access.push_back(getTripCount(loop));
+      rate.push_back(access);
+    });
+    return rate;
+  }
+
+  /// Function that finds the tiles with more objectFifos to send than free
+  /// master DMA channels. On such a tile, as many objectFifos as needed share
+  /// the last free channel as packet flows with distinct IDs, and all others
+  /// keep a channel of their own. Tiles are visited in IR order so that the
+  /// packet IDs do not depend on the addresses of the operations. Fails if
+  /// there are not enough objectFifos that can be sent as packets, if these
+  /// are not produced at the same rate, or if there are not enough free
+  /// packet IDs.
+  LogicalResult findSharedChannels(
+      DeviceOp &device, DMAChannelAnalysis &dmaAnalysis,
+      llvm::MapVector<TileOp, std::vector<ObjectFifoCreateOp>> &sharedFifos) {
+    llvm::MapVector<TileOp, std::vector<ObjectFifoCreateOp>> fifosPerTile;
+    for (auto &entry : splitFifos)
+      fifosPerTile[entry.first.getProducerTileOp()].push_back(entry.first);
+
+    std::set<int> usedIDs;
+    for (auto packetFlow : device.getOps<PacketFlowOp>())
+      usedIDs.insert(packetFlow.IDInt());
+    int nextID = 0;
+
+    for (auto &entry : fifosPerTile) {
+      TileOp tile = entry.first;
+      std::vector<ObjectFifoCreateOp> &fifos = entry.second;
+      int freeChannels = dmaAnalysis.getNumFreeMasterChannels(tile);
+      if ((int)fifos.size() <= freeChannels)
+        continue;
+
+      std::vector<ObjectFifoCreateOp> packetFifos;
+      for (auto fifo : fifos)
+        if (canSendAsPackets(fifo))
+          packetFifos.push_back(fifo);
+      size_t numShared = fifos.size() - freeChannels + 1;
+      if (freeChannels == 0 || packetFifos.size() < numShared)
+        return fifos.back().emitOpError("cannot be sent: tile (")
+               << tile.colIndex() << ", " << tile.rowIndex()
+               << ") does not have enough DMA channels";
+
+      // the BD chain of the shared channel sends one element of each
+      // objectFifo in turn, which only matches producers of the same rate
+      auto shared =
+          llvm::make_range(packetFifos.end() - numShared, packetFifos.end());
+      ObjectFifoCreateOp first = *shared.begin();
+      auto firstRate = getProductionRate(device, first);
+      for (auto fifo : shared)
+        if (fifo.size() != first.size() ||
+            getProductionRate(device, fifo) != firstRate)
+          return fifo.emitOpError("cannot share a DMA channel with '")
+                 << first.getName()
+                 << "': they are not produced at the same rate";
+
+      for (auto fifo : shared) {
+        while (usedIDs.count(nextID))
+          nextID++;
+        if (nextID >= maxPacketIDs)
+          return fifo.emitOpError(
+              "cannot be sent as packets: no packet IDs left");
+        packetIDs[fifo] = nextID;
+        usedIDs.insert(nextID);
+        sharedFifos[tile].push_back(fifo);
+      }
+    }
+    return success();
+  }
+
   /// Function used to create a ShimDMAOp region with a DMA channel.
   /// It uses creatBdBlock(), see there for lockMode input.
   void createShimDMA(DeviceOp &device, OpBuilder &builder,
@@ -595,7 +929,7 @@ struct AIEObjectFifoStatefulTransformPass
       createBdBlock<ExternalBufferOp>(builder, op, lockMode, acqNum, relNum,
                                       externalBuffersPerFifo[op][blockIndex],
                                       offset, len, channelDir, blockIndex,
-                                      succ);
+                                      succ, getBdDimensions(op, lockMode));
       curr = succ;
       blockIndex++;
     }
@@ -732,7 +1066,8 @@ struct AIEObjectFifoStatefulTransformPass
         offset = extraOffset * bytes;
       createBdBlock<BufferOp>(builder, target, lockMode, acqNum, relNum,
                               buffersPerFifo[target][blockIndex], offset,
-                              lenOut, channelDir, blockIndex, succ);
+                              lenOut, channelDir, blockIndex, succ,
+                              getBdDimensions(op, lockMode));
       curr = succ;
       blockIndex++;
     }
@@ -836,6 +1171,469 @@ struct AIEObjectFifoStatefulTransformPass
     }
   }
 
+  /// Function that returns true if an objectFifo can be lowered to the
+  /// cascade stream between two cores: its producer and its only consumer
+  /// must be cascade neighbours, its elements must fit in one cascade value
+  /// and its cores must acquire and release one element at a time. If the
+  /// objectFifo has the "cascade" attribute, the reason why it cannot be
+  /// lowered to a cascade is reported as an error.
+  bool canUseCascade(DeviceOp &device, ObjectFifoCreateOp op) {
+    bool requested = op->hasAttr("cascade");
+    auto fail = [&](const Twine &reason) {
+      if (requested)
+        op.emitOpError("cannot be lowered to a cascade: ") << reason;
+      return false;
+    };
+
+    if (op.getConsumerTiles().size() != 1)
+      return fail("it has more than one consumer");
+    TileOp producer = op.getProducerTileOp();
+    TileOp consumer = op.getConsumerTiles()[0].getDefiningOp<TileOp>();
+    const auto &targetModel = device.getTargetModel();
+    if (!targetModel.isLegalCascade(producer.colIndex(), producer.rowIndex(),
+                                    consumer.colIndex(), consumer.rowIndex()))
+      return fail("its consumer is not the cascade neighbour of its producer");
+    if (!producer.getCoreOp() || !consumer.getCoreOp())
+      return fail("its producer and consumer tiles must have cores");
+    if (getOptionalLinkOp(op))
+      return fail("it is used in an ObjectFifoLinkOp");
+    if (op.getDimensionsToStream() || op.getDimensionsFromStreamPerConsumer())
+      return fail("it has DMA dimensions");
+
+    auto elemType = op.getElemType()
+                        .cast<AIEObjectFifoType>()
+                        .getElementType()
+                        .cast<MemRefType>();
+    Type scalarType = elemType.getElementType();
+    unsigned cascadeWidth = targetModel.getCascadeWidth();
+    if (!elemType.hasStaticShape() || !scalarType.isIntOrFloat() ||
+        elemType.getNumElements() * scalarType.getIntOrFloatBitWidth() >
+            cascadeWidth)
+      return fail("its elements do not fit in one cascade value");
+
+    // each port must be used by its own core, one element at a time
+    auto usedByOneElement = [&](Operation *user, ObjectFifoPort port,
+                                int number) {
+      auto core = user->getParentOfType<CoreOp>();
+      TileOp tile = port == ObjectFifoPort::Produce ? producer : consumer;
+      return number == 1 && core && core.getTileOp() == tile;
+    };
+    bool oneElement = true;
+    device.walk([&](Operation *user) {
+      if (auto acquireOp = dyn_cast<ObjectFifoAcquireOp>(user)) {
+        if (acquireOp.getObjectFifo() == op)
+          oneElement &= usedByOneElement(user, acquireOp.getPort(),
+                                         acquireOp.acqNumber());
+      } else if (auto releaseOp = dyn_cast<ObjectFifoReleaseOp>(user)) {
+        if (releaseOp.getObjectFifo() == op)
+          oneElement &= usedByOneElement(user, releaseOp.getPort(),
+                                         releaseOp.relNumber());
+      }
+    });
+    if (!oneElement)
+      return fail("its cores must acquire and release one element at a time");
+    return true;
+  }
+
+  /// Function used to create the indices of the element of a memref at the
+  /// given position in row-major order.
+  SmallVector<Value, 4> getElementIndices(OpBuilder &builder,
+                                          MemRefType type, int64_t position) {
+    SmallVector<Value, 4> indices(type.getRank());
+    for (int64_t dim = type.getRank() - 1; dim >= 0; dim--) {
+      indices[dim] = builder.create<arith::ConstantIndexOp>(
+          builder.getUnknownLoc(), position % type.getDimSize(dim));
+      position /= type.getDimSize(dim);
+    }
+    return indices;
+  }
+
+  /// Function used to pack the elements of a buffer into a cascade value,
+  /// the first element in the lowest bits.
+  Value packCascadeValue(OpBuilder &builder, BufferOp buffer) {
+    auto loc = builder.getUnknownLoc();
+    auto type = buffer.getBuffer().getType().cast<MemRefType>();
+    unsigned width = type.getElementType().getIntOrFloatBitWidth();
+    unsigned cascadeWidth =
+        getTargetModel(buffer.getOperation()).getCascadeWidth();
+    auto cascadeType = builder.getIntegerType(cascadeWidth);
+    Value result = builder.create<arith::ConstantOp>(
+        loc, builder.getIntegerAttr(cascadeType, 0));
+    for (int64_t i = 0; i < type.getNumElements(); i++) {
+      Value element = builder.create<memref::LoadOp>(
+          loc, buffer.getBuffer(), getElementIndices(builder, type, i));
+      if (type.getElementType().isa<FloatType>())
+        element = builder.create<arith::BitcastOp>(
+            loc, builder.getIntegerType(width), element);
+      if (width < cascadeWidth)
+        element = builder.create<arith::ExtUIOp>(loc, cascadeType, element);
+      if (i > 0)
+        element = builder.create<arith::ShLIOp>(
+            loc, element,
+            builder.create<arith::ConstantOp>(
+                loc, builder.getIntegerAttr(cascadeType, i * width)));
+      result = builder.create<arith::OrIOp>(loc, result, element);
+    }
+    return result;
+  }
+
+  /// Function used to unpack a cascade value into the elements of a buffer,
+  /// the first element from the lowest bits.
+  void unpackCascadeValue(OpBuilder &builder, Value value, BufferOp buffer) {
+    auto loc = builder.getUnknownLoc();
+    auto type = buffer.getBuffer().getType().cast<MemRefType>();
+    unsigned width = type.getElementType().getIntOrFloatBitWidth();
+    unsigned cascadeWidth =
+        getTargetModel(buffer.getOperation()).getCascadeWidth();
+    auto cascadeType = builder.getIntegerType(cascadeWidth);
+    for (int64_t i = 0; i < type.getNumElements(); i++) {
+      Value element = value;
+      if (i > 0)
+        element = builder.create<arith::ShRUIOp>(
+            loc, element,
+            builder.create<arith::ConstantOp>(
+                loc, builder.getIntegerAttr(cascadeType, i * width)));
+      if (width < cascadeWidth)
+        element = builder.create<arith::TruncIOp>(
+            loc, builder.getIntegerType(width), element);
+      if (type.getElementType().isa<FloatType>())
+        element = builder.create<arith::BitcastOp>(loc, type.getElementType(),
+                                                   element);
+      builder.create<memref::StoreOp>(loc, element, buffer.getBuffer(),
+                                      getElementIndices(builder, type, i));
+    }
+  }
+
+  /// Function used to lower an objectFifo to the cascade stream between its
+  /// producer and consumer cores. Each core has one buffer for the element
+  /// it holds: the producer puts the element on the cascade when it releases
+  /// it, and the consumer gets the next element from the cascade when it
+  /// acquires it. The cascade stream blocks the cores, so no locks are used.
+  void createCascade(OpBuilder &builder, DeviceOp &device,
+                     ObjectFifoCreateOp op) {
+    auto loc = builder.getUnknownLoc();
+    auto elemType = op.getElemType()
+                        .cast<AIEObjectFifoType>()
+                        .getElementType()
+                        .cast<MemRefType>();
+    auto createBuffer = [&](Value tile, std::string name) {
+      BufferOp buff = builder.create<BufferOp>(loc, elemType, tile);
+      buff.getOperation()->setAttr(mlir::SymbolTable::getSymbolAttrName(),
+                                   builder.getStringAttr(name));
+      return buff;
+    };
+    builder.setInsertionPointAfter(op);
+    BufferOp producerBuffer =
+        createBuffer(op.getProducerTile(), op.name().str() + "_buff_0");
+    BufferOp consumerBuffer = createBuffer(
+        op.getConsumerTiles()[0], op.name().str() + "_cons_buff_0");
+
+    std::vector<Operation *> lowered; // erased once all uses are replaced
+    device.walk([&](ObjectFifoAcquireOp acquireOp) {
+      if (acquireOp.getObjectFifo() != op)
+        return;
+      BufferOp buffer = producerBuffer;
+      if (acquireOp.getPort() == ObjectFifoPort::Consume) {
+        buffer = consumerBuffer;
+        builder.setInsertionPointAfter(acquireOp);
+        Value value = builder.create<GetCascadeOp>(
+            loc, builder.getIntegerType(
+                     device.getTargetModel().getCascadeWidth()));
+        unpackCascadeValue(builder, value, buffer);
+      }
+      for (auto user : acquireOp->getUsers())
+        if (auto accessOp = dyn_cast<ObjectFifoSubviewAccessOp>(user)) {
+          accessOp.getOutput().replaceAllUsesWith(buffer.getBuffer());
+          lowered.push_back(accessOp);
+        }
+      lowered.push_back(acquireOp);
+    });
+    device.walk([&](ObjectFifoReleaseOp releaseOp) {
+      if (releaseOp.getObjectFifo() != op)
+        return;
+      if (releaseOp.getPort() == ObjectFifoPort::Produce) {
+        builder.setInsertionPoint(releaseOp);
+        builder.create<PutCascadeOp>(
+            loc, packCascadeValue(builder, producerBuffer));
+      }
+      lowered.push_back(releaseOp);
+    });
+    for (auto loweredOp : lowered)
+      loweredOp->erase();
+  }
+
+  /// Function that returns the number of iterations of a for-loop with
+  /// constant bounds, or -1 if its bounds are not constant.
+  int64_t getTripCount(scf::ForOp forLoop) {
+    auto lb = forLoop.getLowerBound().getDefiningOp<arith::ConstantIndexOp>();
+    auto ub = forLoop.getUpperBound().getDefiningOp<arith::ConstantIndexOp>();
+    auto step = forLoop.getStep().getDefiningOp<arith::ConstantIndexOp>();
+    if (!lb || !ub || !step || step.value() <= 0)
+      return -1;
+    if (ub.value() <= lb.value())
+      return 0;
+    return (ub.value() - lb.value() + step.value() - 1) / step.value();
+  }
+
+  /// Number of elements held through each port of each objectFifo, keyed
+  /// like acquiresPerFifo. Ports that hold no elements have no entry.
+  typedef std::map<std::pair<Operation *, int>, int64_t> HeldElements;
+
+  /// Function that returns true if an operation acquires or releases
+  /// objectFifo elements, directly or in a function it calls.
+  bool usesObjectFifos(Operation *op) {
+    auto result = op->walk([&](Operation *nested) {
+      if (isa<ObjectFifoAcquireOp, ObjectFifoReleaseOp>(nested))
+        return WalkResult::interrupt();
+      if (auto callOp = dyn_cast<func::CallOp>(nested))
+        if (auto callee = SymbolTable::lookupNearestSymbolFrom<func::FuncOp>(
+                callOp, callOp.getCalleeAttr()))
+          if (usesObjectFifos(callee))
+            return WalkResult::interrupt();
+      return WalkResult::advance();
+    });
+    return result.wasInterrupted();
+  }
+
+  /// Function that updates the elements held through each objectFifo port
+  /// after an operation, as the acquires are lowered: an acquire holds at
+  /// least the number of elements it asks for and a release gives up the
+  /// oldest ones. For-loops with constant bounds are run until they end or
+  /// until an iteration does not change the held elements anymore. Returns
+  /// false if the held elements cannot be known statically.
+  bool updateHeldElements(Operation *op, HeldElements &held) {
+    if (auto acquireOp = dyn_cast<ObjectFifoAcquireOp>(op)) {
+      auto portNum = (acquireOp.getPort() == ObjectFifoPort::Produce) ? 0 : 1;
+      std::pair<Operation *, int> key = {acquireOp.getObjectFifo(), portNum};
+      held[key] = std::max<int64_t>(held[key], acquireOp.acqNumber());
+      if (held[key] == 0)
+        held.erase(key);
+      return true;
+    }
+    if (auto releaseOp = dyn_cast<ObjectFifoReleaseOp>(op)) {
+      auto portNum = (releaseOp.getPort() == ObjectFifoPort::Produce) ? 0 : 1;
+      std::pair<Operation *, int> key = {releaseOp.getObjectFifo(), portNum};
+      held[key] -= releaseOp.relNumber();
+      if (held[key] <= 0)
+        held.erase(key);
+      return true;
+    }
+    if (!usesObjectFifos(op))
+      return true;
+    auto forLoop = dyn_cast<scf::ForOp>(op);
+    if (!forLoop || getTripCount(forLoop) < 0)
+      return false;
+    // the held elements are bounded by the largest acquire, so they settle
+    // after a few iterations unless they alternate between iterations
+    int64_t iterations = std::min<int64_t>(getTripCount(forLoop), 64);
+    for (int64_t i = 0; i < iterations; i++) {
+      HeldElements before = held;
+      for (Operation &bodyOp : forLoop.getBody()->without_terminator())
+        if (!updateHeldElements(&bodyOp, held))
+          return false;
+      if (held == before)
+        return true;
+    }
+    return iterations == getTripCount(forLoop);
+  }
+
+  /// Function that computes the elements held through each objectFifo port
+  /// when a for-loop of a core starts. The loops around it must hold the
+  /// same elements at the start of each of their iterations. Returns false
+  /// if the held elements cannot be known statically.
+  bool getHeldElementsAtEntry(scf::ForOp forLoop, HeldElements &held) {
+    SmallVector<Operation *> ancestors;
+    Operation *op = forLoop;
+    for (; op && !isa<CoreOp>(op); op = op->getParentOp())
+      ancestors.push_back(op);
+    if (!op)
+      return false;
+    for (Operation *ancestor : llvm::reverse(ancestors)) {
+      if (!ancestor->getParentRegion()->hasOneBlock())
+        return false;
+      for (Operation &prevOp : *ancestor->getBlock()) {
+        if (&prevOp == ancestor)
+          break;
+        if (!updateHeldElements(&prevOp, held))
+          return false;
+      }
+      if (ancestor == forLoop)
+        break;
+      auto loop = dyn_cast<scf::ForOp>(ancestor);
+      if (!loop)
+        return false;
+      HeldElements after = held;
+      for (Operation &bodyOp : loop.getBody()->without_terminator())
+        if (!updateHeldElements(&bodyOp, after))
+          return false;
+      if (after != held)
+        return false;
+    }
+    return true;
+  }
+
+  /// Function that returns true if the elements acquired and released in a
+  /// for-loop can be selected at runtime. The objectFifo operations must be
+  /// in the body of the loop or in nested for-loops with constant bounds.
+  /// As all iterations reuse the lowering of the first one, each iteration
+  /// must also acquire as many new elements as it releases, so that it ends
+  /// holding the same elements of each objectFifo port as it started with.
+  bool canIndexDynamically(scf::ForOp forLoop) {
+    if (getTripCount(forLoop) < 0)
+      return false;
+    auto result = forLoop.walk([&](Operation *op) {
+      if (!isa<ObjectFifoAcquireOp, ObjectFifoReleaseOp>(op))
+        return WalkResult::advance();
+      for (Operation *parent = op->getParentOp(); parent != forLoop;
+           parent = parent->getParentOp()) {
+        auto loop = dyn_cast<scf::ForOp>(parent);
+        if (!loop || getTripCount(loop) < 0)
+          return WalkResult::interrupt();
+      }
+      return WalkResult::advance();
+    });
+    if (result.wasInterrupted())
+      return false;
+
+    HeldElements held;
+    if (!getHeldElementsAtEntry(forLoop, held))
+      return false;
+    HeldElements entry = held;
+    for (Operation &bodyOp : forLoop.getBody()->without_terminator())
+      if (!updateHeldElements(&bodyOp, held))
+        return false;
+    return held == entry;
+  }
+
+  /// Function that returns the number of elements of an objectFifo released
+  /// through the given port in one iteration of a for-loop, i.e. by how many
+  /// elements the objectFifo advances in each iteration.
+  int64_t getAdvance(scf::ForOp forLoop, ObjectFifoCreateOp op,
+                     ObjectFifoPort port) {
+    int64_t advance = 0;
+    forLoop.walk([&](ObjectFifoReleaseOp releaseOp) {
+      if (releaseOp.getObjectFifo() != op || releaseOp.getPort() != port)
+        return;
+      int64_t released = releaseOp.relNumber();
+      for (Operation *parent = releaseOp->getParentOp(); parent != forLoop;
+           parent = parent->getParentOp())
+        released *= getTripCount(cast<scf::ForOp>(parent));
+      advance += released;
+    });
+    return advance;
+  }
+
+  /// Function that returns the for-loops around a block, innermost first,
+  /// that select the elements of their objectFifos at runtime.
+  std::vector<scf::ForOp> getDynamicLoops(Block *block) {
+    std::vector<scf::ForOp> loops;
+    for (Operation *parent = block->getParentOp();
+         parent && !isa<CoreOp>(parent); parent = parent->getParentOp())
+      if (auto loop = dyn_cast<scf::ForOp>(parent))
+        if (loop->hasAttr(dynamicIndexAttr))
+          loops.push_back(loop);
+    return loops;
+  }
+
+  /// Function used to create the index of an objectFifo element at runtime.
+  /// The given index is the one of the element in the first iteration of the
+  /// dynamic loops; in later iterations, the element is as many further as
+  /// the objectFifo advanced in the previous iterations, modulo its size.
+  Value createDynamicIndex(OpBuilder &builder, ArrayRef<scf::ForOp> loops,
+                           ObjectFifoCreateOp op, ObjectFifoPort port,
+                           int index) {
+    auto loc = builder.getUnknownLoc();
+    Value size = builder.create<arith::ConstantIndexOp>(loc, op.size());
+    Value result = builder.create<arith::ConstantIndexOp>(loc, index);
+    for (auto loop : loops) {
+      int64_t advance = getAdvance(loop, op, port) % op.size();
+      if (advance == 0)
+        continue;
+      // iteration = (iv - lb) / step, taken modulo the size first so that
+      // the offset does not overflow in long loops
+      Value iteration = builder.create<arith::SubIOp>(
+          loc, loop.getInductionVar(), loop.getLowerBound());
+      iteration =
+          builder.create<arith::DivUIOp>(loc, iteration, loop.getStep());
+      iteration = builder.create<arith::RemUIOp>(loc, iteration, size);
+      Value offset = builder.create<arith::MulIOp>(
+          loc, iteration, builder.create<arith::ConstantIndexOp>(loc, advance));
+      result = builder.create<arith::AddIOp>(loc, result, offset);
+    }
+    return builder.create<arith::RemUIOp>(loc, result, size);
+  }
+
+  /// Function used to select one of the buffers of an objectFifo at runtime.
+  Value createBufferSwitch(OpBuilder &builder, Value index,
+                           std::vector<BufferOp> &buffers) {
+    auto loc = builder.getUnknownLoc();
+    SmallVector<int64_t, 4> cases;
+    for (size_t i = 1; i < buffers.size(); i++)
+      cases.push_back(i);
+    Type type = buffers[0].getBuffer().getType();
+    auto switchOp = builder.create<scf::IndexSwitchOp>(
+        loc, TypeRange{type}, index, cases, cases.size());
+    OpBuilder::InsertionGuard guard(builder);
+    builder.setInsertionPointToStart(
+        &switchOp.getDefaultRegion().emplaceBlock());
+    builder.create<scf::YieldOp>(loc, buffers[0].getBuffer());
+    for (size_t i = 1; i < buffers.size(); i++) {
+      builder.setInsertionPointToStart(
+          &switchOp.getCaseRegions()[i - 1].emplaceBlock());
+      builder.create<scf::YieldOp>(loc, buffers[i].getBuffer());
+    }
+    return switchOp.getResult(0);
+  }
+
+  /// Function used to acquire or release one of the locks of an objectFifo,
+  /// selected at runtime.
+  void createLockSwitch(OpBuilder &builder, Value index,
+                        std::vector<LockOp> &locks, int lockMode,
+                        LockAction lockAction) {
+    auto loc = builder.getUnknownLoc();
+    SmallVector<int64_t, 4> cases;
+    for (size_t i = 1; i < locks.size(); i++)
+      cases.push_back(i);
+    auto switchOp = builder.create<scf::IndexSwitchOp>(
+        loc, TypeRange{}, index, cases, cases.size());
+    OpBuilder::InsertionGuard guard(builder);
+    for (size_t i = 0; i < locks.size(); i++) {
+      Region &region = i == 0 ? switchOp.getDefaultRegion()
+                              : switchOp.getCaseRegions()[i - 1];
+      builder.setInsertionPointToStart(&region.emplaceBlock());
+      builder.create<UseLockOp>(loc, locks[i], lockMode, lockAction);
+      builder.create<scf::YieldOp>(loc);
+    }
+  }
+
+  /// Function used to move the indices of the next elements to acquire or
+  /// release, and of the acquired elements, from the end of the first
+  /// iteration of a dynamic loop to the end of its last iteration.
+  void skipDynamicIterations(
+      scf::ForOp forLoop,
+      DenseMap<std::pair<ObjectFifoCreateOp, int>, int> &acc,
+      DenseMap<std::pair<ObjectFifoCreateOp, int>, std::vector<int>>
+          *acquired = nullptr) {
+    if (!forLoop->hasAttr(dynamicIndexAttr))
+      return;
+    int64_t skipped = getTripCount(forLoop) - 1;
+    for (auto &[key, index] : acc) {
+      auto [op, portNum] = key;
+      auto port = portNum == 0 ? ObjectFifoPort::Produce
+                               : ObjectFifoPort::Consume;
+      int64_t size = op.size();
+      int64_t shift =
+          (skipped % size) * (getAdvance(forLoop, op, port) % size) % size;
+      shift = (shift + size) % size;
+      if (shift == 0)
+        continue;
+      index = (index + shift) % size;
+      if (acquired)
+        for (auto &acquiredIndex : (*acquired)[key])
+          acquiredIndex = (acquiredIndex + shift) % size;
+    }
+  }
+
   // Function that unrolls for-loops that contain objectFifo operations.
   void unrollForLoops(DeviceOp &device, OpBuilder &builder,
                       std::set<TileOp> objectFifoTiles) {
@@ -897,6 +1695,16 @@ struct AIEObjectFifoStatefulTransformPass
             int64_t num_iter =
                 (old_upper_value - old_lower_value) / old_step_value;
 
+            // keep the loop rolled and select the objectFifo elements at
+            // runtime when unrolling would duplicate its body too often
+            int64_t num_copies = std::min<int64_t>(num_iter, unrollFactor);
+            if (clUnrollLimit > 0 && num_copies > clUnrollLimit &&
+                canIndexDynamically(forLoop)) {
+              forLoop->setAttr(dynamicIndexAttr, builder.getUnitAttr());
+              numDynamicLoops++;
+              return;
+            }
+
             int64_t num_unrolls =
                 0; // number of times to unroll loop, not counting original body
 
@@ -973,33 +1781,59 @@ struct AIEObjectFifoStatefulTransformPass
           (port == ObjectFifoPort::Consume &&
            lockAction == LockAction::Acquire))
         lockMode = 1;
+      auto loops = getDynamicLoops(builder.getInsertionBlock());
       for (int i = 0; i < numLocks; i++) {
         int lockID = acc[{op, portNum}];
-        builder.create<UseLockOp>(builder.getUnknownLoc(),
-                                  locksPerFifo[target][lockID], lockMode,
-                                  lockAction);
+        if (loops.empty()) {
+          builder.create<UseLockOp>(builder.getUnknownLoc(),
+                                    locksPerFifo[target][lockID], lockMode,
+                                    lockAction);
+        } else {
+          Value index = createDynamicIndex(builder, loops, op, port, lockID);
+          createLockSwitch(builder, index, locksPerFifo[target], lockMode,
+                           lockAction);
+        }
         acc[{op, portNum}] =
             (lockID + 1) % op.size(); // update to next objFifo elem
       }
     } else {
       if (numLocks == 0)
         return;
-      // search for the correct lock based on the port of the acq/rel
-      // operation e.g. acq as consumer is the read lock (second)
-      LockOp lock;
-      if (lockAction == LockAction::AcquireGreaterEqual) {
-        if (port == ObjectFifoPort::Produce)
-          lock = locksPerFifo[target][0];
-        else
-          lock = locksPerFifo[target][1];
-      } else {
-        if (port == ObjectFifoPort::Produce)
-          lock = locksPerFifo[target][1];
-        else
-          lock = locksPerFifo[target][0];
+      // the locks of a broadcast with shared elements come in pairs: the
+      // producer uses all of them, each consumer its own pair
+      ArrayRef<LockOp> locks = locksPerFifo[target];
+      if (sharedConsumers.count(target) == 0) {
+        locks = locks.take_front(2);
+      } else if (port == ObjectFifoPort::Consume) {
+        Operation *parent = builder.getInsertionBlock()->getParentOp();
+        auto coreOp = dyn_cast<CoreOp>(parent);
+        if (!coreOp)
+          coreOp = parent->getParentOfType<CoreOp>();
+        std::vector<TileOp> &consumers = sharedConsumers[target];
+        size_t first = locks.size() - 2 * consumers.size();
+        size_t index = llvm::find(consumers, coreOp.getTileOp()) -
+                       consumers.begin();
+        assert(index < consumers.size() && "consumer does not share memory");
+        locks = locks.slice(first + 2 * index, 2);
+      }
+      for (size_t i = 0; i < locks.size(); i += 2) {
+        // search for the correct lock based on the port of the acq/rel
+        // operation e.g. acq as consumer is the read lock (second)
+        LockOp lock;
+        if (lockAction == LockAction::AcquireGreaterEqual) {
+          if (port == ObjectFifoPort::Produce)
+            lock = locks[i];
+          else
+            lock = locks[i + 1];
+        } else {
+          if (port == ObjectFifoPort::Produce)
+            lock = locks[i + 1];
+          else
+            lock = locks[i];
+        }
+        builder.create<UseLockOp>(builder.getUnknownLoc(), lock, numLocks,
+                                  lockAction);
       }
-      builder.create<UseLockOp>(builder.getUnknownLoc(), lock, numLocks,
-                                lockAction);
       acc[{op, portNum}] = (acc[{op, portNum}] + numLocks) %
                            op.size(); // update to next objFifo elem
     }
@@ -1121,6 +1955,24 @@ struct AIEObjectFifoStatefulTransformPass
     OpBuilder builder = OpBuilder::atBlockEnd(device.getBody());
     auto ctx = device->getContext();
 
+    //===------------------------------------------------------------------===//
+    // Create cascades
+    //===------------------------------------------------------------------===//
+    DenseSet<ObjectFifoCreateOp> cascadeFifos;
+    for (auto createOp : device.getOps<ObjectFifoCreateOp>()) {
+      bool requested = createOp->hasAttr("cascade");
+      if (!requested && !clCascade)
+        continue;
+      if (!canUseCascade(device, createOp)) {
+        if (requested)
+          return signalPassFailure();
+        continue;
+      }
+      createCascade(builder, device, createOp);
+      cascadeFifos.insert(createOp);
+      numCascadeFifos++;
+    }
+
     //===------------------------------------------------------------------===//
     // Create objectFifos
     //===------------------------------------------------------------------===//
@@ -1128,17 +1980,29 @@ struct AIEObjectFifoStatefulTransformPass
         objectFifoTiles; // track cores to check for loops during unrolling
 
     for (auto createOp : device.getOps<ObjectFifoCreateOp>()) {
+      if (cascadeFifos.contains(createOp))
+        continue;
       objectFifoTiles.insert(createOp.getProducerTileOp());
       bool shared = false;
       std::vector<ObjectFifoCreateOp> splitConsumerFifos;
       int share_direction = 0;
       int consumerIndex = 0;
       int consumerDepth = createOp.size();
+      std::vector<TileOp> broadcastConsumers;
+      TileOp broadcastMemory =
+          findBroadcastMemory(device, createOp, broadcastConsumers);
 
       for (auto consumerTile : createOp.getConsumerTiles()) {
         TileOp consumerTileOp = dyn_cast<TileOp>(consumerTile.getDefiningOp());
         objectFifoTiles.insert(consumerTileOp);
 
+        // consumers of a broadcast that can access the memory of its
+        // elements share them, the others get a copy through a DMA
+        if (llvm::is_contained(broadcastConsumers, consumerTileOp)) {
+          consumerIndex++;
+          continue;
+        }
+
         // if there is no broadcast, we can optimize in shared memory case
         if (createOp.getConsumerTiles().size() == 1) {
           bool memoryAdjacent = isSharedMemory(
@@ -1174,6 +2038,10 @@ struct AIEObjectFifoStatefulTransformPass
         ObjectFifoCreateOp consumerFifo =
             createObjectFifo(builder, datatype, consumerFifoName, consumerTile,
                              consumerTile, consumerObjFifoSize);
+        if (auto dims = createOp.getDimensionsFromStreamPerConsumerAttr())
+          consumerFifo.setDimensionsFromStreamPerConsumerAttr(
+              DimTupleArrayArrayAttr::get(
+                  ctx, {dims.getValue()[splitConsumerFifos.size()]}));
         replaceSplitFifo(createOp, consumerFifo, consumerTileOp);
 
         // identify external buffers that were registered to
@@ -1204,8 +2072,36 @@ struct AIEObjectFifoStatefulTransformPass
         detectExternalBuffers(device, createOp, createOp,
                               createOp.getProducerTile());
 
+      if (broadcastMemory) {
+        // the shared elements are also used by the consumers, keep the
+        // largest of their depths
+        if (isa<ArrayAttr>(createOp.getElemNumber())) {
+          int depth = createOp.size();
+          for (auto consumer : broadcastConsumers) {
+            auto consumerTiles = createOp.getConsumerTiles();
+            auto position = llvm::find(consumerTiles, consumer.getResult()) -
+                            consumerTiles.begin();
+            depth = std::max(depth, createOp.size(position + 1));
+          }
+          createOp->setAttr("elemNumber", builder.getI32IntegerAttr(depth));
+        }
+        sharedConsumers[createOp] = broadcastConsumers;
+        createBroadcastElements(builder, lockAnalysis, createOp,
+                                broadcastMemory, !splitConsumerFifos.empty());
+        if (!splitConsumerFifos.empty())
+          splitFifos.push_back({createOp, splitConsumerFifos});
+        numSharedBroadcasts++;
+        continue;
+      }
+
       // if split, the necessary size for producer fifo might change
       if (shared) {
+        if (createOp.getDimensionsToStream() ||
+            createOp.getDimensionsFromStreamPerConsumer()) {
+          createOp.emitOpError("DMA dimensions cannot be used with an "
+                               "objectFifo between tiles that share memory");
+          return signalPassFailure();
+        }
         createObjectFifoElements(builder, lockAnalysis, createOp,
                                  share_direction);
       } else {
@@ -1228,12 +2124,34 @@ struct AIEObjectFifoStatefulTransformPass
     //===------------------------------------------------------------------===//
     // Create flows and tile DMAs
     //===------------------------------------------------------------------===//
+    llvm::MapVector<TileOp, std::vector<ObjectFifoCreateOp>> sharedFifos;
+    if (failed(findSharedChannels(device, dmaAnalysis, sharedFifos)))
+      return signalPassFailure();
+    DenseMap<TileOp, xilinx::AIE::DMAChannel> sharedChannels;
+
     for (auto &[producer, consumers] : splitFifos) {
-      // create producer tile DMA
-      xilinx::AIE::DMAChannel producerChan =
-          dmaAnalysis.getMasterDMAChannel(producer.getProducerTile());
-      createDMA(device, builder, producer, producerChan.first,
-                producerChan.second, 0);
+      // create producer tile DMA, or share the DMA channel of the tile
+      TileOp producerTile = producer.getProducerTileOp();
+      bool isPacket = packetIDs.count(producer);
+      xilinx::AIE::DMAChannel producerChan;
+      if (!isPacket) {
+        producerChan = dmaAnalysis.getMasterDMAChannel(producerTile);
+        createDMA(device, builder, producer, producerChan.first,
+                  producerChan.second, 0);
+      } else if (sharedChannels.count(producerTile)) {
+        producerChan = sharedChannels[producerTile];
+      } else {
+        producerChan = dmaAnalysis.getMasterDMAChannel(producerTile);
+        sharedChannels[producerTile] = producerChan;
+        if (producerTile.isMemTile())
+          createPacketDMA<MemTileDMAOp>(device, builder,
+                                        sharedFifos[producerTile],
+                                        producerChan.second);
+        else
+          createPacketDMA<MemOp>(device, builder, sharedFifos[producerTile],
+                                 producerChan.second);
+        numPacketFifos += sharedFifos[producerTile].size();
+      }
       // generate objectFifo allocation info
       builder.setInsertionPoint(&device.getBody()->back());
       if (producer.getProducerTileOp().isShimTile())
@@ -1242,6 +2160,7 @@ struct AIEObjectFifoStatefulTransformPass
             producer.getProducerTileOp().colIndex(), producerChan.first,
             producerChan.second);
 
+      PacketFlowOp packetFlow;
       for (auto consumer : consumers) {
         // create consumer tile DMA
         xilinx::AIE::DMAChannel consumerChan =
@@ -1256,12 +2175,34 @@ struct AIEObjectFifoStatefulTransformPass
               consumer.getProducerTileOp().colIndex(), consumerChan.first,
               consumerChan.second);
 
-        // create flow
+        // create flow, or a packet flow with a destination for each consumer
+        if (isPacket) {
+          if (!packetFlow) {
+            builder.setInsertionPointAfter(producer);
+            packetFlow = builder.create<PacketFlowOp>(
+                builder.getUnknownLoc(), packetIDs[producer]);
+            builder.createBlock(&packetFlow.getPorts());
+            builder.create<PacketSourceOp>(builder.getUnknownLoc(),
+                                           producerTile, WireBundle::DMA,
+                                           producerChan.second);
+            builder.create<EndOp>(builder.getUnknownLoc());
+          }
+          builder.setInsertionPoint(
+              packetFlow.getPorts().front().getTerminator());
+          auto packetDest = builder.create<PacketDestOp>(
+              builder.getUnknownLoc(), consumer.getProducerTile(),
+              WireBundle::DMA, consumerChan.second);
+          // the consumer receives the elements without their headers
+          packetDest->setAttr("drop_header", builder.getUnitAttr());
+          continue;
+        }
         builder.setInsertionPointAfter(producer);
-        builder.create<FlowOp>(builder.getUnknownLoc(),
-                               producer.getProducerTile(), WireBundle::DMA,
-                               producerChan.second, consumer.getProducerTile(),
-                               WireBundle::DMA, consumerChan.second);
+        FlowOp flow = builder.create<FlowOp>(
+            builder.getUnknownLoc(), producer.getProducerTile(),
+            WireBundle::DMA, producerChan.second, consumer.getProducerTile(),
+            WireBundle::DMA, consumerChan.second);
+        if (auto priority = producer->getAttrOfType<IntegerAttr>("priority"))
+          flow->setAttr("priority", priority);
       }
     }
 
@@ -1277,6 +2218,9 @@ struct AIEObjectFifoStatefulTransformPass
       DenseMap<ObjectFifoAcquireOp, std::vector<BufferOp *>>
           subviews; // maps each "subview" to its buffer references (subviews
                     // are created by AcquireOps)
+      DenseMap<ObjectFifoAcquireOp, std::vector<int>>
+          subviewIndices; // maps each "subview" to the indices of its buffers
+                          // in the first iteration of dynamic loops
       DenseMap<std::pair<ObjectFifoCreateOp, int>, std::vector<int>>
           acquiresPerFifo; // maps each objFifo to indices of buffers acquired
                            // in latest subview of that objFifo (useful to
@@ -1295,7 +2239,12 @@ struct AIEObjectFifoStatefulTransformPass
       //===----------------------------------------------------------------===//
       // Replace objectFifo.release ops
       //===----------------------------------------------------------------===//
-      coreOp.walk([&](ObjectFifoReleaseOp releaseOp) {
+      coreOp.walk([&](Operation *walkOp) {
+        if (auto forLoop = dyn_cast<scf::ForOp>(walkOp))
+          skipDynamicIterations(forLoop, relPerFifo);
+        auto releaseOp = dyn_cast<ObjectFifoReleaseOp>(walkOp);
+        if (!releaseOp)
+          return;
         builder.setInsertionPointAfter(releaseOp);
         ObjectFifoCreateOp op = releaseOp.getObjectFifo();
         auto port = releaseOp.getPort();
@@ -1330,7 +2279,12 @@ struct AIEObjectFifoStatefulTransformPass
       //===----------------------------------------------------------------===//
       // Replace objectFifo.acquire ops
       //===----------------------------------------------------------------===//
-      coreOp.walk([&](ObjectFifoAcquireOp acquireOp) {
+      coreOp.walk([&](Operation *walkOp) {
+        if (auto forLoop = dyn_cast<scf::ForOp>(walkOp))
+          skipDynamicIterations(forLoop, acqPerFifo, &acquiresPerFifo);
+        auto acquireOp = dyn_cast<ObjectFifoAcquireOp>(walkOp);
+        if (!acquireOp)
+          return;
         ObjectFifoCreateOp op = acquireOp.getObjectFifo();
         builder.setInsertionPointAfter(acquireOp);
         auto port = acquireOp.getPort();
@@ -1446,6 +2400,7 @@ struct AIEObjectFifoStatefulTransformPass
           subviewRefs.push_back(&buffersPerFifo[target][index]);
 
         subviews[acquireOp] = subviewRefs;
+        subviewIndices[acquireOp] = acquiredIndices;
         acquiresPerFifo[{op, portNum}] = acquiredIndices;
       });
 
@@ -1462,11 +2417,26 @@ struct AIEObjectFifoStatefulTransformPass
                                 "ObjectFifoLinkOp");
           return;
         }
+        auto loops = getDynamicLoops(acqOp->getBlock());
+        if (loops.empty()) {
+          accessOp.getOutput().replaceAllUsesWith(
+              subviews[acqOp][accessOp.getIndex()]->getBuffer());
+          return;
+        }
+        builder.setInsertionPoint(accessOp);
+        Value index =
+            createDynamicIndex(builder, loops, op, acqOp.getPort(),
+                               subviewIndices[acqOp][accessOp.getIndex()]);
         accessOp.getOutput().replaceAllUsesWith(
-            subviews[acqOp][accessOp.getIndex()]->getBuffer());
+            createBufferSwitch(builder, index, buffersPerFifo[op]));
       });
     }
 
+    // dynamic loops are not marked any more once the objectFifos are lowered
+    device.walk([&](scf::ForOp forLoop) {
+      forLoop->removeAttr(dynamicIndexAttr);
+    });
+
     // make global symbols to replace the to be erased ObjectFifoCreateOps
     for (auto createOp : device.getOps<ObjectFifoCreateOp>()) {
       builder.setInsertionPointToStart(&(device.getBodyRegion().front()));
@@ -8,8 +8,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "mlir/IR/Threading.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_os_ostream.h"
+#include <cstdlib>
 #include <iostream>
 
 #include <aie/Dialect/AIE/Transforms/AIEPathfinder.h>
@@ -38,49 +40,311 @@ WireBundle getConnectingBundle(WireBundle dir) {
   }
 }
 
-Pathfinder::Pathfinder() { initializeGraph(0, 0); }
-
-Pathfinder::Pathfinder(int _maxcol, int _maxrow) {
-  initializeGraph(_maxcol, _maxrow);
+// index of a cardinal direction in the per-vertex edge table, or -1
+static int directionIndex(WireBundle bundle) {
+  switch (bundle) {
+  case WireBundle::North:
+    return 0;
+  case WireBundle::South:
+    return 1;
+  case WireBundle::East:
+    return 2;
+  case WireBundle::West:
+    return 3;
+  default:
+    return -1;
+  }
 }
 
-void Pathfinder::initializeGraph(int maxcol, int maxrow) {
+void SwitchboxGraph::initialize(int maxcol, int maxrow,
+                                const AIETargetModel *targetModel) {
+  cols = maxcol + 1;
+  rows = maxrow + 1;
+  vertices.assign(cols * rows, Switchbox());
+  edges.clear();
+  edgeByDirection.assign(4 * vertices.size(), NO_EDGE);
+
+  auto addEdge = [&](unsigned src, unsigned dst, WireBundle bundle,
+                     unsigned short capacity) {
+    Channel ch;
+    ch.demand = 1;
+    ch.used_capacity = 0;
+    ch.max_capacity = capacity;
+    ch.over_capacity_count = 0;
+    ch.bundle = bundle;
+    ch.src = src;
+    ch.target = dst;
+    edgeByDirection[4 * src + directionIndex(bundle)] = edges.size();
+    edges.push_back(ch);
+  };
+
+  // The capacity of the Channel leaving src in the given direction is the
+  // number of switchbox ports driving that direction in src, bounded by the
+  // number of ports receiving from the opposite direction in dst. Without a
+  // target model, or for tiles outside of it, the AIE1 core tile capacities
+  // are used.
+  auto capacity = [&](unsigned src, unsigned dst, WireBundle bundle,
+                      unsigned short defaultCapacity) -> unsigned short {
+    TileID srcTile = {vertices[src].col, vertices[src].row};
+    TileID dstTile = {vertices[dst].col, vertices[dst].row};
+    if (!targetModel || !targetModel->isValidTile(srcTile) ||
+        !targetModel->isValidTile(dstTile))
+      return defaultCapacity;
+    return std::min(targetModel->getNumDestSwitchboxConnections(
+                        srcTile.first, srcTile.second, bundle),
+                    targetModel->getNumSourceSwitchboxConnections(
+                        dstTile.first, dstTile.second,
+                        getConnectingBundle(bundle)));
+  };
+  auto addEdgeIfUsable = [&](unsigned src, unsigned dst, WireBundle bundle,
+                             unsigned short defaultCapacity) {
+    unsigned short c = capacity(src, dst, bundle, defaultCapacity);
+    if (c > 0)
+      addEdge(src, dst, bundle, c);
+  };
+
   // make grid of switchboxes
-  for (int row = 0; row <= maxrow; row++) {
-    for (int col = 0; col <= maxcol; col++) {
-      int id = add_vertex(graph);
-      graph[id].row = row;
-      graph[id].col = col;
-      graph[id].pred = 0;
-      graph[id].processed = false;
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < cols; col++) {
+      unsigned id = vertexIndex(col, row);
+      vertices[id].row = row;
+      vertices[id].col = col;
       if (row > 0) { // if not in row 0 add channel to North/South
-        auto north_edge = add_edge(id - maxcol - 1, id, graph).first;
-        graph[north_edge].bundle = WireBundle::North;
-        graph[north_edge].max_capacity = 6;
-        auto south_edge = add_edge(id, id - maxcol - 1, graph).first;
-        graph[south_edge].bundle = WireBundle::South;
-        graph[south_edge].max_capacity = 4;
+        addEdgeIfUsable(id - cols, id, WireBundle::North, 6);
+        addEdgeIfUsable(id, id - cols, WireBundle::South, 4);
       }
       if (col > 0) { // if not in col 0 add channel to East/West
-        auto east_edge = add_edge(id - 1, id, graph).first;
-        graph[east_edge].bundle = WireBundle::East;
-        graph[east_edge].max_capacity = 4;
-        auto west_edge = add_edge(id, id - 1, graph).first;
-        graph[west_edge].bundle = WireBundle::West;
-        graph[west_edge].max_capacity = 4;
+        addEdgeIfUsable(id - 1, id, WireBundle::East, 4);
+        addEdgeIfUsable(id, id - 1, WireBundle::West, 4);
+      }
+    }
+  }
+
+  // build the adjacency array, keeping the outgoing edges of each vertex in
+  // the order they were created
+  outEdgeOffsets.assign(vertices.size() + 1, 0);
+  for (Channel &ch : edges)
+    outEdgeOffsets[ch.src + 1]++;
+  for (unsigned v = 0; v < vertices.size(); v++)
+    outEdgeOffsets[v + 1] += outEdgeOffsets[v];
+  outEdgeList.resize(edges.size());
+  std::vector<unsigned> fill(outEdgeOffsets.begin(), outEdgeOffsets.end() - 1);
+  for (unsigned e = 0; e < edges.size(); e++)
+    outEdgeList[fill[edges[e].src]++] = e;
+}
+
+int SwitchboxGraph::edgeIndex(unsigned v, WireBundle bundle) const {
+  int dir = directionIndex(bundle);
+  if (dir < 0)
+    return NO_EDGE;
+  return edgeByDirection[4 * v + dir];
+}
+
+int SwitchboxGraph::edgeBetween(unsigned src, unsigned dst) const {
+  const Switchbox &s = vertices[src];
+  const Switchbox &d = vertices[dst];
+  if (s.col == d.col && s.row + 1 == d.row)
+    return edgeIndex(src, WireBundle::North);
+  if (s.col == d.col && s.row == d.row + 1)
+    return edgeIndex(src, WireBundle::South);
+  if (s.row == d.row && s.col + 1 == d.col)
+    return edgeIndex(src, WireBundle::East);
+  if (s.row == d.row && s.col == d.col + 1)
+    return edgeIndex(src, WireBundle::West);
+  return NO_EDGE;
+}
+
+namespace {
+// A 4-ary indirect min-heap of vertices ordered by their key. Ties are broken
+// the same way as the d-ary heap of the boost graph library, so that searches
+// explore equal cost paths in a reproducible order.
+class VertexHeap {
+  static constexpr size_t Arity = 4;
+  static constexpr size_t NotInHeap = (size_t)-1;
+  std::vector<unsigned> &data;
+  std::vector<size_t> &indexInHeap;
+  const std::vector<float> &key;
+
+  static size_t parent(size_t index) { return (index - 1) / Arity; }
+  static size_t child(size_t index, size_t n) { return index * Arity + n + 1; }
+
+  void siftUp(size_t index) {
+    if (index == 0)
+      return;
+    unsigned moving = data[index];
+    float movingKey = key[moving];
+    while (index > 0) {
+      size_t parentIndex = parent(index);
+      unsigned parentValue = data[parentIndex];
+      if (!(movingKey < key[parentValue]))
+        break;
+      data[index] = parentValue;
+      indexInHeap[parentValue] = index;
+      index = parentIndex;
+    }
+    data[index] = moving;
+    indexInHeap[moving] = index;
+  }
+
+  void siftDown() {
+    size_t index = 0;
+    unsigned moving = data[0];
+    float movingKey = key[moving];
+    size_t size = data.size();
+    for (;;) {
+      size_t first = child(index, 0);
+      if (first >= size)
+        break;
+      size_t last = std::min(first + Arity, size);
+      size_t smallest = first;
+      float smallestKey = key[data[first]];
+      for (size_t i = first + 1; i < last; i++) {
+        if (key[data[i]] < smallestKey) {
+          smallest = i;
+          smallestKey = key[data[i]];
+        }
       }
+      if (!(smallestKey < movingKey))
+        break;
+      data[index] = data[smallest];
+      indexInHeap[data[index]] = index;
+      data[smallest] = moving;
+      indexInHeap[moving] = smallest;
+      index = smallest;
     }
   }
 
-  // initialize weights of all Channels to 1
-  // initialize other variables
-  auto edge_pair = edges(graph);
-  for (auto edge = edge_pair.first; edge != edge_pair.second; edge++) {
-    graph[*edge].demand = 1;
-    graph[*edge].used_capacity = 0;
-    graph[*edge].fixed_capacity.clear();
-    graph[*edge].over_capacity_count = 0;
+public:
+  VertexHeap(std::vector<unsigned> &data, std::vector<size_t> &indexInHeap,
+             const std::vector<float> &key)
+      : data(data), indexInHeap(indexInHeap), key(key) {
+    data.clear();
+  }
+  bool empty() const { return data.empty(); }
+  unsigned top() const { return data[0]; }
+  void push(unsigned v) {
+    data.push_back(v);
+    indexInHeap[v] = data.size() - 1;
+    siftUp(data.size() - 1);
+  }
+  void pop() {
+    indexInHeap[data[0]] = NotInHeap;
+    if (data.size() == 1) {
+      data.pop_back();
+      return;
+    }
+    data[0] = data.back();
+    indexInHeap[data[0]] = 0;
+    data.pop_back();
+    siftDown();
   }
+  // restore the heap after the key of v has decreased
+  void update(unsigned v) { siftUp(indexInHeap[v]); }
+};
+
+enum SearchColor : unsigned char { White, Gray, Black };
+} // namespace
+
+// addition that saturates at infinity, like boost's closed_plus
+static float closedPlus(float a, float b) {
+  const float inf = std::numeric_limits<float>::max();
+  if (a == inf || b == inf)
+    return inf;
+  return a + b;
+}
+
+// SwitchboxGraph::shortestPaths
+// Find shortest paths from src using the channel demands as weights and
+// record them in the predecessor map of the search state. The search stops as
+// soon as the paths to every vertex in dsts are final. If heuristicTarget is a
+// vertex, the search is an A* search towards it using the Manhattan distance,
+// which never overestimates since every channel has a demand of at least 1.
+// The weight of a Channel for a flow of priority p is (demand + p) / (1 + p),
+// so that the higher the priority, the more each hop counts against the
+// congestion and the less the flow is pushed onto a detour.
+// The graph is only read, so searches with different states can run
+// concurrently.
+void SwitchboxGraph::shortestPaths(SearchState &state, unsigned src,
+                                   const std::vector<unsigned> &dsts,
+                                   int heuristicTarget, int priority) const {
+  const float inf = std::numeric_limits<float>::max();
+  unsigned numVertices = vertices.size();
+  std::vector<float> &distance = state.distance;
+  std::vector<float> &heapKey = state.heapKey;
+  std::vector<unsigned char> &color = state.color;
+  distance.assign(numVertices, inf);
+  heapKey.assign(numVertices, inf);
+  color.assign(numVertices, White);
+  state.indexInHeap.assign(numVertices, (size_t)-1);
+  state.pred.resize(numVertices);
+  for (unsigned v = 0; v < numVertices; v++)
+    state.pred[v] = v;
+
+  auto heuristic = [&](unsigned v) -> float {
+    if (heuristicTarget < 0)
+      return 0;
+    const Switchbox &sb = vertices[v];
+    const Switchbox &target = vertices[heuristicTarget];
+    return std::abs(sb.col - target.col) + std::abs(sb.row - target.row);
+  };
+
+  // count the destinations whose paths are not yet final
+  unsigned remaining = 0;
+  std::vector<bool> isDst(numVertices, false);
+  for (unsigned dst : dsts)
+    if (!isDst[dst]) {
+      isDst[dst] = true;
+      remaining++;
+    }
+
+  VertexHeap queue(state.heap, state.indexInHeap, heapKey);
+  distance[src] = 0;
+  heapKey[src] = heuristic(src);
+  color[src] = Gray;
+  queue.push(src);
+  while (!queue.empty() && remaining > 0) {
+    unsigned u = queue.top();
+    queue.pop();
+    const unsigned *end = outEdgesEnd(u);
+    for (const unsigned *e = outEdgesBegin(u); e != end; e++) {
+      const Channel &ch = edges[*e];
+      unsigned v = ch.target;
+      if (color[v] == Black)
+        continue;
+      float weight = ch.demand;
+      if (priority > 0 && weight != inf)
+        weight = (weight + priority) / (1 + priority);
+      float d = closedPlus(distance[u], weight);
+      bool decreased = d < distance[v];
+      if (decreased) {
+        distance[v] = d;
+        heapKey[v] = closedPlus(d, heuristic(v));
+        state.pred[v] = u;
+      }
+      if (color[v] == White) {
+        color[v] = Gray;
+        queue.push(v);
+      } else if (decreased) {
+        queue.update(v);
+      }
+    }
+    color[u] = Black;
+    if (isDst[u])
+      remaining--;
+  }
+}
+
+Pathfinder::Pathfinder() { initializeGraph(0, 0); }
+
+Pathfinder::Pathfinder(int _maxcol, int _maxrow,
+                       const AIETargetModel *targetModel) {
+  initializeGraph(_maxcol, _maxrow, targetModel);
+}
+
+void Pathfinder::initializeGraph(int maxcol, int maxrow,
+                                 const AIETargetModel *targetModel) {
+  // make grid of switchboxes, with the weights of all Channels set to 1
+  graph.initialize(maxcol, maxrow, targetModel);
 
   // initialize maximum iterations flag
   Pathfinder::maxIterReached = false;
@@ -89,45 +353,33 @@ void Pathfinder::initializeGraph(int maxcol, int maxrow) {
 // Pathfinder::addFlow
 // add a flow from src to dst
 // can have an arbitrary number of dst locations due to fanout
+// the priority of a flow with fanout is the highest of its destinations
 void Pathfinder::addFlow(Coord srcCoords, Port srcPort, Coord dstCoords,
-                         Port dstPort) {
+                         Port dstPort, int priority) {
+  Switchbox *dstSB = getSwitchbox(dstCoords);
+
   // check if a flow with this source already exists
   for (unsigned int i = 0; i < flows.size(); i++) {
     Switchbox *otherSrc = flows[i].first.first;
     Port otherPort = flows[i].first.second;
     if (otherSrc->col == srcCoords.first && otherSrc->row == srcCoords.second &&
         otherPort == srcPort) {
-      // find the vertex corresponding to the destination
-      PathEndPoint dst;
-      auto vpair = vertices(graph);
-      for (vertex_iterator v = vpair.first; v != vpair.second; v++) {
-        Switchbox *sb = &graph[*v];
-        if (sb->col == dstCoords.first && sb->row == dstCoords.second) {
-          dst = std::make_pair(sb, dstPort);
-          break;
-        }
-      }
       // add the destination to this existing flow, and finish
-      flows[i].second.push_back(dst);
+      flows[i].second.push_back(std::make_pair(dstSB, dstPort));
+      flowPriorities[i] = std::max(flowPriorities[i], priority);
       return;
     }
   }
 
   // if no existing flow was found with this source, create a new flow
   Flow flow;
-  auto vpair = vertices(graph);
-  for (vertex_iterator v = vpair.first; v != vpair.second; v++) {
-    Switchbox *sb = &graph[*v];
-    // check if this vertex matches the source
-    if (sb->col == srcCoords.first && sb->row == srcCoords.second)
-      flow.first = std::make_pair(sb, srcPort);
-
-    // check if this vertex matches the destination
-    if (sb->col == dstCoords.first && sb->row == dstCoords.second)
-      flow.second.push_back(std::make_pair(sb, dstPort));
-  }
+  if (Switchbox *srcSB = getSwitchbox(srcCoords))
+    flow.first = std::make_pair(srcSB, srcPort);
+  if (dstSB)
+    flow.second.push_back(std::make_pair(dstSB, dstPort));
 
   flows.push_back(flow);
+  flowPriorities.push_back(priority);
   return;
 }
 
@@ -136,23 +388,132 @@ void Pathfinder::addFlow(Coord srcCoords, Port srcPort, Coord dstCoords,
 // Pathfinder algorithm will avoid using these
 void Pathfinder::addFixedConnection(Coord coords, Port port) {
   // find the correct Channel and indicate the fixed direction
-  auto edge_pair = edges(graph);
-  for (edge_iterator e = edge_pair.first; e != edge_pair.second; e++) {
-    if (graph[source(*e, graph)].col == coords.first &&
-        graph[source(*e, graph)].row == coords.second &&
-        graph[*e].bundle == port.first) {
-      graph[*e].fixed_capacity.insert(port.second);
-      break;
+  int v = graph.vertexIndex(coords.first, coords.second);
+  if (v < 0)
+    return;
+  int e = graph.edgeIndex(v, port.first);
+  if (e != SwitchboxGraph::NO_EDGE)
+    graph.edge(e).fixed_capacity.insert(port.second);
+}
+
+// Pathfinder::commitPath
+// Assign a channel index in each Channel of the path, in the order the path
+// was traced from its destination, and record the resulting connections in
+// the switch settings of the flow.
+void Pathfinder::commitPath(const ChannelPath &path, SwitchSettings &settings) {
+  for (unsigned e : path) {
+    Channel *ch = &graph.edge(e);
+
+    // don't use fixed channels
+    while (ch->fixed_capacity.count(ch->used_capacity))
+      ch->used_capacity++;
+
+    // add the entrance port for this Switchbox
+    settings[&graph.vertex(ch->target)].first =
+        std::make_pair(getConnectingBundle(ch->bundle), ch->used_capacity);
+    // add the current Switchbox to the map of the predecessor
+    settings[&graph.vertex(ch->src)].second.insert(
+        std::make_pair(ch->bundle, ch->used_capacity));
+
+    ch->used_capacity++;
+    // if at capacity, bump demand to discourage using this Channel
+    if (ch->used_capacity >= ch->max_capacity) {
+      // this means the order matters!
+      ch->demand *= 1.1;
     }
   }
 }
 
+// Pathfinder::findRoute
+// Find the shortest path from the source of a flow to each of its
+// destinations, given the current demand, and record them in the route of the
+// flow without using any Channel yet.
+void Pathfinder::findRoute(unsigned flowIndex, SearchState &state) {
+  const Flow &flow = flows[flowIndex];
+  std::vector<ChannelPath> &route = routes[flowIndex];
+  route.assign(flow.second.size(), ChannelPath());
+
+  state.processed.assign(graph.numVertices(), false);
+  unsigned src = vertexOf(flow.first.first);
+
+  std::vector<unsigned> dsts;
+  for (const PathEndPoint &dst : flow.second)
+    dsts.push_back(vertexOf(dst.first));
+
+  // use dijkstra to find path given current demand
+  // from the start switchbox, find shortest path to each destination
+  // output is in the predecessor map, which must then be processed to get
+  // the path to each destination
+  // with A*, each destination is searched for separately below
+  if (!options.useAStar)
+    graph.shortestPaths(state, src, dsts, -1, flowPriorities[flowIndex]);
+
+  // trace the path of the flow backwards via predecessors
+  state.processed[src] = true;
+  for (unsigned int i = 0; i < flow.second.size(); i++) {
+    unsigned curr = dsts[i];
+    if (options.useAStar)
+      graph.shortestPaths(state, src, {curr}, curr,
+                          flowPriorities[flowIndex]);
+
+    // trace backwards until a vertex already processed is reached
+    while (state.processed[curr] == false) {
+      // the channel used in the path joins the pred to curr
+      unsigned pred = state.pred[curr];
+      int e = graph.edgeBetween(pred, curr);
+      assert(e != SwitchboxGraph::NO_EDGE);
+      route[i].push_back(e);
+      state.processed[curr] = true;
+      curr = pred;
+    }
+  }
+}
+
+// Pathfinder::commitFlow
+// Use the Channels on the current route of a flow and record its switch
+// settings.
+void Pathfinder::commitFlow(unsigned flowIndex, SwitchSettings &settings) {
+  const Flow &flow = flows[flowIndex];
+  // set the input bundle for the source endpoint
+  settings[flow.first.first].first = flow.first.second;
+  for (unsigned int i = 0; i < flow.second.size(); i++) {
+    // set the output bundle for this destination endpoint
+    settings[flow.second[i].first].second.insert(flow.second[i].second);
+    // increment used_capacity for the associated channels
+    commitPath(routes[flowIndex][i], settings);
+  }
+}
+
+// return true if the current route of the flow uses a Channel that is over
+// capacity
+bool Pathfinder::usesOverusedChannel(unsigned flowIndex) {
+  for (const ChannelPath &path : routes[flowIndex])
+    for (unsigned e : path)
+      if (graph.edge(e).used_capacity > graph.edge(e).max_capacity)
+        return true;
+  return false;
+}
+
+// return true if the current route of the flow uses a Channel that is at or
+// over capacity
+bool Pathfinder::usesFullChannel(unsigned flowIndex) {
+  for (const ChannelPath &path : routes[flowIndex])
+    for (unsigned e : path)
+      if (graph.edge(e).used_capacity >= graph.edge(e).max_capacity)
+        return true;
+  return false;
+}
+
 // Pathfinder::findPaths
 // Primary function for the class
 // Perform congestion-aware routing for all flows which have been added.
-// Use Dijkstra's shortest path to find routes, and use "demand" as the weights
-// if the routing finds too much congestion, update the demand weights
+// Use Dijkstra's shortest path (or A*) to find routes, and use "demand" as the
+// weights. If the routing finds too much congestion, update the demand weights
 // and repeat the process until a vaild solution is found
+// In incremental mode, only the flows using a Channel that is over capacity
+// are ripped up and rerouted in each iteration after the first one.
+// Flows are routed in order of decreasing priority, so that high priority
+// flows get the short paths before the Channels along them fill up.
 //
 // returns a map specifying switchbox settings for all flows
 // if no legal routing can be found after MAX_ITERATIONS, returns empty vector
@@ -161,12 +522,22 @@ Pathfinder::findPaths(const int MAX_ITERATIONS) {
   LLVM_DEBUG(llvm::dbgs() << "Begin Pathfinder::findPaths\n");
   int iteration_count = 0;
   std::map<PathEndPoint, SwitchSettings> routing_solution;
+  routes.assign(flows.size(), {});
+  iterationStats.clear();
+  searchStates.resize(std::max(1u, options.numThreads));
+
+  // the order in which flows are routed in each iteration
+  std::vector<unsigned> routingOrder(flows.size());
+  for (unsigned f = 0; f < flows.size(); f++)
+    routingOrder[f] = f;
+  std::stable_sort(routingOrder.begin(), routingOrder.end(),
+                   [&](unsigned a, unsigned b) {
+                     return flowPriorities[a] > flowPriorities[b];
+                   });
 
   // initialize all Channel histories to 0
-  auto edge_pair = edges(graph);
-  for (auto edge = edge_pair.first; edge != edge_pair.second; edge++) {
-    graph[*edge].over_capacity_count = 0;
-  }
+  for (Channel &ch : graph.getEdges())
+    ch.over_capacity_count = 0;
 
 // Pathfinder iteration loop
 #define over_capacity_coeff 0.02
@@ -175,20 +546,13 @@ Pathfinder::findPaths(const int MAX_ITERATIONS) {
     LLVM_DEBUG(llvm::dbgs()
                << "Begin findPaths iteration #" << iteration_count << "\n");
     // update demand on all channels
-    edge_pair = edges(graph);
-    for (edge_iterator it = edge_pair.first; it != edge_pair.second; it++) {
-      Channel *ch = &graph[*it];
-      // LLVM_DEBUG(llvm::dbgs() << "Pre update:\tEdge " << *it << "\t: used = "
-      // << ch->used_capacity <<
-      //   "\t demand = " << ch->demand << "\t over_capacity_count= " <<
-      //   ch->over_capacity_count<< "\t");
-      if (ch->fixed_capacity.size() >= ch->max_capacity) {
-        ch->demand = std::numeric_limits<float>::max();
+    for (Channel &ch : graph.getEdges()) {
+      if (ch.fixed_capacity.size() >= ch.max_capacity) {
+        ch.demand = std::numeric_limits<float>::max();
       } else {
-        float history = 1 + over_capacity_coeff * ch->over_capacity_count;
-        float congestion = 1 + used_capacity_coeff * ch->used_capacity;
-        // std::max(0, ch->used_capacity - ch->max_capacity);
-        ch->demand = history * congestion;
+        float history = 1 + over_capacity_coeff * ch.over_capacity_count;
+        float congestion = 1 + used_capacity_coeff * ch.used_capacity;
+        ch.demand = history * congestion;
       }
     }
     // if reach MAX_ITERATIONS, throw an error since no routing can be found
@@ -204,119 +568,340 @@ Pathfinder::findPaths(const int MAX_ITERATIONS) {
       return routing_solution;
     }
 
+    // choose the flows to reroute, before their usage is cleared below
+    std::vector<bool> reroute(flows.size(), true);
+    if (options.incremental && iteration_count > 1)
+      for (unsigned f = 0; f < flows.size(); f++)
+        reroute[f] = usesOverusedChannel(f);
+
     // "rip up" all routes, i.e. set used capacity in each Channel to 0
     routing_solution = {};
-    auto edge_pair = edges(graph);
-    for (edge_iterator e = edge_pair.first; e != edge_pair.second; e++) {
-      graph[*e].used_capacity = 0;
+    for (Channel &ch : graph.getEdges())
+      ch.used_capacity = 0;
+
+    // put back the routes that are kept, so that the rerouted flows see
+    // their usage
+    PathfinderIterationStats stats = {0, 0};
+    std::vector<unsigned> toRoute;
+    for (unsigned f : routingOrder) {
+      if (reroute[f])
+        toRoute.push_back(f);
+      else
+        commitFlow(f, routing_solution[flows[f].first]);
     }
 
     // for each flow, find the shortest path from source to destination
     // update used_capacity for the path between them
-    for (auto flow : flows) {
-      auto vpair = vertices(graph);
-
-      vertex_descriptor src;
-      for (vertex_iterator v = vpair.first; v != vpair.second; v++) {
-        Switchbox *sb = &graph[*v];
-        sb->processed = false;
-        if (sb->col == flow.first.first->col &&
-            sb->row == flow.first.first->row)
-          src = *v;
+    // In parallel, batches of flows are routed concurrently against the
+    // demand left by the previous batches, and then committed in order.
+    unsigned numThreads = std::max(1u, options.numThreads);
+    unsigned batchSize = numThreads > 1 ? numThreads * flowsPerThread : 1;
+    for (unsigned first = 0; first < toRoute.size(); first += batchSize) {
+      unsigned last = std::min<unsigned>(first + batchSize, toRoute.size());
+      if (numThreads > 1 && last - first > 1) {
+        mlir::parallelFor(options.context, 0, numThreads, [&](size_t thread) {
+          for (unsigned i = first + thread; i < last; i += numThreads)
+            findRoute(toRoute[i], searchStates[thread]);
+        });
+      } else {
+        for (unsigned i = first; i < last; i++)
+          findRoute(toRoute[i], searchStates[0]);
       }
-
-      // use dijkstra to find path given current demand
-      // from the start switchbox, find shortest path to each other switchbox
-      // output is in the predecessor map, which must then be processed to get
-      // individual switchbox settings
-      dijkstra_shortest_paths(
-          graph, src,
-          weight_map(get(&Channel::demand, graph))
-              .predecessor_map(get(&Switchbox::pred, graph)));
-
-      // trace the path of the flow backwards via predecessors
-      // increment used_capacity for the associated channels
-      SwitchSettings switchSettings = SwitchSettings();
-      // set the input bundle for the source endpoint
-      switchSettings[&graph[src]].first = flow.first.second;
-      graph[src].processed = true;
-      for (unsigned int i = 0; i < flow.second.size(); i++) {
-        vertex_descriptor curr;
-        for (vertex_iterator v = vpair.first; v != vpair.second; v++)
-          if (graph[*v].col == flow.second[i].first->col &&
-              graph[*v].row == flow.second[i].first->row)
-            curr = *v;
-        Switchbox *sb = &graph[curr];
-
-        // set the output bundle for this destination endpoint
-        switchSettings[sb].second.insert(flow.second[i].second);
-
-        // trace backwards until a vertex already processed is reached
-        while (sb->processed == false) {
-          // find the edge from the pred to curr by searching incident edges
-          auto inedges = in_edges(curr, graph);
-          Channel *ch = nullptr;
-          for (in_edge_iterator it = inedges.first; it != inedges.second;
-               it++) {
-            if (source(*it, graph) == (unsigned)sb->pred) {
-              // found the channel used in the path
-              ch = &graph[*it];
-              break;
-            }
-          }
-          assert(ch != nullptr);
-
-          // don't use fixed channels
-          while (ch->fixed_capacity.count(ch->used_capacity))
-            ch->used_capacity++;
-
-          // add the entrance port for this Switchbox
-          switchSettings[sb].first = std::make_pair(
-              getConnectingBundle(ch->bundle), ch->used_capacity);
-          // add the current Switchbox to the map of the predecessor
-          switchSettings[&graph[sb->pred]].second.insert(
-              std::make_pair(ch->bundle, ch->used_capacity));
-
-          ch->used_capacity++;
-          // if at capacity, bump demand to discourage using this Channel
-          if (ch->used_capacity >= ch->max_capacity) {
-            // this means the order matters!
-            ch->demand *= 1.1;
-          }
-
-          sb->processed = true;
-          curr = sb->pred;
-          sb = &graph[curr];
-        }
+      for (unsigned i = first; i < last; i++) {
+        // a flow routed concurrently with the flows committed before it is
+        // routed again if one of those filled a Channel it uses
+        if (i > first && usesFullChannel(toRoute[i]))
+          findRoute(toRoute[i], searchStates[0]);
+        SwitchSettings switchSettings = SwitchSettings();
+        commitFlow(toRoute[i], switchSettings);
+        // add this flow to the proposed solution
+        routing_solution[flows[toRoute[i]].first] = switchSettings;
+        stats.flowsRouted++;
       }
-      // add this flow to the proposed solution
-      routing_solution[flow.first] = switchSettings;
     }
+
+    for (Channel &ch : graph.getEdges())
+      if (ch.used_capacity > ch.max_capacity)
+        stats.overusedEdges++;
+    iterationStats.push_back(stats);
+    LLVM_DEBUG(llvm::dbgs() << "findPaths iteration #" << iteration_count
+                            << ": rerouted " << stats.flowsRouted
+                            << " flows, " << stats.overusedEdges
+                            << " channels over capacity\n");
   } while (!isLegal()); // continue iterations until a legal routing is found
   return routing_solution;
 }
 
 // check that every channel does not exceed max capacity
 bool Pathfinder::isLegal() {
-  auto edge_pair = edges(graph);
   bool legal = true; // assume legal until found otherwise
   // check if maximum number of iterations has been reached
   if (maxIterReached)
     legal = false;
-  for (edge_iterator e = edge_pair.first; e != edge_pair.second; e++) {
-    if (graph[*e].used_capacity > graph[*e].max_capacity) {
+  for (Channel &ch : graph.getEdges()) {
+    if (ch.used_capacity > ch.max_capacity) {
+      LLVM_DEBUG(llvm::dbgs()
+                 << "Too much capacity on Edge (" << graph.vertex(ch.src).col
+                 << ", " << graph.vertex(ch.src).row << ") -> "
+                 << stringifyWireBundle(ch.bundle)
+                 << "\t: used_capacity = " << ch.used_capacity
+                 << "\t: Demand = " << ch.demand << "\n");
+      ch.over_capacity_count++;
+      LLVM_DEBUG(llvm::dbgs()
+                 << "over_capacity_count = " << ch.over_capacity_count << "\n");
+      legal = false;
+    }
+  }
+  return legal;
+}
+
+#define packet_load_coeff 0.1
+
+PacketPathfinder::PacketPathfinder(int maxcol, int maxrow,
+                                   const AIETargetModel *targetModel) {
+  graph.initialize(maxcol, maxrow, targetModel);
+}
+
+// PacketPathfinder::addFlow
+// add a destination to the packet flow with the given source port and ID,
+// creating the flow if needed
+void PacketPathfinder::addFlow(Coord srcCoords, Port srcPort, int id,
+                               Coord dstCoords, Port dstPort) {
+  int src = graph.vertexIndex(srcCoords.first, srcCoords.second);
+  int dst = graph.vertexIndex(dstCoords.first, dstCoords.second);
+  if (src < 0 || dst < 0)
+    return;
+  PathEndPoint source = std::make_pair(&graph.vertex(src), srcPort);
+  PathEndPoint dest = std::make_pair(&graph.vertex(dst), dstPort);
+
+  for (PacketFlow &flow : flows) {
+    if (flow.source == source && flow.id == id) {
+      if (std::find(flow.dests.begin(), flow.dests.end(), dest) ==
+          flow.dests.end())
+        flow.dests.push_back(dest);
+      return;
+    }
+  }
+  flows.push_back({source, id, {dest}});
+}
+
+void PacketPathfinder::addFixedConnection(Coord coords, Port port) {
+  int v = graph.vertexIndex(coords.first, coords.second);
+  if (v < 0)
+    return;
+  int e = graph.edgeIndex(v, port.first);
+  if (e != SwitchboxGraph::NO_EDGE)
+    graph.edge(e).fixed_capacity.insert(port.second);
+}
+
+// number of ports of the Channel not used by circuit-switched connections
+unsigned PacketPathfinder::availablePorts(const Channel &ch) const {
+  unsigned ports = 0;
+  for (unsigned p = 0; p < ch.max_capacity; p++)
+    if (!ch.fixed_capacity.count(p))
+      ports++;
+  return ports;
+}
+
+void PacketPathfinder::updateDemand(unsigned e) {
+  Channel &ch = graph.edge(e);
+  unsigned ports = availablePorts(ch);
+  if (ports == 0) {
+    ch.demand = std::numeric_limits<float>::max();
+    return;
+  }
+  // sharing a port costs a fraction of a hop per flow, so that flows only
+  // detour around heavily shared ports
+  float history = 1 + over_capacity_coeff * ch.over_capacity_count;
+  float congestion = 1 + packet_load_coeff * channelLoad[e] / ports +
+                     (float)switchboxLoad[ch.src] / numAMSels;
+  ch.demand = history * congestion;
+}
+
+// PacketPathfinder::findRoute
+// Find the shortest route from the source of a flow to all its destinations,
+// given the current demand. Returns false if a destination is unreachable.
+bool PacketPathfinder::findRoute(unsigned flowIndex) {
+  const PacketFlow &flow = flows[flowIndex];
+  std::vector<ChannelPath> &route = routes[flowIndex];
+  route.assign(flow.dests.size(), ChannelPath());
+
+  unsigned src = vertexOf(flow.source.first);
+  std::vector<unsigned> dsts;
+  for (const PathEndPoint &dst : flow.dests)
+    dsts.push_back(vertexOf(dst.first));
+  graph.shortestPaths(state, src, dsts, -1, 0);
+
+  state.processed.assign(graph.numVertices(), false);
+  state.processed[src] = true;
+  for (unsigned i = 0; i < dsts.size(); i++) {
+    unsigned curr = dsts[i];
+    if (state.distance[curr] == std::numeric_limits<float>::max())
+      return false;
+    while (!state.processed[curr]) {
+      unsigned pred = state.pred[curr];
+      int e = graph.edgeBetween(pred, curr);
+      assert(e != SwitchboxGraph::NO_EDGE);
+      route[i].push_back(e);
+      state.processed[curr] = true;
+      curr = pred;
+    }
+  }
+  return true;
+}
+
+// add the load of the route of a flow, and update the demand of the Channels
+// whose cost it changes
+void PacketPathfinder::commitFlow(unsigned flowIndex) {
+  for (const ChannelPath &path : routes[flowIndex]) {
+    for (unsigned e : path) {
+      Channel &ch = graph.edge(e);
+      channelLoad[e]++;
+      switchboxLoad[ch.src]++;
+      const unsigned *end = graph.outEdgesEnd(ch.src);
+      for (const unsigned *out = graph.outEdgesBegin(ch.src); out != end; out++)
+        updateDemand(*out);
+    }
+  }
+}
+
+// PacketPathfinder::checkSwitchboxes
+// Check the packet switching resources of each Switchbox for the current
+// routes. The flows that enter a slave port and leave through the same master
+// ports share a slot of the slave port, and the flows that leave through the
+// same master ports share an arbiter and msel. The Channels through which the
+// flows of an oversubscribed slave port or Switchbox arrive, or through which
+// they leave if they start there, become more expensive. Returns false if any
+// resource is oversubscribed.
+bool PacketPathfinder::checkSwitchboxes() {
+  // the master ports of the flow with each ID at each slave port
+  std::map<Coord, std::map<std::pair<Port, int>, std::set<Port>>> masters;
+  for (auto &[coord, connects] : getConnections())
+    for (auto &[connect, id] : connects)
+      masters[coord][std::make_pair(connect.first, id)].insert(connect.second);
+
+  auto penalize = [&](unsigned v, Port slave) {
+    bool arrives = false;
+    for (Channel &ch : graph.getEdges())
+      if (ch.target == v && getConnectingBundle(ch.bundle) == slave.first) {
+        ch.over_capacity_count++;
+        arrives = true;
+      }
+    if (!arrives) {
+      const unsigned *end = graph.outEdgesEnd(v);
+      for (const unsigned *out = graph.outEdgesBegin(v); out != end; out++)
+        graph.edge(*out).over_capacity_count++;
+    }
+  };
+
+  bool legal = true;
+  for (auto &[coord, slaves] : masters) {
+    std::set<std::set<Port>> amsels;
+    std::map<Port, std::set<std::set<Port>>> slots;
+    for (auto &[slave, dests] : slaves) {
+      amsels.insert(dests);
+      slots[slave.first].insert(dests);
+    }
+    unsigned v = graph.vertexIndex(coord.first, coord.second);
+    for (auto &[port, groups] : slots) {
+      if (amsels.size() <= numAMSels && groups.size() <= numSlotsPerPort)
+        continue;
       LLVM_DEBUG(llvm::dbgs()
-                 << "Too much capacity on Edge ("
-                 << graph[source(*e, graph)].col << ", "
-                 << graph[source(*e, graph)].row << ") -> "
-                 << stringifyWireBundle(graph[*e].bundle)
-                 << "\t: used_capacity = " << graph[*e].used_capacity
-                 << "\t: Demand = " << graph[*e].demand << "\n");
-      graph[*e].over_capacity_count++;
-      LLVM_DEBUG(llvm::dbgs() << "over_capacity_count = "
-                              << graph[*e].over_capacity_count << "\n");
+                 << "Too many packet flows at (" << coord.first << ", "
+                 << coord.second << ") " << stringifyWireBundle(port.first)
+                 << " " << port.second << "\t: slots = " << groups.size()
+                 << "\t: amsels = " << amsels.size() << "\n");
+      penalize(v, port);
       legal = false;
     }
   }
   return legal;
 }
+
+// PacketPathfinder::findPaths
+// Route all packet flows against the load of the flows routed before them,
+// then rip up and reroute all of them with the history of overloaded
+// Channels and Switchboxes until all of them are within capacity.
+bool PacketPathfinder::findPaths(const int MAX_ITERATIONS) {
+  LLVM_DEBUG(llvm::dbgs() << "Begin PacketPathfinder::findPaths\n");
+  routes.assign(flows.size(), {});
+  for (Channel &ch : graph.getEdges())
+    ch.over_capacity_count = 0;
+
+  for (int iteration = 1; iteration <= MAX_ITERATIONS; iteration++) {
+    channelLoad.assign(graph.numEdges(), 0);
+    switchboxLoad.assign(graph.numVertices(), 0);
+    for (unsigned e = 0; e < graph.numEdges(); e++)
+      updateDemand(e);
+
+    for (unsigned f = 0; f < flows.size(); f++) {
+      if (!findRoute(f))
+        return false;
+      commitFlow(f);
+    }
+
+    bool legal = true;
+    for (unsigned e = 0; e < graph.numEdges(); e++) {
+      Channel &ch = graph.edge(e);
+      if (channelLoad[e] > availablePorts(ch) * maxIDsPerPort) {
+        ch.over_capacity_count++;
+        legal = false;
+      }
+    }
+    if (!checkSwitchboxes())
+      legal = false;
+    LLVM_DEBUG(llvm::dbgs() << "PacketPathfinder iteration #" << iteration
+                            << (legal ? ": legal" : ": over capacity")
+                            << "\n");
+    if (legal)
+      return true;
+  }
+  return false;
+}
+
+// PacketPathfinder::getConnections
+// Assign a port to each flow on each Channel of its route, preferring the
+// port carrying the fewest flows so far, and collect the resulting
+// connections of each Switchbox.
+std::map<Coord, std::vector<std::pair<Connect, int>>>
+PacketPathfinder::getConnections() {
+  std::map<Coord, std::vector<std::pair<Connect, int>>> connections;
+  std::vector<std::vector<unsigned>> portLoad(graph.numEdges());
+  for (unsigned e = 0; e < graph.numEdges(); e++)
+    portLoad[e].assign(graph.edge(e).max_capacity, 0);
+
+  for (unsigned f = 0; f < flows.size(); f++) {
+    const PacketFlow &flow = flows[f];
+    // the port at which the flow enters each Switchbox on its route
+    std::map<unsigned, Port> inPort;
+    inPort[vertexOf(flow.source.first)] = flow.source.second;
+
+    for (unsigned i = 0; i < flow.dests.size(); i++) {
+      // paths are traced from the destination, so walk them backwards
+      const ChannelPath &path = routes[f][i];
+      for (auto e = path.rbegin(); e != path.rend(); e++) {
+        Channel &ch = graph.edge(*e);
+        int port = -1;
+        for (unsigned p = 0; p < ch.max_capacity; p++)
+          if (!ch.fixed_capacity.count(p) &&
+              (port < 0 || portLoad[*e][p] < portLoad[*e][port]))
+            port = p;
+        assert(port >= 0 && "packet flow routed through a full Channel");
+        portLoad[*e][port]++;
+
+        Switchbox &sb = graph.vertex(ch.src);
+        connections[std::make_pair(sb.col, sb.row)].push_back(std::make_pair(
+            std::make_pair(inPort[ch.src], std::make_pair(ch.bundle, port)),
+            flow.id));
+        inPort[ch.target] =
+            std::make_pair(getConnectingBundle(ch.bundle), port);
+      }
+
+      Switchbox *dst = flow.dests[i].first;
+      connections[std::make_pair(dst->col, dst->row)].push_back(std::make_pair(
+          std::make_pair(inPort[vertexOf(dst)], flow.dests[i].second),
+          flow.id));
+    }
+  }
+  return connections;
+}
@@ -67,8 +67,11 @@ struct AIEBroadcastPacketPass
                   dyn_cast<TileOp>(bpdest.getTile().getDefiningOp());
               Port destPort = bpdest.port();
               builder.setInsertionPointToEnd(b_pkFlow);
-              builder.create<PacketDestOp>(builder.getUnknownLoc(), destTile,
-                                           destPort.first, destPort.second);
+              auto pktDest = builder.create<PacketDestOp>(
+                  builder.getUnknownLoc(), destTile, destPort.first,
+                  destPort.second);
+              if (bpdest->hasAttr("drop_header"))
+                pktDest->setAttr("drop_header", builder.getUnitAttr());
             }
           }
           builder.setInsertionPointToEnd(b_pkFlow);
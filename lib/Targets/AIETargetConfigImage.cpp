@@ -0,0 +1,457 @@
+//===- AIETargetConfigImage.cpp ---------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+/*
+ * Serialises the configuration that aie-generate-xaie emits as libxaie calls
+ * (core resets and ELF loading, tile, mem tile and shim DMAs, lock values,
+ * switchboxes and shim muxes) into a binary image, which the generic loader
+ * of runtime_lib/test_lib/config_image.h applies at runtime. The layout of the
+ * image is described in config_image_format.h. With asText, the records are
+ * printed one per line instead.
+ */
+
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/BuiltinOps.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/EndianStream.h"
+
+#include "aie/Dialect/AIE/IR/AIEDialect.h"
+
+#include "AIETargets.h"
+#include "config_image_format.h"
+
+using namespace mlir;
+using namespace xilinx;
+using namespace xilinx::AIE;
+
+namespace xilinx {
+namespace AIE {
+
+namespace {
+// The records of an image, in the order they are applied.
+struct ConfigImage {
+  struct Record {
+    aie_config_section section;
+    aie_config_record type;
+    SmallVector<uint32_t, 16> payload;
+    std::string name; // file name of AIE_CONFIG_LOAD_ELF
+  };
+  std::vector<Record> records;
+  std::vector<std::string> externalBuffers;
+
+  Record &add(aie_config_section section, aie_config_record type,
+              ArrayRef<int64_t> payload) {
+    Record &record = records.emplace_back();
+    record.section = section;
+    record.type = type;
+    for (int64_t value : payload)
+      record.payload.push_back(static_cast<uint32_t>(value));
+    return record;
+  }
+};
+} // namespace
+
+// Append a string as its length in bytes and its characters padded to words.
+static void appendString(SmallVectorImpl<uint32_t> &words, StringRef str) {
+  words.push_back(str.size());
+  for (size_t i = 0; i < str.size(); i += 4) {
+    uint32_t word = 0;
+    for (size_t j = 0; j < 4 && i + j < str.size(); j++)
+      word |= static_cast<uint32_t>(static_cast<uint8_t>(str[i + j]))
+              << (8 * j);
+    words.push_back(word);
+  }
+}
+
+static StringRef stringifySection(aie_config_section section) {
+  switch (section) {
+  case AIE_CONFIG_CORES:
+    return "cores";
+  case AIE_CONFIG_START_CORES:
+    return "start_cores";
+  case AIE_CONFIG_DMAS:
+    return "dmas";
+  case AIE_CONFIG_SHIM_DMAS:
+    return "shim_dmas";
+  case AIE_CONFIG_LOCKS:
+    return "locks";
+  case AIE_CONFIG_SWITCHBOXES:
+    return "switchboxes";
+  }
+  llvm_unreachable("unknown section");
+}
+
+static StringRef stringifyRecord(aie_config_record type) {
+  switch (type) {
+  case AIE_CONFIG_CORE_RESET:
+    return "core_reset";
+  case AIE_CONFIG_LOAD_ELF:
+    return "load_elf";
+  case AIE_CONFIG_CORE_ENABLE:
+    return "core_enable";
+  case AIE_CONFIG_BD:
+    return "bd";
+  case AIE_CONFIG_DMA_START:
+    return "dma_start";
+  case AIE_CONFIG_LOCK_INIT:
+    return "lock_init";
+  case AIE_CONFIG_CONNECT:
+    return "connect";
+  case AIE_CONFIG_PACKET_MASTER:
+    return "packet_master";
+  case AIE_CONFIG_PACKET_SLAVE:
+    return "packet_slave";
+  case AIE_CONFIG_SHIM_MUX:
+    return "shim_mux";
+  }
+  llvm_unreachable("unknown record");
+}
+
+// Return the stream switch port type of a bundle, or -1 if libxaie has none.
+static int getPortType(WireBundle bundle) {
+  switch (bundle) {
+  case WireBundle::Core:
+    return AIE_CONFIG_PORT_CORE;
+  case WireBundle::DMA:
+    return AIE_CONFIG_PORT_DMA;
+  case WireBundle::FIFO:
+    return AIE_CONFIG_PORT_FIFO;
+  case WireBundle::South:
+    return AIE_CONFIG_PORT_SOUTH;
+  case WireBundle::West:
+    return AIE_CONFIG_PORT_WEST;
+  case WireBundle::North:
+    return AIE_CONFIG_PORT_NORTH;
+  case WireBundle::East:
+    return AIE_CONFIG_PORT_EAST;
+  case WireBundle::Trace:
+    return AIE_CONFIG_PORT_TRACE;
+  default:
+    return -1;
+  }
+}
+
+// Add the BDs and channels of a tile, mem tile or shim DMA, with the same
+// settings as generateDMAConfig in AIETargetXAIEV2.cpp.
+template <typename OpType>
+static LogicalResult addDMAConfig(ConfigImage &image, OpType memOp,
+                                  const AIETargetModel &targetModel,
+                                  aie_config_section section,
+                                  DenseMap<Operation *, int> &externalIDs) {
+  int col = memOp.colIndex();
+  int row = memOp.rowIndex();
+  bool isMemTile = targetModel.isMemTile(col, row);
+  bool isShimNOC = targetModel.isShimNOCTile(col, row);
+  DenseMap<Block *, int> bdNumbers = getBDNumbers(memOp.getBody(), isMemTile);
+
+  for (auto &block : memOp.getBody()) {
+    if (!bdNumbers.count(&block))
+      continue;
+    int flags = 0;
+    int64_t address = 0, length = 0;
+    int externalID = 0;
+    SmallVector<int64_t, 8> dims;
+    for (auto op : block.template getOps<DMABDOp>()) {
+      // The records have a single buffer, without the B buffer and A/B mode
+      // of AIE1 tile DMAs.
+      if (!op.isA() && !isShimNOC)
+        return op.emitOpError("B buffers cannot be used in a configuration "
+                              "image");
+      ShapedType bufferType =
+          op.getBuffer().getType().template cast<MemRefType>();
+      int bytes = bufferType.getElementTypeBitWidth() / 8;
+      length = op.getLenValue() * bytes;
+      address = op.getOffsetValue() * bytes;
+      if (isShimNOC) {
+        auto buffer = op.getBuffer().template getDefiningOp<ExternalBufferOp>();
+        if (!buffer || !externalIDs.count(buffer))
+          return op.emitOpError("shim DMAs in a configuration image must "
+                                "transfer named external buffers");
+        flags |= AIE_CONFIG_BD_EXTERNAL;
+        externalID = externalIDs[buffer];
+      } else {
+        address += op.getBufferOp().address();
+        int bufferCol = op.getBufferOp().getTileOp().colIndex();
+        int bufferRow = op.getBufferOp().getTileOp().rowIndex();
+        // Memtile DMAs can access neighboring tiles.
+        if (isMemTile) {
+          if (targetModel.isInternal(col, row, bufferCol, bufferRow))
+            address += targetModel.getMemTileSize() * 1;
+          else if (targetModel.isEast(col, row, bufferCol, bufferRow))
+            address += targetModel.getMemTileSize() * 2;
+        }
+      }
+      if (auto opDims = op.getDimensions()) {
+        if (targetModel.getTargetArch() != AIEArch::AIE2)
+          return memOp.emitOpError(
+              "DMA contains at least one multi-dimensional buffer "
+              "descriptor. This is currently only supported for AIE-ML "
+              "devices.");
+        // libxaie takes the innermost dimension first
+        for (auto dim : llvm::reverse(*opDims)) {
+          dims.push_back(dim.getStepsize());
+          dims.push_back(dim.getWrap());
+        }
+      }
+    }
+
+    int acqLockID = 0, acqValue = 0, relLockID = 0, relValue = 0;
+    for (auto op : block.template getOps<UseLockOp>()) {
+      LockOp lock = dyn_cast<LockOp>(op.getLock().getDefiningOp());
+      int lockCol = lock.colIndex();
+      int lockRow = lock.rowIndex();
+      int lockID = lock.getLockIDValue();
+      // Memtile DMAs can access neighboring tiles.
+      if (isMemTile) {
+        if (targetModel.isInternal(col, row, lockCol, lockRow))
+          lockID += targetModel.getNumLocks(lockCol, lockRow) * 1;
+        else if (targetModel.isEast(col, row, lockCol, lockRow))
+          lockID += targetModel.getNumLocks(lockCol, lockRow) * 2;
+      }
+      if (op.acquire() || op.acquire_ge()) {
+        flags |= AIE_CONFIG_BD_ACQUIRE;
+        acqLockID = lockID;
+        acqValue = op.getLockValue();
+        if (op.acquire_ge())
+          acqValue = -acqValue;
+      } else if (op.release()) {
+        flags |= AIE_CONFIG_BD_RELEASE;
+        relLockID = lockID;
+        relValue = op.getLockValue();
+      } else {
+        return op.emitOpError("unsupported lock action");
+      }
+    }
+
+    int packetID = 0, packetType = 0;
+    for (auto op : block.template getOps<DMABDPACKETOp>()) {
+      flags |= AIE_CONFIG_BD_PACKET;
+      packetID = op.getPacketID();
+      packetType = op.getPacketType();
+    }
+
+    int nextBd = 0;
+    if (block.getNumSuccessors() > 0) {
+      Block *nextBlock = block.getSuccessors()[0];
+      flags |= AIE_CONFIG_BD_NEXT;
+      if (nextBlock->getOps<EndOp>().empty())
+        flags |= AIE_CONFIG_BD_ENABLE_NEXT;
+      nextBd = bdNumbers.lookup(nextBlock);
+    }
+
+    SmallVector<int64_t, 24> payload = {
+        col,      row,     bdNumbers[&block], flags,     acqLockID,
+        acqValue, relLockID, relValue,        address,   length,
+        nextBd,   packetID,  packetType,      externalID,
+        static_cast<int64_t>(dims.size() / 2)};
+    payload.append(dims.begin(), dims.end());
+    image.add(section, AIE_CONFIG_BD, payload);
+  }
+
+  for (auto &block : memOp.getBody())
+    for (auto op : block.template getOps<DMAStartOp>())
+      image.add(section, AIE_CONFIG_DMA_START,
+                {col, row, op.getChannelIndex(),
+                 op.getChannelDir() == DMAChannelDir::MM2S ? 1 : 0,
+                 bdNumbers.lookup(op.getDest())});
+  return success();
+}
+
+mlir::LogicalResult AIETranslateToConfigImage(ModuleOp module,
+                                              raw_ostream &output,
+                                              bool asText) {
+  if (module.getOps<DeviceOp>().empty())
+    return module.emitOpError("expected AIE.device operation at toplevel");
+  DeviceOp targetOp = *(module.getOps<DeviceOp>().begin());
+  const auto &targetModel = targetOp.getTargetModel();
+  ConfigImage image;
+
+  DenseMap<Operation *, int> externalIDs;
+  for (auto op : targetOp.getOps<ExternalBufferOp>()) {
+    if (!op.hasName())
+      continue;
+    externalIDs[op] = image.externalBuffers.size();
+    image.externalBuffers.push_back(op.name().getValue().str());
+  }
+
+  // Reset each core and load its ELF file.
+  for (auto tileOp : targetOp.getOps<TileOp>()) {
+    int col = tileOp.colIndex();
+    int row = tileOp.rowIndex();
+    if (tileOp.isShimTile() || tileOp.isMemTile())
+      continue;
+    image.add(AIE_CONFIG_CORES, AIE_CONFIG_CORE_RESET,
+              {col, row, targetModel.getNumLocks(col, row)});
+    if (auto coreOp = tileOp.getCoreOp()) {
+      std::string fileName;
+      if (auto fileAttr = coreOp->getAttrOfType<StringAttr>("elf_file"))
+        fileName = std::string(fileAttr.getValue());
+      else
+        fileName = std::string("core_") + std::to_string(col) + "_" +
+                   std::to_string(row) + ".elf";
+      auto &record = image.add(AIE_CONFIG_CORES, AIE_CONFIG_LOAD_ELF,
+                               {col, row});
+      appendString(record.payload, fileName);
+      record.name = fileName;
+    }
+  }
+
+  for (auto tileOp : targetOp.getOps<TileOp>())
+    if (!tileOp.isShimTile() && !tileOp.isMemTile())
+      image.add(AIE_CONFIG_START_CORES, AIE_CONFIG_CORE_ENABLE,
+                {tileOp.colIndex(), tileOp.rowIndex()});
+
+  for (auto memOp : targetOp.getOps<MemOp>())
+    if (failed(addDMAConfig(image, memOp, targetModel, AIE_CONFIG_DMAS,
+                            externalIDs)))
+      return failure();
+  for (auto memOp : targetOp.getOps<MemTileDMAOp>())
+    if (failed(addDMAConfig(image, memOp, targetModel, AIE_CONFIG_DMAS,
+                            externalIDs)))
+      return failure();
+  for (auto memOp : targetOp.getOps<ShimDMAOp>())
+    if (failed(addDMAConfig(image, memOp, targetModel, AIE_CONFIG_SHIM_DMAS,
+                            externalIDs)))
+      return failure();
+
+  for (auto lock : targetOp.getOps<LockOp>())
+    if (auto init = lock.getInit())
+      image.add(AIE_CONFIG_LOCKS, AIE_CONFIG_LOCK_INIT,
+                {lock.colIndex(), lock.rowIndex(), lock.getLockIDValue(),
+                 *init});
+
+  auto addConnects = [&](Block &b, int col, int row) -> LogicalResult {
+    for (auto connectOp : b.getOps<ConnectOp>()) {
+      int source = getPortType(connectOp.getSourceBundle());
+      int dest = getPortType(connectOp.getDestBundle());
+      if (source < 0 || dest < 0)
+        return connectOp.emitOpError(
+            "bundle cannot be configured by a configuration image");
+      image.add(AIE_CONFIG_SWITCHBOXES, AIE_CONFIG_CONNECT,
+                {col, row, source, connectOp.sourceIndex(), dest,
+                 connectOp.destIndex()});
+    }
+    return success();
+  };
+
+  for (auto switchboxOp : targetOp.getOps<SwitchboxOp>()) {
+    if (!isa<TileOp>(switchboxOp.getTile().getDefiningOp()))
+      return switchboxOp.emitOpError("parameterized switchboxes cannot be "
+                                     "configured by a configuration image");
+    int col = switchboxOp.colIndex();
+    int row = switchboxOp.rowIndex();
+    Block &b = switchboxOp.getConnections().front();
+    if (failed(addConnects(b, col, row)))
+      return failure();
+
+    for (auto connectOp : b.getOps<MasterSetOp>()) {
+      int mask = 0;
+      int arbiter = -1;
+      for (auto val : connectOp.getAmsels()) {
+        AMSelOp amsel = dyn_cast<AMSelOp>(val.getDefiningOp());
+        arbiter = amsel.arbiterIndex();
+        mask |= (1 << amsel.getMselValue());
+      }
+      int port = getPortType(connectOp.getDestBundle());
+      if (port < 0)
+        return connectOp.emitOpError(
+            "bundle cannot be configured by a configuration image");
+      image.add(AIE_CONFIG_SWITCHBOXES, AIE_CONFIG_PACKET_MASTER,
+                {col, row, port, connectOp.destIndex(),
+                 connectOp.dropsHeader() ? 1 : 0, arbiter, mask});
+    }
+
+    for (auto connectOp : b.getOps<PacketRulesOp>()) {
+      int port = getPortType(connectOp.getSourceBundle());
+      if (port < 0)
+        return connectOp.emitOpError(
+            "bundle cannot be configured by a configuration image");
+      int slot = 0;
+      Block &block = connectOp.getRules().front();
+      for (auto slotOp : block.getOps<PacketRuleOp>()) {
+        AMSelOp amselOp = dyn_cast<AMSelOp>(slotOp.getAmsel().getDefiningOp());
+        image.add(AIE_CONFIG_SWITCHBOXES, AIE_CONFIG_PACKET_SLAVE,
+                  {col, row, port, connectOp.sourceIndex(), slot,
+                   slotOp.valueInt(), slotOp.maskInt(),
+                   amselOp.getMselValue(), amselOp.arbiterIndex()});
+        slot++;
+      }
+    }
+  }
+
+  // ShimMux always connects from the south as directions are defined
+  // relative to the tile stream switch.
+  for (auto op : targetOp.getOps<ShimMuxOp>()) {
+    int col = op.colIndex();
+    int row = op.rowIndex();
+    for (auto connectOp : op.getConnections().front().getOps<ConnectOp>()) {
+      if (connectOp.getSourceBundle() == WireBundle::North)
+        image.add(AIE_CONFIG_SWITCHBOXES, AIE_CONFIG_SHIM_MUX,
+                  {col, row, 0, connectOp.sourceIndex()});
+      else if (connectOp.getDestBundle() == WireBundle::North)
+        image.add(AIE_CONFIG_SWITCHBOXES, AIE_CONFIG_SHIM_MUX,
+                  {col, row, 1, connectOp.destIndex()});
+    }
+  }
+
+  for (auto switchboxOp : targetOp.getOps<ShimSwitchboxOp>())
+    if (failed(addConnects(switchboxOp.getConnections().front(),
+                           switchboxOp.getCol(), 0)))
+      return failure();
+
+  int arch = targetModel.getTargetArch() == AIEArch::AIE1 ? 1 : 2;
+  if (asText) {
+    output << "image " << stringifyEnum(targetModel.getTargetArch()) << " "
+           << targetModel.columns() << " " << targetModel.rows() << " "
+           << targetModel.getNumMemTileRows() << "\n";
+    for (size_t i = 0; i < image.externalBuffers.size(); i++)
+      output << "external " << i << " " << image.externalBuffers[i] << "\n";
+    for (auto &record : image.records) {
+      output << stringifySection(record.section) << " "
+             << stringifyRecord(record.type);
+      if (record.type == AIE_CONFIG_LOAD_ELF) {
+        output << " " << record.payload[0] << " " << record.payload[1] << " "
+               << record.name << "\n";
+        continue;
+      }
+      for (uint32_t word : record.payload)
+        output << " " << static_cast<int32_t>(word);
+      output << "\n";
+    }
+    return success();
+  }
+
+  SmallVector<uint32_t, 1024> words = {
+      AIE_CONFIG_IMAGE_MAGIC,
+      AIE_CONFIG_IMAGE_VERSION,
+      static_cast<uint32_t>(arch),
+      static_cast<uint32_t>(targetModel.columns()),
+      static_cast<uint32_t>(targetModel.rows()),
+      static_cast<uint32_t>(targetModel.getNumMemTileRows()),
+      static_cast<uint32_t>(image.externalBuffers.size()),
+      static_cast<uint32_t>(image.records.size())};
+  for (auto &name : image.externalBuffers)
+    appendString(words, name);
+  for (auto &record : image.records) {
+    if (record.payload.size() > 0xffff)
+      return targetOp.emitOpError("configuration record is too long");
+    words.push_back(static_cast<uint32_t>(record.section) << 24 |
+                    static_cast<uint32_t>(record.type) << 16 |
+                    record.payload.size());
+    words.append(record.payload.begin(), record.payload.end());
+  }
+  for (uint32_t word : words)
+    llvm::support::endian::write(output, word, llvm::support::little);
+  return success();
+}
+
+} // namespace AIE
+} // namespace xilinx
@@ -0,0 +1,237 @@
+//===- AIETargetUtilization.cpp ---------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+/*
+ * Takes as input the mlir after buffer address assignment and routing.
+ * Reports the resources used in each tile of the device as JSON: data memory,
+ * locks, buffer descriptors, DMA channels and switchbox ports, together with
+ * the depth that each objectFifo could grow by with the resources left.
+ */
+
+#include <limits>
+#include <map>
+#include <set>
+
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/BuiltinOps.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+
+#include "aie/Dialect/AIE/IR/AIEDialect.h"
+
+#include "AIETargets.h"
+
+using namespace mlir;
+using namespace xilinx;
+using namespace xilinx::AIE;
+
+namespace xilinx {
+namespace AIE {
+
+// The resources used in one tile.
+struct TileUtilization {
+  int64_t stack = 0;
+  SmallVector<BufferOp, 4> buffers;
+  int numLocks = 0;
+  int numBDs = 0;
+  int numMM2S = 0;
+  int numS2MM = 0;
+  // master and slave ports used in each bundle of the switchbox
+  std::map<WireBundle, std::set<int>> masters, slaves;
+};
+
+// The objectFifo lowering names the buffers of an objectFifo <name>_buff_<i>.
+// Return <name> or an empty string for other buffers.
+static StringRef getObjectFifoName(BufferOp buffer) {
+  if (!buffer.hasName())
+    return StringRef();
+  StringRef name = buffer.name().getValue();
+  size_t pos = name.rfind("_buff_");
+  if (pos == StringRef::npos || pos == 0)
+    return StringRef();
+  StringRef index = name.drop_front(pos + strlen("_buff_"));
+  if (index.empty() || !llvm::all_of(index, llvm::isDigit))
+    return StringRef();
+  return name.take_front(pos);
+}
+
+static llvm::json::Object usageToJSON(int64_t used, int64_t available) {
+  llvm::json::Object usage;
+  usage["used"] = used;
+  usage["available"] = available;
+  return usage;
+}
+
+mlir::LogicalResult AIETranslateToUtilizationJSON(ModuleOp module,
+                                                  raw_ostream &output) {
+  if (module.getOps<DeviceOp>().empty())
+    return module.emitOpError("expected AIE.device operation at toplevel");
+  DeviceOp device = *(module.getOps<DeviceOp>().begin());
+  const auto &targetModel = device.getTargetModel();
+
+  std::map<TileID, TileUtilization> tiles;
+  for (auto tile : device.getOps<TileOp>())
+    tiles[std::make_pair(tile.colIndex(), tile.rowIndex())];
+
+  DenseSet<Operation *> dmaBuffers;
+  auto countDMA = [&](TileUtilization &usage, Region &body) {
+    for (auto dmaStart : body.getOps<DMAStartOp>()) {
+      if (dmaStart.isSend())
+        usage.numMM2S++;
+      else
+        usage.numS2MM++;
+    }
+    for (auto &block : body)
+      for (auto dmaBd : block.getOps<DMABDOp>()) {
+        usage.numBDs++;
+        dmaBuffers.insert(dmaBd.getBuffer().getDefiningOp());
+      }
+  };
+
+  for (Operation &op : *device.getBody()) {
+    auto element = dyn_cast<TileElement>(op);
+    if (!element)
+      continue;
+    TileUtilization &usage = tiles[element.getTileID()];
+    if (auto buffer = dyn_cast<BufferOp>(op)) {
+      usage.buffers.push_back(buffer);
+    } else if (auto core = dyn_cast<CoreOp>(op)) {
+      usage.stack = core.getStackSize();
+    } else if (isa<LockOp>(op)) {
+      usage.numLocks++;
+    } else if (auto mem = dyn_cast<MemOp>(op)) {
+      countDMA(usage, mem.getBody());
+    } else if (auto mem = dyn_cast<MemTileDMAOp>(op)) {
+      countDMA(usage, mem.getBody());
+    } else if (auto mem = dyn_cast<ShimDMAOp>(op)) {
+      countDMA(usage, mem.getBody());
+    } else if (auto switchbox = dyn_cast<SwitchboxOp>(op)) {
+      for (auto connect : switchbox.getOps<ConnectOp>()) {
+        usage.slaves[connect.getSourceBundle()].insert(
+            connect.getSourceChannel());
+        usage.masters[connect.getDestBundle()].insert(
+            connect.getDestChannel());
+      }
+      for (auto masterSet : switchbox.getOps<MasterSetOp>())
+        usage.masters[masterSet.getDestBundle()].insert(
+            masterSet.getDestChannel());
+      for (auto rules : switchbox.getOps<PacketRulesOp>())
+        usage.slaves[rules.getSourceBundle()].insert(
+            rules.getSourceChannel());
+    }
+  }
+
+  llvm::json::Array tilesJSON;
+  for (auto &[coord, usage] : tiles) {
+    int col = coord.first, row = coord.second;
+    llvm::json::Object tileJSON;
+    tileJSON["col"] = col;
+    tileJSON["row"] = row;
+    bool isMemTile = targetModel.isMemTile(col, row);
+    bool isCoreTile = targetModel.isCoreTile(col, row);
+    tileJSON["type"] = isMemTile ? "mem" : isCoreTile ? "core" : "shim";
+
+    int numLocks = targetModel.getNumLocks(col, row);
+    int numBDs = targetModel.getNumBDs(col, row);
+    int64_t free = 0;
+    if (isMemTile || isCoreTile) {
+      int64_t size = isMemTile ? targetModel.getMemTileSize()
+                               : targetModel.getLocalMemorySize();
+      int64_t stack = usage.stack;
+      // Without addresses, assume the buffers are packed after the stack.
+      int64_t bufferBytes = 0, used = stack;
+      bool allPlaced = true;
+      for (auto buffer : usage.buffers) {
+        bufferBytes += buffer.getAllocationSize();
+        if (auto address = buffer->getAttrOfType<IntegerAttr>("address"))
+          used = std::max(used, address.getInt() + buffer.getAllocationSize());
+        else
+          allPlaced = false;
+      }
+      if (!allPlaced)
+        used = std::max(used, stack + bufferBytes);
+      free = std::max<int64_t>(size - used, 0);
+
+      llvm::json::Object memoryJSON;
+      memoryJSON["size"] = size;
+      memoryJSON["stack"] = stack;
+      memoryJSON["buffers"] = bufferBytes;
+      memoryJSON["used"] = used;
+      memoryJSON["free"] = free;
+      tileJSON["memory"] = std::move(memoryJSON);
+    }
+    tileJSON["locks"] = usageToJSON(usage.numLocks, numLocks);
+    tileJSON["bds"] = usageToJSON(usage.numBDs, numBDs);
+    llvm::json::Object dmaJSON;
+    dmaJSON["mm2s"] = usage.numMM2S;
+    dmaJSON["s2mm"] = usage.numS2MM;
+    tileJSON["dma_channels"] = std::move(dmaJSON);
+
+    llvm::json::Object switchboxJSON;
+    for (uint32_t i = 0; i <= getMaxEnumValForWireBundle(); i++) {
+      WireBundle bundle = static_cast<WireBundle>(i);
+      int numMasters =
+          targetModel.getNumDestSwitchboxConnections(col, row, bundle);
+      int numSlaves =
+          targetModel.getNumSourceSwitchboxConnections(col, row, bundle);
+      if (numMasters == 0 && numSlaves == 0 && usage.masters[bundle].empty() &&
+          usage.slaves[bundle].empty())
+        continue;
+      llvm::json::Object bundleJSON;
+      bundleJSON["masters"] =
+          usageToJSON(usage.masters[bundle].size(), numMasters);
+      bundleJSON["slaves"] =
+          usageToJSON(usage.slaves[bundle].size(), numSlaves);
+      switchboxJSON[stringifyWireBundle(bundle)] = std::move(bundleJSON);
+    }
+    tileJSON["switchbox"] = std::move(switchboxJSON);
+
+    // How many more elements each objectFifo could have with the memory, and
+    // for AIE1 the locks, and for objectFifos used by a DMA the BDs left.
+    std::map<std::string, SmallVector<BufferOp, 4>> objectFifos;
+    for (auto buffer : usage.buffers) {
+      StringRef name = getObjectFifoName(buffer);
+      if (!name.empty())
+        objectFifos[name.str()].push_back(buffer);
+    }
+    llvm::json::Array objectFifosJSON;
+    for (auto &[name, buffers] : objectFifos) {
+      int64_t elementSize = buffers.front().getAllocationSize();
+      int64_t extraDepth = elementSize > 0 ? free / elementSize
+                                           : std::numeric_limits<int>::max();
+      if (targetModel.getTargetArch() == AIEArch::AIE1)
+        extraDepth = std::min<int64_t>(extraDepth, numLocks - usage.numLocks);
+      if (dmaBuffers.count(buffers.front()))
+        extraDepth = std::min<int64_t>(extraDepth, numBDs - usage.numBDs);
+      llvm::json::Object objectFifoJSON;
+      objectFifoJSON["name"] = name;
+      objectFifoJSON["depth"] = static_cast<int64_t>(buffers.size());
+      objectFifoJSON["element_size"] = elementSize;
+      objectFifoJSON["extra_depth"] = std::max<int64_t>(extraDepth, 0);
+      objectFifosJSON.push_back(std::move(objectFifoJSON));
+    }
+    if (!objectFifosJSON.empty())
+      tileJSON["objectfifos"] = std::move(objectFifosJSON);
+
+    tilesJSON.push_back(std::move(tileJSON));
+  }
+
+  llvm::json::Object deviceJSON;
+  deviceJSON["device"] = stringifyAIEDevice(device.getDevice());
+  deviceJSON["tiles"] = std::move(tilesJSON);
+  output << llvm::formatv("{0:2}", llvm::json::Value(std::move(deviceJSON)))
+         << "\n";
+  return success();
+}
+
+} // namespace AIE
+} // namespace xilinx
@@ -23,6 +23,9 @@
 #include "llvm/IR/Module.h"
 #include "llvm/Support/TargetSelect.h"
 
+#include <map>
+#include <set>
+
 #include "aie/Dialect/AIE/AIENetlistAnalysis.h"
 #include "aie/Dialect/AIE/IR/AIEDialect.h"
 #include "aie/Dialect/AIEX/IR/AIEXDialect.h"
@@ -47,14 +50,38 @@ const char xaie_c_file_header[] = R"code(
 #define __mlir_aie_verbose(x)
 #endif
 
+// With MLIR_AIE_BATCHED_WRITES defined, the register writes of the DMA, lock
+// and switchbox configuration functions are recorded into a transaction and
+// submitted at once when the function returns, see mlir_aie_start_transaction.
+#ifdef MLIR_AIE_BATCHED_WRITES
+static thread_local bool __mlir_aie_batching = false;
+#define __mlir_aie_batch_begin() do { \
+  if(mlir_aie_start_transaction(ctx)) \
+    return XAIE_ERR; \
+  __mlir_aie_batching = true; \
+} while(0)
+#define __mlir_aie_batch_end() do { \
+  if(__mlir_aie_batching) { \
+    __mlir_aie_batching = false; \
+    if(mlir_aie_submit_transaction(ctx, NULL)) \
+      return XAIE_ERR; \
+  } \
+} while(0)
+#else
+#define __mlir_aie_batch_begin()
+#define __mlir_aie_batch_end()
+#endif
+
 // The following is a wrapper for the common "if(call() != 0) return 1" pattern.
 // Use this only in functions that return int. If the call this wrapper is used
 // on does not succeed, the expanded code will exit out of the function 
-// containing this macro with an error code.
+// containing this macro with an error code, after submitting the writes
+// recorded so far.
 #define __mlir_aie_try(x) do { \
   AieRC ret = (x); \
   if(ret != XAIE_OK) { \
-    return x; \
+    __mlir_aie_batch_end(); \
+    return ret; \
   } \
 } while(0)
 
@@ -67,6 +94,56 @@ static XAie_DmaDimDesc *__mlir_aie_alloc_dim_desc(size_t ndims) {
   return ret;
 }
 
+// bf16 buffers are accessed as float on the host, rounding to nearest even.
+static inline u16 __mlir_aie_float_to_bf16(float f) {
+  union { float f; u32 i; } c;
+  c.f = f;
+  if ((c.i & 0x7fffffff) > 0x7f800000) // Keep NaNs quiet
+    return (c.i >> 16) | 0x40;
+  return (c.i + 0x7fff + ((c.i >> 16) & 1)) >> 16;
+}
+
+static inline float __mlir_aie_bf16_to_float(u16 b) {
+  union { float f; u32 i; } c;
+  c.i = (u32)b << 16;
+  return c.f;
+}
+
+// The bf16 blocks are converted through a buffer of this many elements.
+#define __MLIR_AIE_BF16_CHUNK 256
+
+static inline AieRC __mlir_aie_write_bf16_block(XAie_DevInst *dev,
+    XAie_LocType loc, u32 addr, const float *values, size_t count) {
+  u16 bits[__MLIR_AIE_BF16_CHUNK];
+  for (size_t i = 0; i < count; i += __MLIR_AIE_BF16_CHUNK) {
+    size_t n = count - i;
+    if (n > __MLIR_AIE_BF16_CHUNK)
+      n = __MLIR_AIE_BF16_CHUNK;
+    for (size_t j = 0; j < n; j++)
+      bits[j] = __mlir_aie_float_to_bf16(values[i + j]);
+    AieRC rc = XAie_DataMemBlockWrite(dev, loc, addr + i * 2, bits, n * 2);
+    if (rc != XAIE_OK)
+      return rc;
+  }
+  return XAIE_OK;
+}
+
+static inline AieRC __mlir_aie_read_bf16_block(XAie_DevInst *dev,
+    XAie_LocType loc, u32 addr, float *values, size_t count) {
+  u16 bits[__MLIR_AIE_BF16_CHUNK];
+  for (size_t i = 0; i < count; i += __MLIR_AIE_BF16_CHUNK) {
+    size_t n = count - i;
+    if (n > __MLIR_AIE_BF16_CHUNK)
+      n = __MLIR_AIE_BF16_CHUNK;
+    AieRC rc = XAie_DataMemBlockRead(dev, loc, addr + i * 2, bits, n * 2);
+    if (rc != XAIE_OK)
+      return rc;
+    for (size_t j = 0; j < n; j++)
+      values[i + j] = __mlir_aie_bf16_to_float(bits[j]);
+  }
+  return XAIE_OK;
+}
+
 )code";
 
 /*
@@ -135,6 +212,50 @@ static std::string packetStr(int id, int type) {
   return packetStr(std::to_string(id), std::to_string(type));
 }
 
+DenseMap<Block *, int> getBDNumbers(Region &body, bool isMemTile) {
+  DenseMap<Block *, int> blockMap;
+  if (!isMemTile) {
+    // Assign each block a BD number
+    int bdNum = 0;
+    for (auto &block : body)
+      if (!block.getOps<DMABDOp>().empty())
+        blockMap[&block] = bdNum++;
+    return blockMap;
+  }
+
+  // Memtiles have restrictions on which channels can access which BDs
+  DenseMap<Block *, int> channelMap;
+  for (auto &block : body) {
+    for (auto op : block.getOps<DMAStartOp>()) {
+      int chNum = op.getChannelIndex();
+      channelMap[&block] = chNum;
+      auto dest = op.getDest();
+      while (dest) {
+        channelMap[dest] = chNum;
+        if (dest->getSuccessors().size() < 1)
+          break;
+        dest = dest->getSuccessors()[0];
+        if (channelMap.count(dest))
+          break;
+      }
+    }
+  }
+
+  // Assign each block a BD number
+  int evenBdNum = 0;
+  int oddBdNum = 24;
+  for (auto &block : body) {
+    if (block.getOps<DMABDOp>().empty())
+      continue;
+    assert(channelMap.count(&block));
+    if (channelMap[&block] & 1)
+      blockMap[&block] = oddBdNum++;
+    else
+      blockMap[&block] = evenBdNum++;
+  }
+  return blockMap;
+}
+
 // FIXME: code bloat. this shouldn't really be a template, but need
 // a proper DMA-like interface
 // blockMap: A map that gives a unique bd ID assignment for every block.
@@ -390,6 +511,128 @@ mlir::LogicalResult generateDMAConfig(OpType memOp, raw_ostream &output,
   return success();
 }
 
+static std::string elfFileName(CoreOp coreOp, int col, int row) {
+  if (auto fileAttr = coreOp->getAttrOfType<StringAttr>("elf_file"))
+    return std::string(fileAttr.getValue());
+  return std::string("core_") + std::to_string(col) + "_" +
+         std::to_string(row) + ".elf";
+}
+
+static void generateLoadElf(CoreOp coreOp, raw_ostream &output, int col,
+                            int row) {
+  StringRef deviceInstRef = "&(ctx->DevInst)"; // TODO
+  output << "{\n"
+         << "AieRC RC = XAie_LoadElf(" << deviceInstRef << ", "
+         << tileLocStr(col, row) << ", "
+         << "(const char*)\"" << elfFileName(coreOp, col, row) << "\",0);\n";
+  output << "if (RC != XAIE_OK)\n"
+         << "    __mlir_aie_verbose(fprintf(stderr, \"Failed to load elf "
+            "for Core[%d,%d], ret is %d\\n\", "
+         << std::to_string(col) << ", " << std::to_string(row) << ", RC));\n"
+         << "assert(RC == XAIE_OK);\n"
+         << "}\n";
+}
+
+// Generate the packet switching configuration of a switchbox at loc.
+static void generatePacketConfig(Block &b, raw_ostream &output,
+                                 StringRef loc) {
+  StringRef deviceInstRef = "&(ctx->DevInst)"; // TODO
+  for (auto connectOp : b.getOps<MasterSetOp>()) {
+    int mask = 0;
+    int arbiter = -1;
+    for (auto val : connectOp.getAmsels()) {
+      AMSelOp amsel = dyn_cast<AMSelOp>(val.getDefiningOp());
+      arbiter = amsel.arbiterIndex();
+      int msel = amsel.getMselValue();
+      mask |= (1 << msel);
+    }
+
+    output << "__mlir_aie_try(XAie_StrmPktSwMstrPortEnable(" << deviceInstRef
+           << ", " << loc << ", "
+           << stringifyWireBundle(connectOp.getDestBundle()).upper() << ", "
+           << connectOp.destIndex() << ", "
+           << "/* drop_header */ "
+           << (connectOp.dropsHeader() ? "XAIE_SS_PKT_DROP_HEADER"
+                                       : "XAIE_SS_PKT_DONOT_DROP_HEADER")
+           << ", "
+           << "/* arbiter */ " << arbiter << ", "
+           << "/* MSelEn */ "
+           << "0x" << llvm::utohexstr(mask) << "));\n";
+  }
+
+  for (auto connectOp : b.getOps<PacketRulesOp>()) {
+    int slot = 0;
+    Block &block = connectOp.getRules().front();
+    for (auto slotOp : block.getOps<PacketRuleOp>()) {
+      AMSelOp amselOp = dyn_cast<AMSelOp>(slotOp.getAmsel().getDefiningOp());
+      int arbiter = amselOp.arbiterIndex();
+      int msel = amselOp.getMselValue();
+      output << "__mlir_aie_try(XAie_StrmPktSwSlavePortEnable("
+             << deviceInstRef << ", " << loc << ", "
+             << stringifyWireBundle(connectOp.getSourceBundle()).upper()
+             << ", " << connectOp.sourceIndex() << "));\n";
+
+      // TODO Need to better define packet id,type used here
+      output << "__mlir_aie_try(XAie_StrmPktSwSlaveSlotEnable("
+             << deviceInstRef << ", " << loc << ", "
+             << stringifyWireBundle(connectOp.getSourceBundle()).upper()
+             << ", " << connectOp.sourceIndex() << ", "
+             << "/* slot */ " << slot << ", "
+             << "/* packet */ " << packetStr(slotOp.valueInt(), /*type*/ 0)
+             << ", "
+             << "/* mask */ "
+             << "0x" << llvm::utohexstr(slotOp.maskInt()) << ", "
+             << "/* msel */ " << msel << ", "
+             << "/* arbiter */ " << arbiter << "));\n";
+      slot++;
+    }
+  }
+}
+
+// Generate the accessors copying count elements from or to a buffer at once,
+// starting at element offset, with the libxaie block transfers.
+static void generateBlockAccessors(BufferOp buf, raw_ostream &output,
+                                   StringRef typestr, StringRef loc) {
+  StringRef ctx_p = "aie_libxaie_ctx_t* ctx"; // TODO
+  StringRef deviceInstRef = "&(ctx->DevInst)"; // TODO
+  std::string bufName(buf.name().getValue());
+  auto memrefType = buf.getType().cast<MemRefType>();
+  bool isBF16 = memrefType.getElementType().isBF16();
+  int elementBytes = memrefType.getElementTypeBitWidth() / 8;
+
+  auto checkAndAddress = [&]() {
+    output << "  if (offset < 0 || (size_t)offset + count > "
+           << memrefType.getNumElements() << ")\n"
+           << "    return XAIE_INVALID_ARGS;\n";
+    output << "  u32 addr = " << bufName << "_offset + offset * "
+           << elementBytes << ";\n";
+  };
+
+  output << "int mlir_aie_read_buffer_" << bufName << "_block(" << ctx_p
+         << ", int offset, " << typestr << " *values, size_t count) {\n";
+  checkAndAddress();
+  if (isBF16)
+    output << "  return __mlir_aie_read_bf16_block(" << deviceInstRef << ", "
+           << loc << ", addr, values, count);\n";
+  else
+    output << "  return XAie_DataMemBlockRead(" << deviceInstRef << ", " << loc
+           << ", addr, values, count * " << elementBytes << ");\n";
+  output << "}\n";
+
+  output << "int mlir_aie_write_buffer_" << bufName << "_block(" << ctx_p
+         << ", int offset, const " << typestr
+         << " *values, size_t count) {\n";
+  checkAndAddress();
+  if (isBF16)
+    output << "  return __mlir_aie_write_bf16_block(" << deviceInstRef << ", "
+           << loc << ", addr, values, count);\n";
+  else
+    output << "  return XAie_DataMemBlockWrite(" << deviceInstRef << ", "
+           << loc << ", addr, (void *)values, count * " << elementBytes
+           << ");\n";
+  output << "}\n";
+}
+
 mlir::LogicalResult AIETranslateToXAIEV2(ModuleOp module, raw_ostream &output) {
   //  StringRef ctx   = "ctx";                     // TODO
   StringRef ctx_p = "aie_libxaie_ctx_t* ctx"; // TODO
@@ -470,45 +713,34 @@ mlir::LogicalResult AIETranslateToXAIEV2(ModuleOp module, raw_ostream &output) {
   // mlir_aie_configure_cores
   //---------------------------------------------------------------------------
   output << "int mlir_aie_configure_cores(" << ctx_p << ") {\n";
-  // Reset each core.  Load the corresponding ELF file, if necessary.
-  for (auto tileOp : targetOp.getOps<TileOp>()) {
-    int col = tileOp.colIndex();
-    int row = tileOp.rowIndex();
-    if (tileOp.isShimTile() || tileOp.isMemTile()) {
-      // Resets no needed with V2 kernel driver
-    } else {
-      // Resets no needed with V2 kernel driver
-      output << "__mlir_aie_try(XAie_CoreReset(" << deviceInstRef << ", "
-             << tileLocStr(col, row) << "));\n";
-      output << "__mlir_aie_try(XAie_CoreDisable(" << deviceInstRef << ", "
-             << tileLocStr(col, row) << "));\n";
-      // Release locks
-      int numLocks = target_model.getNumLocks(col, row);
-      output << "for (int l = 0; l < " << numLocks << "; ++l)\n"
-             << "  __mlir_aie_try(XAie_LockRelease(" << deviceInstRef << ", "
-             << tileLocStr(col, row) << ", XAie_LockInit(l, 0x0), 0));\n";
-      if (auto coreOp = tileOp.getCoreOp()) {
-        std::string fileName;
-        if (auto fileAttr = coreOp->getAttrOfType<StringAttr>("elf_file")) {
-          fileName = std::string(fileAttr.getValue());
-        } else {
-          fileName = std::string("core_") + std::to_string(col) + "_" +
-                     std::to_string(row) + ".elf";
-        }
-        output << "{\n"
-               << "AieRC RC = XAie_LoadElf(" << deviceInstRef << ", "
-               << tileLocStr(col, row) << ", "
-               << "(const char*)\"" << fileName << "\",0);\n";
-        output << "if (RC != XAIE_OK)\n"
-               << "    __mlir_aie_verbose(fprintf(stderr, \"Failed to load elf "
-                  "for Core[%d,%d], ret is %d\\n\", "
-               << std::to_string(col) << ", " << std::to_string(row)
-               << ", RC));\n"
-               << "assert(RC == XAIE_OK);\n"
-               << "}\n";
+  // The body of each configuration function is generated for all the tiles,
+  // or only for the tiles of a column for the per column variants.
+  auto coresConfig = [&](std::optional<int> column) {
+    // Reset each core.  Load the corresponding ELF file, if necessary.
+    for (auto tileOp : targetOp.getOps<TileOp>()) {
+      int col = tileOp.colIndex();
+      int row = tileOp.rowIndex();
+      if (column && col != *column)
+        continue;
+      if (tileOp.isShimTile() || tileOp.isMemTile()) {
+        // Resets no needed with V2 kernel driver
+      } else {
+        // Resets no needed with V2 kernel driver
+        output << "__mlir_aie_try(XAie_CoreReset(" << deviceInstRef << ", "
+               << tileLocStr(col, row) << "));\n";
+        output << "__mlir_aie_try(XAie_CoreDisable(" << deviceInstRef << ", "
+               << tileLocStr(col, row) << "));\n";
+        // Release locks
+        int numLocks = target_model.getNumLocks(col, row);
+        output << "for (int l = 0; l < " << numLocks << "; ++l)\n"
+               << "  __mlir_aie_try(XAie_LockRelease(" << deviceInstRef << ", "
+               << tileLocStr(col, row) << ", XAie_LockInit(l, 0x0), 0));\n";
+        if (auto coreOp = tileOp.getCoreOp())
+          generateLoadElf(coreOp, output, col, row);
       }
     }
-  }
+  };
+  coresConfig(std::nullopt);
   output << "return XAIE_OK;\n";
   output << "} // mlir_aie_configure_cores\n\n";
 
@@ -534,6 +766,7 @@ mlir::LogicalResult AIETranslateToXAIEV2(ModuleOp module, raw_ostream &output) {
   // mlir_aie_configure_dmas
   //---------------------------------------------------------------------------
   output << "int mlir_aie_configure_dmas(" << ctx_p << ") {\n";
+  output << "__mlir_aie_batch_begin();\n";
 
   // DMA configuration
   // AieRC XAie_DmaDescInit(XAie_DevInst *DevInst, XAie_DmaDesc *DmaDesc,
@@ -567,59 +800,31 @@ mlir::LogicalResult AIETranslateToXAIEV2(ModuleOp module, raw_ostream &output) {
   // XAie_DmaChannelEnable(XAie_DevInst *DevInst, XAie_LocType Loc, u8 ChNum,
   // XAie_DmaDirection Dir); AieRC XAie_DmaChannelDisable(XAie_DevInst *DevInst,
   // XAie_LocType Loc, u8 ChNum, XAie_DmaDirection Dir);
-  for (auto memOp : targetOp.getOps<MemOp>()) {
-    DenseMap<Block *, int> blockMap;
-
-    // Assign each block a BD number
-    int bdNum = 0;
-    for (auto &block : memOp.getBody()) {
-      if (!block.getOps<DMABDOp>().empty()) {
-        blockMap[&block] = bdNum;
-        bdNum++;
-      }
-    }
-    auto result = generateDMAConfig(memOp, output, target_model, NL, blockMap);
-    if (result.failed())
-      return result;
-  }
-  for (auto memOp : targetOp.getOps<MemTileDMAOp>()) {
-    DenseMap<Block *, int> blockMap;
-    // Memtiles have restrictions on which channels can access which BDs
-    DenseMap<Block *, int> channelMap;
-
-    for (auto &block : memOp.getBody()) {
-      for (auto op : block.getOps<DMAStartOp>()) {
-        int chNum = op.getChannelIndex();
-        channelMap[&block] = chNum;
-        auto dest = op.getDest();
-        while (dest) {
-          channelMap[dest] = chNum;
-          if (dest->getSuccessors().size() < 1)
-            break;
-          dest = dest->getSuccessors()[0];
-          if (channelMap.count(dest))
-            break;
-        }
-      }
+  auto dmasConfig = [&](std::optional<int> column) -> LogicalResult {
+    for (auto memOp : targetOp.getOps<MemOp>()) {
+      if (column && memOp.colIndex() != *column)
+        continue;
+      DenseMap<Block *, int> blockMap = getBDNumbers(memOp.getBody(), false);
+      auto result =
+          generateDMAConfig(memOp, output, target_model, NL, blockMap);
+      if (result.failed())
+        return result;
     }
-
-    // Assign each block a BD number
-    int evenBdNum = 0;
-    int oddBdNum = 24;
-    for (auto &block : memOp.getBody()) {
-      if (block.getOps<DMABDOp>().empty())
+    for (auto memOp : targetOp.getOps<MemTileDMAOp>()) {
+      if (column && memOp.colIndex() != *column)
         continue;
-      assert(channelMap.count(&block));
-      if (channelMap[&block] & 1)
-        blockMap[&block] = oddBdNum++;
-      else
-        blockMap[&block] = evenBdNum++;
+      DenseMap<Block *, int> blockMap = getBDNumbers(memOp.getBody(), true);
+      auto result =
+          generateDMAConfig(memOp, output, target_model, NL, blockMap);
+      if (result.failed())
+        return result;
     }
-    auto result = generateDMAConfig(memOp, output, target_model, NL, blockMap);
-    if (result.failed())
-      return result;
-  }
+    return success();
+  };
+  if (failed(dmasConfig(std::nullopt)))
+    return failure();
 
+  output << "__mlir_aie_batch_end();\n";
   output << "return XAIE_OK;\n";
   output << "} // mlir_aie_configure_dmas\n\n";
 
@@ -679,9 +884,11 @@ mlir::LogicalResult AIETranslateToXAIEV2(ModuleOp module, raw_ostream &output) {
 
     output << "int mlir_aie_configure_shimdma_" << col << row << "(" << ctx_p
            << ") {\n";
+    output << "__mlir_aie_batch_begin();\n";
     auto result = generateDMAConfig(op, output, target_model, NL, blockMap);
     if (result.failed())
       return result;
+    output << "__mlir_aie_batch_end();\n";
     output << "return XAIE_OK;\n";
     output << "} // mlir_aie_configure_shimdma\n\n";
   }
@@ -690,19 +897,26 @@ mlir::LogicalResult AIETranslateToXAIEV2(ModuleOp module, raw_ostream &output) {
   // mlir_aie_initialize_locks
   //---------------------------------------------------------------------------
   output << "int mlir_aie_initialize_locks(" << ctx_p << ") {\n";
+  output << "__mlir_aie_batch_begin();\n";
   // Lock configuration
-  for (auto lock : targetOp.getOps<LockOp>()) {
-    TileOp tile = lock.getTileOp();
-    int col = tile.colIndex();
-    int row = tile.rowIndex();
-    int lockID = lock.getLockIDValue();
-    auto init = lock.getInit();
-    if (init) {
-      output << "__mlir_aie_try(XAie_LockSetValue(" << deviceInstRef << ", "
-             << tileLocStr(col, row) << ", "
-             << "XAie_LockInit(" << lockID << ", " << *init << ")));\n";
+  auto locksConfig = [&](std::optional<int> column) {
+    for (auto lock : targetOp.getOps<LockOp>()) {
+      TileOp tile = lock.getTileOp();
+      int col = tile.colIndex();
+      int row = tile.rowIndex();
+      if (column && col != *column)
+        continue;
+      int lockID = lock.getLockIDValue();
+      auto init = lock.getInit();
+      if (init) {
+        output << "__mlir_aie_try(XAie_LockSetValue(" << deviceInstRef << ", "
+               << tileLocStr(col, row) << ", "
+               << "XAie_LockInit(" << lockID << ", " << *init << ")));\n";
+      }
     }
-  }
+  };
+  locksConfig(std::nullopt);
+  output << "__mlir_aie_batch_end();\n";
   output << "return XAIE_OK;\n";
   output << "} // mlir_aie_initialize_locks\n";
 
@@ -711,181 +925,219 @@ mlir::LogicalResult AIETranslateToXAIEV2(ModuleOp module, raw_ostream &output) {
   //---------------------------------------------------------------------------
   output << "int mlir_aie_configure_switchboxes(" << ctx_p << ") {\n";
   output << "  int x, y;\n";
+  output << "__mlir_aie_batch_begin();\n";
 
   // StreamSwitch (switchbox) configuration
-  for (auto switchboxOp : targetOp.getOps<SwitchboxOp>()) {
-    Region &r = switchboxOp.getConnections();
-    Block &b = r.front();
-    bool isEmpty = b.getOps<ConnectOp>().empty() &&
-                   b.getOps<MasterSetOp>().empty() &&
-                   b.getOps<PacketRulesOp>().empty();
-    bool isParam = false;
-
-    if (isa<TileOp>(switchboxOp.getTile().getDefiningOp())) {
-      int col = switchboxOp.colIndex();
-      int row = switchboxOp.rowIndex();
-      if (!isEmpty) {
-        output << "// Core Stream Switch column " << col << " row " << row
-               << "\n";
-        output << "x = " << col << ";\n";
-        output << "y = " << row << ";\n";
-      }
-    } else if (AIEX::SelectOp sel = dyn_cast<AIEX::SelectOp>(
-                   switchboxOp.getTile().getDefiningOp())) {
-      // parameterize streamswitch's configuration
-      isParam = true;
-      HerdOp sourceHerd = dyn_cast<HerdOp>(sel.getStartHerd().getDefiningOp());
-      std::string sourceHerdName(sourceHerd.name().getValue());
-
-      IterOp iterX = dyn_cast<IterOp>(sel.getIterX().getDefiningOp());
-      IterOp iterY = dyn_cast<IterOp>(sel.getIterY().getDefiningOp());
-      int startXValue = iterX.getStartValue();
-      int endXValue = iterX.getEndValue();
-      int strideXValue = iterX.getStrideValue();
-      int startYValue = iterY.getStartValue();
-      int endYValue = iterY.getEndValue();
-      int strideYValue = iterY.getStrideValue();
-
-      std::string startX(sourceHerdName + "_X + " +
-                         std::to_string(startXValue));
-      std::string endX(sourceHerdName + "_X + " + std::to_string(endXValue));
-      std::string startY(sourceHerdName + "_Y + " +
-                         std::to_string(startYValue));
-      std::string endY(sourceHerdName + "_Y + " + std::to_string(endYValue));
-
-      output << "for (x = " << startX << "; x < " << endX
-             << "; x += " << strideXValue << ") {\n";
-      output << "for (y = " << startY << "; y < " << endY
-             << "; y += " << strideYValue << ") {\n";
-    }
-
-    for (auto connectOp : b.getOps<ConnectOp>()) {
-      output << "__mlir_aie_try(XAie_StrmConnCctEnable(" << deviceInstRef
-             << ", " << tileLocStr("x", "y") << ", "
-             << stringifyWireBundle(connectOp.getSourceBundle()).upper() << ", "
-             << connectOp.sourceIndex() << ", "
-             << stringifyWireBundle(connectOp.getDestBundle()).upper() << ", "
-             << connectOp.destIndex() << "));\n";
-    }
-
-    for (auto connectOp : b.getOps<MasterSetOp>()) {
-      int mask = 0;
-      int arbiter = -1;
-      for (auto val : connectOp.getAmsels()) {
-        AMSelOp amsel = dyn_cast<AMSelOp>(val.getDefiningOp());
-        arbiter = amsel.arbiterIndex();
-        int msel = amsel.getMselValue();
-        mask |= (1 << msel);
+  auto switchboxesConfig = [&](std::optional<int> column) {
+    for (auto switchboxOp : targetOp.getOps<SwitchboxOp>()) {
+      if (column && (!isa<TileOp>(switchboxOp.getTile().getDefiningOp()) ||
+                     switchboxOp.colIndex() != *column))
+        continue;
+      Region &r = switchboxOp.getConnections();
+      Block &b = r.front();
+      bool isEmpty = b.getOps<ConnectOp>().empty() &&
+                     b.getOps<MasterSetOp>().empty() &&
+                     b.getOps<PacketRulesOp>().empty();
+      bool isParam = false;
+
+      if (isa<TileOp>(switchboxOp.getTile().getDefiningOp())) {
+        int col = switchboxOp.colIndex();
+        int row = switchboxOp.rowIndex();
+        if (!isEmpty) {
+          output << "// Core Stream Switch column " << col << " row " << row
+                 << "\n";
+          output << "x = " << col << ";\n";
+          output << "y = " << row << ";\n";
+        }
+      } else if (AIEX::SelectOp sel = dyn_cast<AIEX::SelectOp>(
+                     switchboxOp.getTile().getDefiningOp())) {
+        // parameterize streamswitch's configuration
+        isParam = true;
+        HerdOp sourceHerd =
+            dyn_cast<HerdOp>(sel.getStartHerd().getDefiningOp());
+        std::string sourceHerdName(sourceHerd.name().getValue());
+
+        IterOp iterX = dyn_cast<IterOp>(sel.getIterX().getDefiningOp());
+        IterOp iterY = dyn_cast<IterOp>(sel.getIterY().getDefiningOp());
+        int startXValue = iterX.getStartValue();
+        int endXValue = iterX.getEndValue();
+        int strideXValue = iterX.getStrideValue();
+        int startYValue = iterY.getStartValue();
+        int endYValue = iterY.getEndValue();
+        int strideYValue = iterY.getStrideValue();
+
+        std::string startX(sourceHerdName + "_X + " +
+                           std::to_string(startXValue));
+        std::string endX(sourceHerdName + "_X + " + std::to_string(endXValue));
+        std::string startY(sourceHerdName + "_Y + " +
+                           std::to_string(startYValue));
+        std::string endY(sourceHerdName + "_Y + " + std::to_string(endYValue));
+
+        output << "for (x = " << startX << "; x < " << endX
+               << "; x += " << strideXValue << ") {\n";
+        output << "for (y = " << startY << "; y < " << endY
+               << "; y += " << strideYValue << ") {\n";
       }
-      bool isdma = (connectOp.getDestBundle() == WireBundle::DMA);
-
-      output << "__mlir_aie_try(XAie_StrmPktSwMstrPortEnable(" << deviceInstRef
-             << ", " << tileLocStr("x", "y") << ", "
-             << stringifyWireBundle(connectOp.getDestBundle()).upper() << ", "
-             << connectOp.destIndex() << ", "
-             << "/* drop_header */ "
-             << (isdma ? "XAIE_SS_PKT_DROP_HEADER"
-                       : "XAIE_SS_PKT_DONOT_DROP_HEADER")
-             << ", "
-             << "/* arbiter */ " << arbiter << ", "
-             << "/* MSelEn */ "
-             << "0x" << llvm::utohexstr(mask) << "));\n";
-    }
-
-    for (auto connectOp : b.getOps<PacketRulesOp>()) {
-      int slot = 0;
-      Block &block = connectOp.getRules().front();
-      for (auto slotOp : block.getOps<PacketRuleOp>()) {
-        AMSelOp amselOp = dyn_cast<AMSelOp>(slotOp.getAmsel().getDefiningOp());
-        int arbiter = amselOp.arbiterIndex();
-        int msel = amselOp.getMselValue();
-        output << "__mlir_aie_try(XAie_StrmPktSwSlavePortEnable("
-               << deviceInstRef << ", " << tileLocStr("x", "y") << ", "
-               << stringifyWireBundle(connectOp.getSourceBundle()).upper()
-               << ", " << connectOp.sourceIndex() << "));\n";
 
-        // TODO Need to better define packet id,type used here
-        output << "__mlir_aie_try(XAie_StrmPktSwSlaveSlotEnable("
-               << deviceInstRef << ", " << tileLocStr("x", "y") << ", "
+      for (auto connectOp : b.getOps<ConnectOp>()) {
+        output << "__mlir_aie_try(XAie_StrmConnCctEnable(" << deviceInstRef
+               << ", " << tileLocStr("x", "y") << ", "
                << stringifyWireBundle(connectOp.getSourceBundle()).upper()
                << ", " << connectOp.sourceIndex() << ", "
-               << "/* slot */ " << slot << ", "
-               << "/* packet */ " << packetStr(slotOp.valueInt(), /*type*/ 0)
-               << ", "
-               << "/* mask */ "
-               << "0x" << llvm::utohexstr(slotOp.maskInt()) << ", "
-               << "/* msel */ " << msel << ", "
-               << "/* arbiter */ " << arbiter << "));\n";
-        slot++;
+               << stringifyWireBundle(connectOp.getDestBundle()).upper()
+               << ", " << connectOp.destIndex() << "));\n";
       }
-    }
 
-    if (isParam) {
-      output << "}\n";
-      output << "}\n";
-    }
-  }
-  for (auto op : targetOp.getOps<ShimMuxOp>()) {
-    Region &r = op.getConnections();
-    Block &b = r.front();
-    bool isEmpty = b.getOps<ConnectOp>().empty();
+      generatePacketConfig(b, output, tileLocStr("x", "y"));
 
-    if (isa<TileOp>(op.getTile().getDefiningOp())) {
-      int col = op.colIndex();
-      int row = op.rowIndex();
-      if (!isEmpty) {
-        output << "// ShimMux column " << col << " row " << row << "\n";
-        output << "// NOTE ShimMux always connects from the south as "
-               << "directions are defined relative to the tile stream "
-               << "switch\n";
-        output << "x = " << col << ";\n";
-        output << "y = " << row << ";\n";
+      if (isParam) {
+        output << "}\n";
+        output << "}\n";
       }
     }
+    for (auto op : targetOp.getOps<ShimMuxOp>()) {
+      if (column && (!isa<TileOp>(op.getTile().getDefiningOp()) ||
+                     op.colIndex() != *column))
+        continue;
+      Region &r = op.getConnections();
+      Block &b = r.front();
+      bool isEmpty = b.getOps<ConnectOp>().empty();
+
+      if (isa<TileOp>(op.getTile().getDefiningOp())) {
+        int col = op.colIndex();
+        int row = op.rowIndex();
+        if (!isEmpty) {
+          output << "// ShimMux column " << col << " row " << row << "\n";
+          output << "// NOTE ShimMux always connects from the south as "
+                 << "directions are defined relative to the tile stream "
+                 << "switch\n";
+          output << "x = " << col << ";\n";
+          output << "y = " << row << ";\n";
+        }
+      }
 
-    for (auto connectOp : b.getOps<ConnectOp>()) {
-      if (connectOp.getSourceBundle() == WireBundle::North) {
-        // demux!
-        output
-            << "__mlir_aie_try(XAie_EnableAieToShimDmaStrmPort("
-            << deviceInstRef << ", " << tileLocStr("x", "y")
-            << ", "
-            //               <<
-            //               stringifyWireBundle(connectOp.sourceBundle()).upper()
-            << connectOp.sourceIndex() << "));\n";
-      } else if (connectOp.getDestBundle() == WireBundle::North) {
-        // mux
-        output
-            << "__mlir_aie_try(XAie_EnableShimDmaToAieStrmPort("
-            << deviceInstRef << ", " << tileLocStr("x", "y")
-            << ", "
-            //               <<
-            //               stringifyWireBundle(connectOp.sourceBundle()).upper()
-            << connectOp.destIndex() << "));\n";
+      for (auto connectOp : b.getOps<ConnectOp>()) {
+        if (connectOp.getSourceBundle() == WireBundle::North) {
+          // demux!
+          output
+              << "__mlir_aie_try(XAie_EnableAieToShimDmaStrmPort("
+              << deviceInstRef << ", " << tileLocStr("x", "y")
+              << ", "
+              //               <<
+              //           stringifyWireBundle(connectOp.sourceBundle()).upper()
+              << connectOp.sourceIndex() << "));\n";
+        } else if (connectOp.getDestBundle() == WireBundle::North) {
+          // mux
+          output
+              << "__mlir_aie_try(XAie_EnableShimDmaToAieStrmPort("
+              << deviceInstRef << ", " << tileLocStr("x", "y")
+              << ", "
+              //               <<
+              //           stringifyWireBundle(connectOp.sourceBundle()).upper()
+              << connectOp.destIndex() << "));\n";
+        }
       }
     }
-  }
-  for (auto switchboxOp : targetOp.getOps<ShimSwitchboxOp>()) {
-    Region &r = switchboxOp.getConnections();
-    Block &b = r.front();
-    bool isEmpty = b.getOps<ConnectOp>().empty();
-    int col = switchboxOp.getCol();
-    if (!isEmpty) {
-      output << "// Shim Switch column " << col << "\n";
-    }
-    for (auto connectOp : b.getOps<ConnectOp>()) {
-      output << "__mlir_aie_try(XAie_StrmConnCctEnable(" << deviceInstRef
-             << ", " << tileLocStr(col, 0) << ", "
-             << stringifyWireBundle(connectOp.getSourceBundle()).upper() << ", "
-             << connectOp.sourceIndex() << ", "
-             << stringifyWireBundle(connectOp.getDestBundle()).upper() << ", "
-             << connectOp.destIndex() << "));\n";
+    for (auto switchboxOp : targetOp.getOps<ShimSwitchboxOp>()) {
+      Region &r = switchboxOp.getConnections();
+      Block &b = r.front();
+      bool isEmpty = b.getOps<ConnectOp>().empty();
+      int col = switchboxOp.getCol();
+      if (column && col != *column)
+        continue;
+      if (!isEmpty) {
+        output << "// Shim Switch column " << col << "\n";
+      }
+      for (auto connectOp : b.getOps<ConnectOp>()) {
+        output << "__mlir_aie_try(XAie_StrmConnCctEnable(" << deviceInstRef
+               << ", " << tileLocStr(col, 0) << ", "
+               << stringifyWireBundle(connectOp.getSourceBundle()).upper()
+               << ", " << connectOp.sourceIndex() << ", "
+               << stringifyWireBundle(connectOp.getDestBundle()).upper()
+               << ", " << connectOp.destIndex() << "));\n";
+      }
     }
-  }
+  };
+  switchboxesConfig(std::nullopt);
 
+  output << "__mlir_aie_batch_end();\n";
   output << "return XAIE_OK;\n";
   output << "} // mlir_aie_configure_switchboxes\n\n";
 
+  //---------------------------------------------------------------------------
+  // Per column configuration
+  //---------------------------------------------------------------------------
+  // Each of these functions only writes the tiles of one column, so that the
+  // columns can be configured by concurrent threads with
+  // mlir_aie_configure_columns. Parameterized switchboxes are not tied to a
+  // column, so designs using them are only configured serially.
+  bool isParameterized =
+      llvm::any_of(targetOp.getOps<SwitchboxOp>(), [](SwitchboxOp op) {
+        return !isa<TileOp>(op.getTile().getDefiningOp());
+      });
+  std::set<int> columns;
+  for (auto tileOp : targetOp.getOps<TileOp>())
+    columns.insert(tileOp.colIndex());
+  if (!isParameterized && !columns.empty()) {
+
+    auto columnFunction = [&](StringRef name, bool hasLoc,
+                              llvm::function_ref<LogicalResult(int)> body) {
+      output << "int " << name << "_column(" << ctx_p << ", int col) {\n";
+      if (hasLoc)
+        output << "  int x, y;\n";
+      output << "switch (col) {\n";
+      for (int col : columns) {
+        output << "case " << col << ": {\n";
+        if (failed(body(col)))
+          return failure();
+        output << "break;\n";
+        output << "}\n";
+      }
+      output << "default:\n";
+      output << "break;\n";
+      output << "}\n";
+      output << "return XAIE_OK;\n";
+      output << "} // " << name << "_column\n\n";
+      return success();
+    };
+    auto cores = [&](int col) {
+      coresConfig(col);
+      return success();
+    };
+    auto switchboxes = [&](int col) {
+      switchboxesConfig(col);
+      return success();
+    };
+    auto locks = [&](int col) {
+      locksConfig(col);
+      return success();
+    };
+    auto dmas = [&](int col) { return dmasConfig(col); };
+    if (failed(columnFunction("mlir_aie_configure_cores", false, cores)) ||
+        failed(columnFunction("mlir_aie_configure_switchboxes", true,
+                              switchboxes)) ||
+        failed(columnFunction("mlir_aie_initialize_locks", false, locks)) ||
+        failed(columnFunction("mlir_aie_configure_dmas", false, dmas)))
+      return failure();
+
+    // The same phases as the serial configuration, each applied to all the
+    // columns before the next one.
+    output << "int mlir_aie_configure_parallel(" << ctx_p
+           << ", int numThreads) {\n";
+    output << "  static const mlir_aie_column_fn phases[] = {\n"
+           << "    mlir_aie_configure_cores_column,\n"
+           << "    mlir_aie_configure_switchboxes_column,\n"
+           << "    mlir_aie_initialize_locks_column,\n"
+           << "    mlir_aie_configure_dmas_column};\n";
+    output << "  static const int columns[] = {";
+    for (int col : columns)
+      output << col << ", ";
+    output << "};\n";
+    output << "  return mlir_aie_configure_columns(ctx, phases, 4, columns, "
+           << columns.size() << ", numThreads);\n";
+    output << "} // mlir_aie_configure_parallel\n\n";
+  }
+
   //---------------------------------------------------------------------------
   // Output Buffer Accessors
   //---------------------------------------------------------------------------
@@ -902,20 +1154,24 @@ mlir::LogicalResult AIETranslateToXAIEV2(ModuleOp module, raw_ostream &output) {
       std::string bufName(buf.name().getValue());
       Type t = buf.getType();
       Type et;
+      // The host type of the elements, and of the words read and written
+      // one at a time.
+      std::string blockTypestr;
       std::string typestr;
       if (auto memrefType = t.dyn_cast<MemRefType>()) {
         et = memrefType.getElementType();
-        if (et.isInteger(32))
-          typestr = "int32_t";
+        if (et.isInteger(8))
+          blockTypestr = "int8_t";
+        else if (et.isInteger(16))
+          blockTypestr = "int16_t";
+        else if (et.isInteger(32))
+          blockTypestr = typestr = "int32_t";
         else if (et.isF32())
-          typestr = "float";
-        else {
-          output << "// buffer " << bufName << " with unsupported type " << t
-                 << ";\n";
-          return; // Unsupported type
-        }
-
-      } else {
+          blockTypestr = typestr = "float";
+        else if (et.isBF16())
+          blockTypestr = "float"; // Converted to and from bf16
+      }
+      if (blockTypestr.empty()) {
         output << "// buffer " << bufName << " with unsupported type " << t
                << ";\n";
         return; // Unsupported type
@@ -923,6 +1179,10 @@ mlir::LogicalResult AIETranslateToXAIEV2(ModuleOp module, raw_ostream &output) {
 
       output << "const int " << bufName << "_offset = " << buf.address()
              << ";\n";
+      generateBlockAccessors(buf, output, blockTypestr, loc);
+      if (typestr.empty())
+        return;
+
       output << typestr << " mlir_aie_read_buffer_" << bufName << "(" << ctx_p
              << ", int index) {\n";
       output << "u32 value; auto rc = XAie_DataMemRdWord(" << deviceInstRef
@@ -983,5 +1243,386 @@ mlir::LogicalResult AIETranslateToXAIEV2(ModuleOp module, raw_ostream &output) {
 
   return success();
 }
+namespace {
+// The configuration of a tile in a design, mostly as the code generated for
+// it, so that two designs can be compared tile by tile.
+struct TileConfig {
+  CoreOp core;
+  // The ELF file and the code of the core.
+  std::string coreKey;
+  // The tiles whose locks the core uses.
+  std::set<std::pair<int, int>> lockTiles;
+  std::string dmas;
+  // The tiles whose locks the DMAs use.
+  std::set<std::pair<int, int>> dmaLockTiles;
+  // The direction and number of each started DMA channel.
+  std::vector<std::pair<std::string, int>> channels;
+  // The arguments of each circuit switched connection.
+  std::set<std::string> connections;
+  std::string packets;
+  std::vector<std::pair<std::string, int>> masterPorts;
+  // The port, channel and number of slots of each packet switched slave.
+  std::vector<std::tuple<std::string, int, int>> slavePorts;
+  // The direction (true: AIE to shim DMA) and port of each shim mux
+  // connection.
+  std::set<std::pair<bool, int>> shimMux;
+  // The initial value of each lock, empty if it has none.
+  std::map<int, std::string> locks;
+};
+} // namespace
+
+// Describe the operations of a core independently of the SSA names of the
+// design, with the buffers and locks it uses identified by their location.
+static std::string coreKey(CoreOp coreOp) {
+  std::string str;
+  llvm::raw_string_ostream key(str);
+  key << elfFileName(coreOp, coreOp.colIndex(), coreOp.rowIndex()) << "\n";
+  DenseMap<Value, int> values;
+  coreOp->walk<WalkOrder::PreOrder>([&](Operation *op) {
+    key << op->getName() << " " << op->getAttrDictionary() << "(";
+    for (Value operand : op->getOperands()) {
+      if (values.count(operand)) {
+        key << values[operand];
+      } else if (auto buf = operand.getDefiningOp<BufferOp>()) {
+        TileOp tile = buf.getTileOp();
+        key << "buffer" << tileLocStr(tile.colIndex(), tile.rowIndex())
+            << "@" << buf->getAttr("address") << ":" << buf.getType();
+      } else if (auto lock = operand.getDefiningOp<LockOp>()) {
+        key << "lock" << tileLocStr(lock.colIndex(), lock.rowIndex()) << "@"
+            << lock.getLockIDValue();
+      } else if (auto tile = operand.getDefiningOp<TileOp>()) {
+        key << "tile" << tileLocStr(tile.colIndex(), tile.rowIndex());
+      } else {
+        key << "?";
+      }
+      key << ",";
+    }
+    key << ")\n";
+    for (Region &region : op->getRegions())
+      for (Block &block : region)
+        for (Value arg : block.getArguments())
+          values.try_emplace(arg, values.size());
+    for (Value result : op->getResults())
+      values.try_emplace(result, values.size());
+  });
+  return key.str();
+}
+
+template <typename OpType>
+static mlir::LogicalResult collectDMAConfig(OpType memOp, bool isMemTile,
+                                            const AIETargetModel &target_model,
+                                            NetlistAnalysis &NL,
+                                            TileConfig &config) {
+  llvm::raw_string_ostream dmas(config.dmas);
+  DenseMap<Block *, int> blockMap = getBDNumbers(memOp.getBody(), isMemTile);
+  if (failed(generateDMAConfig(memOp, dmas, target_model, NL, blockMap)))
+    return failure();
+  for (auto &block : memOp.getBody())
+    for (auto op : block.template getOps<DMAStartOp>())
+      config.channels.push_back(
+          {stringifyDMAChannelDir(op.getChannelDir()).str(),
+           op.getChannelIndex()});
+  memOp.walk([&](UseLockOp op) {
+    if (auto lock = op.getLock().getDefiningOp<LockOp>())
+      config.dmaLockTiles.insert({lock.colIndex(), lock.rowIndex()});
+  });
+  return success();
+}
+
+static mlir::LogicalResult
+collectTileConfigs(DeviceOp targetOp,
+                   std::map<std::pair<int, int>, TileConfig> &configs) {
+  DenseMap<std::pair<int, int>, Operation *> tiles;
+  DenseMap<Operation *, CoreOp> cores;
+  DenseMap<Operation *, MemOp> mems;
+  DenseMap<std::pair<Operation *, int>, LockOp> locks;
+  DenseMap<Operation *, SmallVector<BufferOp, 4>> buffers;
+  DenseMap<Operation *, SwitchboxOp> switchboxes;
+  const auto &target_model = targetOp.getTargetModel();
+
+  NetlistAnalysis NL(targetOp, tiles, cores, mems, locks, buffers, switchboxes);
+  NL.collectTiles(tiles);
+  NL.collectBuffers(buffers);
+
+  for (auto coreOp : targetOp.getOps<CoreOp>()) {
+    TileConfig &config = configs[{coreOp.colIndex(), coreOp.rowIndex()}];
+    config.core = coreOp;
+    config.coreKey = coreKey(coreOp);
+    config.lockTiles.insert({coreOp.colIndex(), coreOp.rowIndex()});
+    coreOp.walk([&](UseLockOp op) {
+      if (auto lock = op.getLock().getDefiningOp<LockOp>())
+        config.lockTiles.insert({lock.colIndex(), lock.rowIndex()});
+    });
+  }
+
+  for (auto memOp : targetOp.getOps<MemOp>())
+    if (failed(collectDMAConfig(
+            memOp, false, target_model, NL,
+            configs[{memOp.colIndex(), memOp.rowIndex()}])))
+      return failure();
+  for (auto memOp : targetOp.getOps<MemTileDMAOp>())
+    if (failed(collectDMAConfig(
+            memOp, true, target_model, NL,
+            configs[{memOp.colIndex(), memOp.rowIndex()}])))
+      return failure();
+
+  for (auto lock : targetOp.getOps<LockOp>()) {
+    TileConfig &config = configs[{lock.colIndex(), lock.rowIndex()}];
+    auto init = lock.getInit();
+    config.locks[lock.getLockIDValue()] = init ? std::to_string(*init) : "";
+  }
+
+  auto connectionStr = [](ConnectOp connectOp) {
+    return stringifyWireBundle(connectOp.getSourceBundle()).upper() + ", " +
+           std::to_string(connectOp.sourceIndex()) + ", " +
+           stringifyWireBundle(connectOp.getDestBundle()).upper() + ", " +
+           std::to_string(connectOp.destIndex());
+  };
+
+  for (auto switchboxOp : targetOp.getOps<SwitchboxOp>()) {
+    if (!isa<TileOp>(switchboxOp.getTile().getDefiningOp()))
+      return switchboxOp.emitOpError(
+          "parameterized switchboxes cannot be reconfigured");
+    int col = switchboxOp.colIndex();
+    int row = switchboxOp.rowIndex();
+    TileConfig &config = configs[{col, row}];
+    Block &b = switchboxOp.getConnections().front();
+    for (auto connectOp : b.getOps<ConnectOp>())
+      config.connections.insert(connectionStr(connectOp));
+
+    llvm::raw_string_ostream packets(config.packets);
+    generatePacketConfig(b, packets, tileLocStr(col, row));
+    for (auto connectOp : b.getOps<MasterSetOp>())
+      config.masterPorts.push_back(
+          {stringifyWireBundle(connectOp.getDestBundle()).upper(),
+           connectOp.destIndex()});
+    for (auto connectOp : b.getOps<PacketRulesOp>()) {
+      auto rules = connectOp.getRules().front().getOps<PacketRuleOp>();
+      config.slavePorts.push_back(
+          {stringifyWireBundle(connectOp.getSourceBundle()).upper(),
+           connectOp.sourceIndex(),
+           (int)std::distance(rules.begin(), rules.end())});
+    }
+  }
+  for (auto switchboxOp : targetOp.getOps<ShimSwitchboxOp>()) {
+    TileConfig &config = configs[{switchboxOp.getCol(), 0}];
+    Block &b = switchboxOp.getConnections().front();
+    for (auto connectOp : b.getOps<ConnectOp>())
+      config.connections.insert(connectionStr(connectOp));
+  }
+  for (auto op : targetOp.getOps<ShimMuxOp>()) {
+    TileConfig &config = configs[{op.colIndex(), op.rowIndex()}];
+    Block &b = op.getConnections().front();
+    for (auto connectOp : b.getOps<ConnectOp>()) {
+      if (connectOp.getSourceBundle() == WireBundle::North)
+        config.shimMux.insert({true, connectOp.sourceIndex()});
+      else if (connectOp.getDestBundle() == WireBundle::North)
+        config.shimMux.insert({false, connectOp.destIndex()});
+    }
+  }
+  return success();
+}
+
+mlir::LogicalResult AIETranslateToXAIEV2Diff(ModuleOp base, ModuleOp module,
+                                             raw_ostream &output) {
+  StringRef ctx_p = "aie_libxaie_ctx_t* ctx"; // TODO
+  StringRef deviceInstRef = "&(ctx->DevInst)"; // TODO
+
+  if (base.getOps<DeviceOp>().empty())
+    return base.emitOpError("expected AIE.device operation at toplevel");
+  if (module.getOps<DeviceOp>().empty())
+    return module.emitOpError("expected AIE.device operation at toplevel");
+  DeviceOp baseOp = *(base.getOps<DeviceOp>().begin());
+  DeviceOp targetOp = *(module.getOps<DeviceOp>().begin());
+  if (baseOp.getDevice() != targetOp.getDevice())
+    return module.emitOpError("expected a design for the same device as ")
+           << stringifyAIEDevice(baseOp.getDevice());
+
+  std::map<std::pair<int, int>, TileConfig> oldConfigs, newConfigs;
+  if (failed(collectTileConfigs(baseOp, oldConfigs)) ||
+      failed(collectTileConfigs(targetOp, newConfigs)))
+    return failure();
+  std::set<std::pair<int, int>> coords;
+  for (auto &config : oldConfigs)
+    coords.insert(config.first);
+  for (auto &config : newConfigs)
+    coords.insert(config.first);
+
+  // The locks of a tile are reset when its core or its DMAs change. No core
+  // may run while the locks it uses are reset, so the cores that change or
+  // that use the locks of such a tile are stopped before any column is
+  // reconfigured, and restarted with their ELF reloaded once all columns are.
+  // Likewise, the DMAs of such a tile or that use its locks are stopped and
+  // configured again.
+  std::set<std::pair<int, int>> resetLocks;
+  for (auto coord : coords) {
+    TileConfig &oldConfig = oldConfigs[coord];
+    TileConfig &newConfig = newConfigs[coord];
+    if (oldConfig.coreKey != newConfig.coreKey ||
+        oldConfig.dmas != newConfig.dmas || oldConfig.locks != newConfig.locks)
+      resetLocks.insert(coord);
+  }
+  auto usesResetLocks = [&](const std::set<std::pair<int, int>> &tiles) {
+    return llvm::any_of(tiles, [&](std::pair<int, int> tile) {
+      return resetLocks.count(tile);
+    });
+  };
+  auto mustRestart = [&](TileConfig &config) {
+    return config.core && usesResetLocks(config.lockTiles);
+  };
+
+  // The code reconfiguring each column, in the order of the functions of
+  // aie_inc.cpp: the ELF of the cores is loaded after the switchboxes and
+  // locks, then the DMAs are started.
+  std::map<int, std::string> columns;
+  std::vector<std::pair<int, int>> stoppedCores, startedCores;
+  for (auto coord : coords) {
+    int col = coord.first;
+    int row = coord.second;
+    auto loc = tileLocStr(col, row);
+    TileConfig &oldConfig = oldConfigs[coord];
+    TileConfig &newConfig = newConfigs[coord];
+    bool locksChanged = resetLocks.count(coord);
+    bool dmasChanged = oldConfig.dmas != newConfig.dmas || locksChanged ||
+                       usesResetLocks(oldConfig.dmaLockTiles) ||
+                       usesResetLocks(newConfig.dmaLockTiles);
+    bool packetsChanged = oldConfig.packets != newConfig.packets;
+    if (mustRestart(oldConfig))
+      stoppedCores.push_back(coord);
+
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    if (dmasChanged)
+      for (auto &channel : oldConfig.channels)
+        os << "__mlir_aie_try(XAie_DmaChannelDisable(" << deviceInstRef << ", "
+           << loc << ", "
+           << "/* ChNum */ " << channel.second << ", "
+           << "/* dmaDir */ DMA_" << channel.first << "));\n";
+
+    for (auto &connection : oldConfig.connections)
+      if (!newConfig.connections.count(connection))
+        os << "__mlir_aie_try(XAie_StrmConnCctDisable(" << deviceInstRef
+           << ", " << loc << ", " << connection << "));\n";
+    if (packetsChanged) {
+      for (auto &port : oldConfig.masterPorts)
+        os << "__mlir_aie_try(XAie_StrmPktSwMstrPortDisable(" << deviceInstRef
+           << ", " << loc << ", " << port.first << ", " << port.second
+           << "));\n";
+      for (auto &port : oldConfig.slavePorts) {
+        for (int slot = 0; slot < std::get<2>(port); slot++)
+          os << "__mlir_aie_try(XAie_StrmPktSwSlaveSlotDisable("
+             << deviceInstRef << ", " << loc << ", " << std::get<0>(port)
+             << ", " << std::get<1>(port) << ", "
+             << "/* slot */ " << slot << "));\n";
+        os << "__mlir_aie_try(XAie_StrmPktSwSlavePortDisable(" << deviceInstRef
+           << ", " << loc << ", " << std::get<0>(port) << ", "
+           << std::get<1>(port) << "));\n";
+      }
+    }
+    // Without a shim DMA connection, the shim mux connects the stream switch
+    // to the PL.
+    for (auto &mux : oldConfig.shimMux)
+      if (!newConfig.shimMux.count(mux))
+        os << "__mlir_aie_try("
+           << (mux.first ? "XAie_EnableAieToPlStrmPort("
+                         : "XAie_EnablePlToAieStrmPort(")
+           << deviceInstRef << ", " << loc << ", " << mux.second << "));\n";
+
+    for (auto &connection : newConfig.connections)
+      if (!oldConfig.connections.count(connection))
+        os << "__mlir_aie_try(XAie_StrmConnCctEnable(" << deviceInstRef << ", "
+           << loc << ", " << connection << "));\n";
+    if (packetsChanged)
+      os << newConfig.packets;
+    for (auto &mux : newConfig.shimMux)
+      if (!oldConfig.shimMux.count(mux))
+        os << "__mlir_aie_try("
+           << (mux.first ? "XAie_EnableAieToShimDmaStrmPort("
+                         : "XAie_EnableShimDmaToAieStrmPort(")
+           << deviceInstRef << ", " << loc << ", " << mux.second << "));\n";
+
+    if (locksChanged) {
+      // Reset the locks of both designs, then initialize the new ones.
+      std::set<int> lockIDs;
+      for (auto &lock : oldConfig.locks)
+        lockIDs.insert(lock.first);
+      for (auto &lock : newConfig.locks)
+        lockIDs.insert(lock.first);
+      for (int lockID : lockIDs)
+        os << "__mlir_aie_try(XAie_LockRelease(" << deviceInstRef << ", "
+           << loc << ", XAie_LockInit(" << lockID << ", 0x0), 0));\n";
+      for (auto &lock : newConfig.locks)
+        if (!lock.second.empty())
+          os << "__mlir_aie_try(XAie_LockSetValue(" << deviceInstRef << ", "
+             << loc << ", "
+             << "XAie_LockInit(" << lock.first << ", " << lock.second
+             << ")));\n";
+    }
+
+    if (mustRestart(newConfig)) {
+      generateLoadElf(newConfig.core, os, col, row);
+      startedCores.push_back(coord);
+    }
+    if (dmasChanged)
+      os << newConfig.dmas;
+
+    if (!os.str().empty())
+      columns[col] += "// Tile column " + std::to_string(col) + " row " +
+                      std::to_string(row) + "\n" + os.str();
+  }
+
+  output << "// This file was auto-generated by aie-translate "
+            "--aie-generate-xaie-diff.\n";
+  output << "// It reconfigures a device configured with another design, and "
+            "must be\n";
+  output << "// included after the aie_inc.cpp generated for this design.\n\n";
+
+  output << "const int mlir_aie_reconfigured_columns[] = {";
+  for (auto &column : columns)
+    output << column.first << ", ";
+  output << "-1};\n\n";
+
+  output << "int mlir_aie_reconfigure_stop_cores(" << ctx_p << ") {\n";
+  for (auto coord : stoppedCores) {
+    auto loc = tileLocStr(coord.first, coord.second);
+    output << "__mlir_aie_try(XAie_CoreReset(" << deviceInstRef << ", " << loc
+           << "));\n";
+    output << "__mlir_aie_try(XAie_CoreDisable(" << deviceInstRef << ", "
+           << loc << "));\n";
+  }
+  output << "return XAIE_OK;\n";
+  output << "} // mlir_aie_reconfigure_stop_cores\n\n";
+
+  for (auto &column : columns) {
+    output << "int mlir_aie_reconfigure_column_" << column.first << "("
+           << ctx_p << ") {\n";
+    output << "__mlir_aie_batch_begin();\n";
+    output << column.second;
+    output << "__mlir_aie_batch_end();\n";
+    output << "return XAIE_OK;\n";
+    output << "} // mlir_aie_reconfigure_column_" << column.first << "\n\n";
+  }
+
+  output << "int mlir_aie_reconfigure_start_cores(" << ctx_p << ") {\n";
+  for (auto coord : startedCores) {
+    auto loc = tileLocStr(coord.first, coord.second);
+    output << "__mlir_aie_try(XAie_CoreUnreset(" << deviceInstRef << ", "
+           << loc << "));\n";
+    output << "__mlir_aie_try(XAie_CoreEnable(" << deviceInstRef << ", " << loc
+           << "));\n";
+  }
+  output << "return XAIE_OK;\n";
+  output << "} // mlir_aie_reconfigure_start_cores\n\n";
+
+  output << "int mlir_aie_reconfigure(" << ctx_p << ") {\n";
+  output << "__mlir_aie_try(mlir_aie_reconfigure_stop_cores(ctx));\n";
+  for (auto &column : columns)
+    output << "__mlir_aie_try(mlir_aie_reconfigure_column_" << column.first
+           << "(ctx));\n";
+  output << "__mlir_aie_try(mlir_aie_reconfigure_start_cores(ctx));\n";
+  output << "return XAIE_OK;\n";
+  output << "} // mlir_aie_reconfigure\n";
+  return success();
+}
 } // namespace AIE
 } // namespace xilinx
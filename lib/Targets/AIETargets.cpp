@@ -19,6 +19,7 @@
 #include "mlir/IR/IRMapping.h"
 #include "mlir/IR/Location.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/Parser/Parser.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Target/LLVMIR/Export.h"
 #include "mlir/Target/LLVMIR/Import.h"
@@ -48,6 +49,15 @@ static llvm::cl::opt<int>
 static llvm::cl::opt<int>
     tileRow("tilerow", llvm::cl::desc("row coordinate of core to translate"),
             llvm::cl::init(0));
+static llvm::cl::opt<bool> configImageText(
+    "config-image-text",
+    llvm::cl::desc("print the records of the configuration image as text"),
+    llvm::cl::init(false));
+static llvm::cl::opt<std::string> xaieDiffBase(
+    "xaie-diff-base",
+    llvm::cl::desc("design configured on the device before the design to "
+                   "translate, for --aie-generate-xaie-diff"),
+    llvm::cl::init(""));
 
 llvm::json::Value attrToJSON(Attribute &attr) {
   if (auto a = attr.dyn_cast<StringAttr>()) {
@@ -537,9 +547,35 @@ SECTIONS
         return AIETranslateToXAIEV2(module, output);
       },
       registerDialects);
+  TranslateFromMLIRRegistration registrationXAIEDiff(
+      "aie-generate-xaie-diff",
+      "Generate the libxaie reconfiguration from the --xaie-diff-base design",
+      [](ModuleOp module, raw_ostream &output) -> LogicalResult {
+        if (xaieDiffBase.empty())
+          return module.emitOpError("expected a base design, see "
+                                    "--xaie-diff-base");
+        ParserConfig config(module.getContext());
+        OwningOpRef<ModuleOp> base =
+            parseSourceFile<ModuleOp>(xaieDiffBase, config);
+        if (!base)
+          return failure();
+        return AIETranslateToXAIEV2Diff(*base, module, output);
+      },
+      registerDialects);
+  TranslateFromMLIRRegistration registrationConfigImage(
+      "aie-generate-config-image",
+      "Generate a binary configuration image for the generic loader",
+      [](ModuleOp module, raw_ostream &output) {
+        return AIETranslateToConfigImage(module, output, configImageText);
+      },
+      registerDialects);
   TranslateFromMLIRRegistration registrationXJSON(
       "aie-flows-to-json", "Translate AIE flows to JSON", AIEFlowsToJSON,
       registerDialects);
+  TranslateFromMLIRRegistration registrationUtilization(
+      "aie-generate-utilization",
+      "Report the resources used in each tile as JSON",
+      AIETranslateToUtilizationJSON, registerDialects);
   TranslateFromMLIRRegistration registrationXPE(
       "aie-mlir-to-xpe", "Translate AIE design to XPE file for simulation",
       AIETranslateGraphXPE, registerDialects);
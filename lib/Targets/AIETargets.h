@@ -7,7 +7,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Region.h"
 #include "mlir/Support/LogicalResult.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace xilinx {
@@ -16,8 +18,23 @@ mlir::LogicalResult AIETranslateToXAIEV1(mlir::ModuleOp module,
                                          llvm::raw_ostream &output);
 mlir::LogicalResult AIETranslateToXAIEV2(mlir::ModuleOp module,
                                          llvm::raw_ostream &output);
+// Generate the libxaie code reconfiguring a device configured with the base
+// design to the design of module, writing only the tiles that differ.
+mlir::LogicalResult AIETranslateToXAIEV2Diff(mlir::ModuleOp base,
+                                             mlir::ModuleOp module,
+                                             llvm::raw_ostream &output);
+mlir::LogicalResult AIETranslateToConfigImage(mlir::ModuleOp module,
+                                              llvm::raw_ostream &output,
+                                              bool asText);
+// Return the BD number of each block with a BD in the body of a tile DMA, as
+// used by the libxaie configuration. The channels of a mem tile use even or
+// odd BDs depending on their parity.
+llvm::DenseMap<mlir::Block *, int> getBDNumbers(mlir::Region &body,
+                                                bool isMemTile);
 mlir::LogicalResult AIEFlowsToJSON(mlir::ModuleOp module,
                                    llvm::raw_ostream &output);
+mlir::LogicalResult AIETranslateToUtilizationJSON(mlir::ModuleOp module,
+                                                  llvm::raw_ostream &output);
 mlir::LogicalResult ADFGenerateCPPGraph(mlir::ModuleOp module,
                                         llvm::raw_ostream &output);
 mlir::LogicalResult AIETranslateSCSimConfig(mlir::ModuleOp module,
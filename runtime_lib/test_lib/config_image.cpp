@@ -0,0 +1,382 @@
+//===- config_image.cpp -----------------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+/// \file
+/// This file contains the generic loader of configuration images. Each record
+/// of an image is applied with the same libXAIE calls that aie_inc.cpp makes
+/// for it.
+
+#include "config_image.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct aie_config_image {
+  u32 arch;
+  u32 numCols, numRows, numMemTileRows;
+  std::vector<std::string> externalNames;
+  std::vector<u64> externalAddresses;
+  std::vector<bool> externalSet;
+  // the records, each a header word followed by its payload
+  std::vector<u32> records;
+};
+
+// The wrapper for the "if(call() != 0) return" pattern of aie_inc.cpp.
+#define __mlir_aie_config_try(x)                                               \
+  do {                                                                         \
+    AieRC RC = (x);                                                            \
+    if (RC != XAIE_OK) {                                                       \
+      printf("Configuration failed: %s returned %d.\n", #x, RC);               \
+      return RC;                                                               \
+    }                                                                          \
+  } while (0)
+
+// Return the number of words of the payload of a record before its variable
+// part, or zero for an unknown record.
+static u32 fixedPayloadSize(u32 type) {
+  switch (type) {
+  case AIE_CONFIG_CORE_RESET:
+    return 3;
+  case AIE_CONFIG_LOAD_ELF:
+    return 3;
+  case AIE_CONFIG_CORE_ENABLE:
+    return 2;
+  case AIE_CONFIG_BD:
+    return 15;
+  case AIE_CONFIG_DMA_START:
+    return 5;
+  case AIE_CONFIG_LOCK_INIT:
+    return 4;
+  case AIE_CONFIG_CONNECT:
+    return 6;
+  case AIE_CONFIG_PACKET_MASTER:
+    return 7;
+  case AIE_CONFIG_PACKET_SLAVE:
+    return 9;
+  case AIE_CONFIG_SHIM_MUX:
+    return 4;
+  default:
+    return 0;
+  }
+}
+
+// Read a string stored as its length in bytes and its characters padded to
+// words. Returns false if it does not fit in the remaining words.
+static bool readString(const u32 *words, size_t numWords, std::string &str,
+                       size_t &used) {
+  if (numWords < 1)
+    return false;
+  u32 length = words[0];
+  size_t lengthWords = (static_cast<size_t>(length) + 3) / 4;
+  if (lengthWords > numWords - 1)
+    return false;
+  str.resize(length);
+  for (u32 i = 0; i < length; i++)
+    str[i] = static_cast<char>((words[1 + i / 4] >> (8 * (i % 4))) & 0xff);
+  used = 1 + lengthWords;
+  return true;
+}
+
+/// @brief Read a configuration image from memory. The data is copied.
+/// @param data The contents of the image
+/// @param size The size of the image in bytes
+/// @return The image, or NULL if the data is not a valid image
+aie_config_image_t *mlir_aie_config_image_from_memory(const void *data,
+                                                      size_t size) {
+  if (size % 4 != 0 || size / 4 < AIE_CONFIG_IMAGE_HEADER_WORDS) {
+    printf("Invalid configuration image size %zu.\n", size);
+    return NULL;
+  }
+  // Images are little-endian, whatever the host.
+  size_t numWords = size / 4;
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  std::vector<u32> words(numWords);
+  for (size_t i = 0; i < numWords; i++)
+    words[i] = bytes[4 * i] | bytes[4 * i + 1] << 8 | bytes[4 * i + 2] << 16 |
+               static_cast<u32>(bytes[4 * i + 3]) << 24;
+
+  if (words[0] != AIE_CONFIG_IMAGE_MAGIC) {
+    printf("Not a configuration image.\n");
+    return NULL;
+  }
+  if (words[1] != AIE_CONFIG_IMAGE_VERSION) {
+    printf("Unsupported configuration image version %u.\n", words[1]);
+    return NULL;
+  }
+
+  aie_config_image_t *image = new aie_config_image_t;
+  image->arch = words[2];
+  image->numCols = words[3];
+  image->numRows = words[4];
+  image->numMemTileRows = words[5];
+  u32 numExternalBuffers = words[6];
+  u32 numRecords = words[7];
+
+  size_t pos = AIE_CONFIG_IMAGE_HEADER_WORDS;
+  for (u32 i = 0; i < numExternalBuffers; i++) {
+    std::string name;
+    size_t used;
+    if (!readString(&words[pos], numWords - pos, name, used)) {
+      printf("Truncated configuration image.\n");
+      delete image;
+      return NULL;
+    }
+    image->externalNames.push_back(name);
+    pos += used;
+  }
+  image->externalAddresses.assign(numExternalBuffers, 0);
+  image->externalSet.assign(numExternalBuffers, false);
+
+  // Check that all records fit in the image, so that they can be applied
+  // without further checks.
+  size_t start = pos;
+  for (u32 i = 0; i < numRecords; i++) {
+    if (pos >= numWords) {
+      printf("Truncated configuration image.\n");
+      delete image;
+      return NULL;
+    }
+    u32 type = (words[pos] >> 16) & 0xff;
+    size_t payloadSize = words[pos] & 0xffff;
+    u32 fixedSize = fixedPayloadSize(type);
+    bool valid = fixedSize != 0 && payloadSize >= fixedSize &&
+                 payloadSize <= numWords - pos - 1;
+    if (valid && type == AIE_CONFIG_BD)
+      valid = payloadSize == fixedSize + 2 * size_t(words[pos + 15]);
+    if (valid && type == AIE_CONFIG_BD &&
+        (words[pos + 4] & AIE_CONFIG_BD_EXTERNAL))
+      valid = words[pos + 14] < numExternalBuffers;
+    if (valid && type == AIE_CONFIG_LOAD_ELF)
+      valid = payloadSize == fixedSize + (size_t(words[pos + 3]) + 3) / 4;
+    if (!valid) {
+      printf("Invalid record %u in configuration image.\n", i);
+      delete image;
+      return NULL;
+    }
+    pos += 1 + payloadSize;
+  }
+  image->records.assign(words.begin() + start, words.begin() + pos);
+  return image;
+}
+
+/// @brief Read a configuration image from a file.
+/// @param path The file written by aie-translate --aie-generate-config-image
+/// @return The image, or NULL if the file cannot be read or is not a valid
+/// image
+aie_config_image_t *mlir_aie_config_image_load(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    printf("Failed to open configuration image %s.\n", path);
+    return NULL;
+  }
+  std::vector<char> data;
+  char chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    data.insert(data.end(), chunk, chunk + n);
+  fclose(file);
+  return mlir_aie_config_image_from_memory(data.data(), data.size());
+}
+
+void mlir_aie_config_image_free(aie_config_image_t *image) { delete image; }
+
+/// @brief Allocate a libXAIE context for the device the image was generated
+/// for, like mlir_aie_init_libxaie in aie_inc.cpp.
+/// @param image The image
+/// @return A pointer to the context
+aie_libxaie_ctx_t *
+mlir_aie_config_image_init_libxaie(const aie_config_image_t *image) {
+  aie_libxaie_ctx_t *ctx = new aie_libxaie_ctx_t;
+  if (!ctx)
+    return 0;
+  bool isAIE1 = image->arch == 1;
+  ctx->AieConfigPtr.AieGen = isAIE1 ? XAIE_DEV_GEN_AIE : XAIE_DEV_GEN_AIEML;
+  ctx->AieConfigPtr.BaseAddr = 0x20000000000;
+  ctx->AieConfigPtr.ColShift = isAIE1 ? 23 : 25;
+  ctx->AieConfigPtr.RowShift = isAIE1 ? 18 : 20;
+  ctx->AieConfigPtr.NumRows = image->numRows;
+  ctx->AieConfigPtr.NumCols = image->numCols;
+  ctx->AieConfigPtr.ShimRowNum = 0;
+  ctx->AieConfigPtr.MemTileRowStart = 1;
+  ctx->AieConfigPtr.MemTileNumRows = image->numMemTileRows;
+  ctx->AieConfigPtr.AieTileRowStart = 1 + image->numMemTileRows;
+  ctx->AieConfigPtr.AieTileNumRows =
+      image->numRows - 1 - image->numMemTileRows;
+  ctx->AieConfigPtr.PartProp = {0};
+  ctx->DevInst = {0};
+  return ctx;
+}
+
+/// @brief Set the device address of an external buffer transferred by the
+/// shim DMAs, like mlir_aie_external_set_addr_<name> in aie_inc.cpp.
+/// @param image The image
+/// @param name The name of the external buffer
+/// @param address The device address of the buffer
+/// @return Zero on success, non-zero if the image has no such buffer
+int mlir_aie_config_image_set_external_addr(aie_config_image_t *image,
+                                            const char *name, u64 address) {
+  for (size_t i = 0; i < image->externalNames.size(); i++) {
+    if (image->externalNames[i] != name)
+      continue;
+    image->externalAddresses[i] = address;
+    image->externalSet[i] = true;
+    return 0;
+  }
+  printf("No external buffer %s in the configuration image.\n", name);
+  return 1;
+}
+
+static AieRC applyBd(XAie_DevInst *devInst, XAie_LocType loc, const u32 *p,
+                     const aie_config_image_t *image) {
+  u32 bdNum = p[2];
+  u32 flags = p[3];
+  XAie_DmaDesc desc;
+  __mlir_aie_config_try(XAie_DmaDescInit(devInst, &desc, loc));
+  if (flags & (AIE_CONFIG_BD_ACQUIRE | AIE_CONFIG_BD_RELEASE)) {
+    __mlir_aie_config_try(XAie_DmaSetLock(
+        &desc, XAie_LockInit(p[4], static_cast<s32>(p[5])),
+        XAie_LockInit(p[6], static_cast<s32>(p[7]))));
+    if (!(flags & AIE_CONFIG_BD_ACQUIRE))
+      desc.LockDesc.LockAcqEn = XAIE_DISABLE;
+    if (!(flags & AIE_CONFIG_BD_RELEASE))
+      desc.LockDesc.LockRelEn = XAIE_DISABLE;
+  }
+
+  u64 address = p[8];
+  u32 length = p[9];
+  if (flags & AIE_CONFIG_BD_EXTERNAL) {
+    u32 id = p[13];
+    if (!image->externalSet[id]) {
+      printf("External buffer %s has no address.\n",
+             image->externalNames[id].c_str());
+      return XAIE_INVALID_ARGS;
+    }
+    address += image->externalAddresses[id];
+  }
+
+  u32 numDims = p[14];
+  // the dimensions must outlive the descriptor until it is written
+  std::vector<XAie_DmaDimDesc> dims(numDims);
+  if (numDims == 0) {
+    __mlir_aie_config_try(XAie_DmaSetAddrLen(&desc, address, length));
+    if (flags & AIE_CONFIG_BD_EXTERNAL)
+      __mlir_aie_config_try(XAie_DmaSetAxi(&desc, /* smid */ 0,
+                                           /* burstlen */ 4, /* QoS */ 0,
+                                           /* Cache */ 0, XAIE_ENABLE));
+  } else {
+    for (u32 i = 0; i < numDims; i++)
+      dims[i].AieMlDimDesc = {/* StepSize */ p[15 + 2 * i],
+                              /* Wrap */ p[16 + 2 * i]};
+    XAie_DmaTensor tensor = {};
+    tensor.NumDim = numDims;
+    tensor.Dim = dims.data();
+    __mlir_aie_config_try(
+        XAie_DmaSetMultiDimAddr(&desc, &tensor, address, length));
+  }
+
+  if (flags & AIE_CONFIG_BD_NEXT)
+    __mlir_aie_config_try(XAie_DmaSetNextBd(
+        &desc, p[10], (flags & AIE_CONFIG_BD_ENABLE_NEXT) ? 1 : 0));
+  if (flags & AIE_CONFIG_BD_PACKET)
+    __mlir_aie_config_try(XAie_DmaSetPkt(&desc, XAie_PacketInit(p[11], p[12])));
+  __mlir_aie_config_try(XAie_DmaEnableBd(&desc));
+  __mlir_aie_config_try(XAie_DmaWriteBd(devInst, &desc, loc, bdNum));
+  return XAIE_OK;
+}
+
+static AieRC applyRecord(aie_libxaie_ctx_t *ctx, u32 type, const u32 *p,
+                         const aie_config_image_t *image) {
+  XAie_DevInst *devInst = &(ctx->DevInst);
+  XAie_LocType loc = XAie_TileLoc(p[0], p[1]);
+  switch (type) {
+  case AIE_CONFIG_CORE_RESET:
+    __mlir_aie_config_try(XAie_CoreReset(devInst, loc));
+    __mlir_aie_config_try(XAie_CoreDisable(devInst, loc));
+    // Release locks
+    for (u32 l = 0; l < p[2]; ++l)
+      __mlir_aie_config_try(
+          XAie_LockRelease(devInst, loc, XAie_LockInit(l, 0x0), 0));
+    return XAIE_OK;
+  case AIE_CONFIG_LOAD_ELF: {
+    // the characters are stored little-endian in each word
+    std::string fileName(p[2], '\0');
+    for (u32 i = 0; i < p[2]; i++)
+      fileName[i] = static_cast<char>((p[3 + i / 4] >> (8 * (i % 4))) & 0xff);
+    AieRC RC = XAie_LoadElf(devInst, loc, fileName.c_str(), 0);
+    if (RC != XAIE_OK)
+      printf("Failed to load elf for Core[%u,%u], ret is %d\n", p[0], p[1],
+             RC);
+    return RC;
+  }
+  case AIE_CONFIG_CORE_ENABLE:
+    __mlir_aie_config_try(XAie_CoreUnreset(devInst, loc));
+    __mlir_aie_config_try(XAie_CoreEnable(devInst, loc));
+    return XAIE_OK;
+  case AIE_CONFIG_BD:
+    return applyBd(devInst, loc, p, image);
+  case AIE_CONFIG_DMA_START: {
+    XAie_DmaDirection dir = p[3] ? DMA_MM2S : DMA_S2MM;
+    __mlir_aie_config_try(
+        XAie_DmaChannelPushBdToQueue(devInst, loc, p[2], dir, p[4]));
+    __mlir_aie_config_try(XAie_DmaChannelEnable(devInst, loc, p[2], dir));
+    return XAIE_OK;
+  }
+  case AIE_CONFIG_LOCK_INIT:
+    return XAie_LockSetValue(devInst, loc,
+                             XAie_LockInit(p[2], static_cast<s32>(p[3])));
+  case AIE_CONFIG_CONNECT:
+    return XAie_StrmConnCctEnable(devInst, loc,
+                                  static_cast<StrmSwPortType>(p[2]), p[3],
+                                  static_cast<StrmSwPortType>(p[4]), p[5]);
+  case AIE_CONFIG_PACKET_MASTER:
+    return XAie_StrmPktSwMstrPortEnable(
+        devInst, loc, static_cast<StrmSwPortType>(p[2]), p[3],
+        p[4] ? XAIE_SS_PKT_DROP_HEADER : XAIE_SS_PKT_DONOT_DROP_HEADER, p[5],
+        p[6]);
+  case AIE_CONFIG_PACKET_SLAVE: {
+    StrmSwPortType port = static_cast<StrmSwPortType>(p[2]);
+    __mlir_aie_config_try(
+        XAie_StrmPktSwSlavePortEnable(devInst, loc, port, p[3]));
+    __mlir_aie_config_try(XAie_StrmPktSwSlaveSlotEnable(
+        devInst, loc, port, p[3], p[4], XAie_PacketInit(p[5], /*type*/ 0),
+        p[6], p[7], p[8]));
+    return XAIE_OK;
+  }
+  case AIE_CONFIG_SHIM_MUX:
+    if (p[2] == 0)
+      return XAie_EnableAieToShimDmaStrmPort(devInst, loc, p[3]);
+    return XAie_EnableShimDmaToAieStrmPort(devInst, loc, p[3]);
+  default:
+    return XAIE_INVALID_ARGS;
+  }
+}
+
+/// @brief Apply the records of some sections of an image to the device.
+/// @param ctx The context
+/// @param image The image
+/// @param sections A mask of aie_config_section values
+/// @return Zero on success, non-zero if a libXAIE call fails
+int mlir_aie_config_image_apply(aie_libxaie_ctx_t *ctx,
+                                const aie_config_image_t *image,
+                                unsigned sections) {
+  const std::vector<u32> &records = image->records;
+  for (size_t pos = 0; pos < records.size();
+       pos += 1 + (records[pos] & 0xffff)) {
+    u32 section = records[pos] >> 24;
+    u32 type = (records[pos] >> 16) & 0xff;
+    if (!(section & sections))
+      continue;
+    AieRC RC = applyRecord(ctx, type, &records[pos + 1], image);
+    if (RC != XAIE_OK)
+      return RC;
+  }
+  return XAIE_OK;
+}
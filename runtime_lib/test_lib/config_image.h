@@ -0,0 +1,83 @@
+//===- config_image.h -------------------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+/// \file
+/// Generic loader for the configuration images generated by
+/// aie-translate --aie-generate-config-image. Instead of compiling the
+/// aie_inc.cpp of each design into the host program, a host program linked
+/// with this loader can configure any design from its image:
+///
+///   aie_config_image_t *image = mlir_aie_config_image_load("aie_config.bin");
+///   aie_libxaie_ctx_t *ctx = mlir_aie_config_image_init_libxaie(image);
+///   mlir_aie_init_device(ctx);
+///   mlir_aie_config_image_apply(ctx, image, AIE_CONFIG_CORES);
+///   mlir_aie_config_image_apply(ctx, image, AIE_CONFIG_SWITCHBOXES);
+///   mlir_aie_config_image_apply(ctx, image, AIE_CONFIG_LOCKS);
+///   mlir_aie_config_image_apply(ctx, image, AIE_CONFIG_DMAS);
+///   mlir_aie_config_image_apply(ctx, image, AIE_CONFIG_START_CORES);
+///
+/// The sections are the counterparts of the functions of aie_inc.cpp, so
+/// they can be applied in the same order as these functions are called.
+
+#ifndef AIE_CONFIG_IMAGE_H
+#define AIE_CONFIG_IMAGE_H
+
+#include "config_image_format.h"
+#include "target.h"
+#include <stddef.h>
+
+extern "C" {
+
+typedef struct aie_config_image aie_config_image_t;
+
+/// @brief Read a configuration image from a file.
+/// @param path The file written by aie-translate --aie-generate-config-image
+/// @return The image, or NULL if the file cannot be read or is not a valid
+/// image
+aie_config_image_t *mlir_aie_config_image_load(const char *path);
+
+/// @brief Read a configuration image from memory. The data is copied.
+/// @param data The contents of the image
+/// @param size The size of the image in bytes
+/// @return The image, or NULL if the data is not a valid image
+aie_config_image_t *mlir_aie_config_image_from_memory(const void *data,
+                                                      size_t size);
+
+void mlir_aie_config_image_free(aie_config_image_t *image);
+
+/// @brief Allocate a libXAIE context for the device the image was generated
+/// for, like mlir_aie_init_libxaie in aie_inc.cpp.
+/// @param image The image
+/// @return A pointer to the context
+aie_libxaie_ctx_t *
+mlir_aie_config_image_init_libxaie(const aie_config_image_t *image);
+
+/// @brief Set the device address of an external buffer transferred by the
+/// shim DMAs, like mlir_aie_external_set_addr_<name> in aie_inc.cpp.
+/// @param image The image
+/// @param name The name of the external buffer
+/// @param address The device address of the buffer, e.g. from
+/// mlir_aie_get_device_address
+/// @return Zero on success, non-zero if the image has no such buffer
+int mlir_aie_config_image_set_external_addr(aie_config_image_t *image,
+                                            const char *name, u64 address);
+
+/// @brief Apply the records of some sections of an image to the device.
+/// @param ctx The context
+/// @param image The image
+/// @param sections A mask of aie_config_section values
+/// @return Zero on success, non-zero if a libXAIE call fails
+int mlir_aie_config_image_apply(aie_libxaie_ctx_t *ctx,
+                                const aie_config_image_t *image,
+                                unsigned sections);
+
+} // extern "C"
+
+#endif
@@ -0,0 +1,95 @@
+//===- config_image_format.h ------------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+/// \file
+/// Layout of the configuration images generated by
+/// aie-translate --aie-generate-config-image and applied by the loader in
+/// config_image.h. This header has no dependencies so that it can be shared by
+/// the compiler and the runtime.
+///
+/// An image is a sequence of little-endian 32-bit words:
+///   - a header of AIE_CONFIG_IMAGE_HEADER_WORDS words: magic, version, target
+///     architecture (1: AIE1, 2: AIE2), number of columns, rows and mem tile
+///     rows of the device, number of external buffers and number of records,
+///   - the name of each external buffer, as its length in bytes followed by
+///     its characters padded with zeros to a whole number of words,
+///   - the records, each a word (section << 24 | type << 16 | payload words)
+///     followed by its payload.
+/// The payload of each record type is listed with the type below; every field
+/// is one word and col, row are the coordinates of the tile it configures.
+
+#ifndef AIE_CONFIG_IMAGE_FORMAT_H
+#define AIE_CONFIG_IMAGE_FORMAT_H
+
+#define AIE_CONFIG_IMAGE_MAGIC 0x43454941u // "AIEC"
+#define AIE_CONFIG_IMAGE_VERSION 1u
+#define AIE_CONFIG_IMAGE_HEADER_WORDS 8u
+
+// Sections of an image, applied separately like the functions of the
+// generated libxaie configuration.
+enum aie_config_section {
+  AIE_CONFIG_CORES = 0x1,       // mlir_aie_configure_cores
+  AIE_CONFIG_START_CORES = 0x2, // mlir_aie_start_cores
+  AIE_CONFIG_DMAS = 0x4,        // mlir_aie_configure_dmas
+  AIE_CONFIG_SHIM_DMAS = 0x8,   // mlir_aie_configure_shimdma_*
+  AIE_CONFIG_LOCKS = 0x10,      // mlir_aie_initialize_locks
+  AIE_CONFIG_SWITCHBOXES = 0x20 // mlir_aie_configure_switchboxes
+};
+
+enum aie_config_record {
+  // col, row, number of locks to release
+  AIE_CONFIG_CORE_RESET = 1,
+  // col, row, length of the file name in bytes, file name padded to words
+  AIE_CONFIG_LOAD_ELF = 2,
+  // col, row
+  AIE_CONFIG_CORE_ENABLE = 3,
+  // col, row, bd, flags, acquire lock, acquire value (negative for
+  // acquire greater equal), release lock, release value, address (offset in
+  // the external buffer with AIE_CONFIG_BD_EXTERNAL), length in bytes,
+  // next bd, packet ID, packet type, external buffer, number of dimensions,
+  // then a step size and a wrap for each dimension, innermost first
+  AIE_CONFIG_BD = 4,
+  // col, row, channel, direction (0: S2MM, 1: MM2S), first bd
+  AIE_CONFIG_DMA_START = 5,
+  // col, row, lock, value
+  AIE_CONFIG_LOCK_INIT = 6,
+  // col, row, source port type, source channel, dest port type, dest channel
+  AIE_CONFIG_CONNECT = 7,
+  // col, row, port type, channel, drop header, arbiter, msel mask
+  AIE_CONFIG_PACKET_MASTER = 8,
+  // col, row, port type, channel, slot, packet ID, mask, msel, arbiter
+  AIE_CONFIG_PACKET_SLAVE = 9,
+  // col, row, direction (0: AIE to shim DMA, 1: shim DMA to AIE), port
+  AIE_CONFIG_SHIM_MUX = 10
+};
+
+enum aie_config_bd_flags {
+  AIE_CONFIG_BD_ACQUIRE = 0x1,
+  AIE_CONFIG_BD_RELEASE = 0x2,
+  AIE_CONFIG_BD_NEXT = 0x4,        // the next bd is set
+  AIE_CONFIG_BD_ENABLE_NEXT = 0x8, // and enabled
+  AIE_CONFIG_BD_PACKET = 0x10,
+  AIE_CONFIG_BD_EXTERNAL = 0x20 // the bd transfers an external buffer
+};
+
+// Stream switch port types, in the order of StrmSwPortType in libxaie.
+enum aie_config_port {
+  AIE_CONFIG_PORT_CORE = 0,
+  AIE_CONFIG_PORT_DMA = 1,
+  AIE_CONFIG_PORT_CTRL = 2,
+  AIE_CONFIG_PORT_FIFO = 3,
+  AIE_CONFIG_PORT_SOUTH = 4,
+  AIE_CONFIG_PORT_WEST = 5,
+  AIE_CONFIG_PORT_NORTH = 6,
+  AIE_CONFIG_PORT_EAST = 7,
+  AIE_CONFIG_PORT_TRACE = 8
+};
+
+#endif
@@ -17,9 +17,12 @@
 #include "test_library.h"
 #include "math.h"
 #include <assert.h>
+#include <atomic>
 #include <fcntl.h>
 #include <stdio.h>
 #include <sys/mman.h>
+#include <thread>
+#include <vector>
 
 // extern "C" {
 // extern aie_libxaie_ctx_t *ctx /* = nullptr*/;
@@ -128,6 +131,169 @@ void mlir_aie_write32(aie_libxaie_ctx_t *ctx, u64 addr, u32 val) {
   XAie_Write32(&(ctx->DevInst), addr, val);
 }
 
+/// @brief Record the register writes of the calling thread into a transaction
+/// instead of issuing them one at a time, until mlir_aie_submit_transaction.
+/// @param ctx The context
+/// @return Zero on success
+int mlir_aie_start_transaction(aie_libxaie_ctx_t *ctx) {
+  AieRC RC = XAie_StartTransaction(&(ctx->DevInst),
+                                   XAIE_TRANSACTION_DISABLE_AUTO_FLUSH);
+  if (RC != XAIE_OK) {
+    printf("Failed to start transaction.\n");
+    return -1;
+  }
+  return 0;
+}
+
+// Timeout of the polls replayed from a transaction, which does not record it.
+#define MLIR_AIE_TRANSACTION_POLL_TIMEOUT 1000
+
+static bool mlir_aie_is_replayable(const XAie_TxnCmd *cmd) {
+  switch (cmd->Opcode) {
+  case XAIE_IO_WRITE:
+  case XAIE_IO_BLOCKWRITE:
+  case XAIE_IO_BLOCKSET:
+  case XAIE_IO_MASKWRITE:
+  case XAIE_IO_MASKPOLL:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// @brief Issue the register writes recorded since mlir_aie_start_transaction.
+/// Consecutive writes to contiguous addresses are merged into a single block
+/// write. The order of the writes is otherwise preserved: the DMA queues and
+/// the locks have side effects, so the writes cannot be sorted by address.
+/// @param ctx The context
+/// @param stats If not NULL, filled with the number of recorded and submitted
+/// operations, to compare the transaction with the unbatched writes.
+/// @return Zero on success
+int mlir_aie_submit_transaction(aie_libxaie_ctx_t *ctx,
+                                struct mlir_aie_transaction_stats *stats) {
+  XAie_DevInst *devInst = &(ctx->DevInst);
+  XAie_TxnInst *txn = XAie_ExportTransactionInstance(devInst);
+  if (!txn) {
+    printf("Failed to export transaction.\n");
+    return -1;
+  }
+
+  bool replayable = true;
+  for (u32 i = 0; i < txn->NumCmds; i++)
+    replayable &= mlir_aie_is_replayable(&txn->CmdBuf[i]);
+
+  u32 submitted = 0, writes = 0;
+  AieRC RC;
+  if (!replayable) {
+    // Commands other than register accesses, let libXAIE submit them as they
+    // were recorded.
+    RC = XAie_SubmitTransaction(devInst, NULL);
+    submitted = txn->NumCmds;
+  } else {
+    // End the transaction of the thread without issuing anything, then issue
+    // the exported copy directly.
+    RC = XAie_ClearTransaction(devInst);
+    if (RC == XAIE_OK)
+      RC = XAie_SubmitTransaction(devInst, NULL);
+
+    std::vector<u32> block;
+    for (u32 i = 0; i < txn->NumCmds && RC == XAIE_OK; submitted++) {
+      const XAie_TxnCmd *cmd = &txn->CmdBuf[i];
+      if (cmd->Opcode == XAIE_IO_WRITE || cmd->Opcode == XAIE_IO_BLOCKWRITE) {
+        // Collect the writes that continue at the next address.
+        u64 base = cmd->RegOff;
+        block.clear();
+        for (; i < txn->NumCmds; i++) {
+          const XAie_TxnCmd *next = &txn->CmdBuf[i];
+          if (next->RegOff != base + 4 * block.size())
+            break;
+          if (next->Opcode == XAIE_IO_WRITE) {
+            block.push_back(next->Value);
+          } else if (next->Opcode == XAIE_IO_BLOCKWRITE) {
+            const u32 *data = (const u32 *)(uintptr_t)next->DataPtr;
+            block.insert(block.end(), data, data + next->Size);
+          } else {
+            break;
+          }
+        }
+        if (block.size() == 1)
+          RC = XAie_Write32(devInst, base, block[0]);
+        else
+          RC = XAie_BlockWrite32(devInst, base, block.data(), block.size());
+        writes += block.size();
+        continue;
+      }
+
+      if (cmd->Opcode == XAIE_IO_BLOCKSET) {
+        RC = XAie_BlockSet32(devInst, cmd->RegOff, cmd->Value, cmd->Size);
+        writes += cmd->Size;
+      } else if (cmd->Opcode == XAIE_IO_MASKWRITE) {
+        RC = XAie_MaskWrite32(devInst, cmd->RegOff, cmd->Mask, cmd->Value);
+        writes++;
+      } else {
+        RC = XAie_MaskPoll(devInst, cmd->RegOff, cmd->Mask, cmd->Value,
+                           MLIR_AIE_TRANSACTION_POLL_TIMEOUT);
+      }
+      i++;
+    }
+  }
+
+  if (stats) {
+    stats->recorded = txn->NumCmds;
+    stats->submitted = submitted;
+    stats->writes = writes;
+  }
+  XAie_FreeTransactionInstance(txn);
+  if (RC != XAIE_OK) {
+    printf("Failed to submit transaction.\n");
+    return -1;
+  }
+  return 0;
+}
+
+/// @brief Configure the columns of the device concurrently. Each phase is
+/// applied to all the columns, spread over a pool of threads, before the next
+/// phase starts, so that the device ends up configured as by calling the
+/// serial functions of each phase in order.
+/// @param ctx The context
+/// @param phases The functions configuring one column, in order
+/// @param numPhases The number of phases
+/// @param columns The columns to configure
+/// @param numColumns The number of columns
+/// @param numThreads The number of threads, including the calling thread
+/// @return Zero on success, otherwise the error of the first failing column
+int mlir_aie_configure_columns(aie_libxaie_ctx_t *ctx,
+                               const mlir_aie_column_fn *phases, int numPhases,
+                               const int *columns, int numColumns,
+                               int numThreads) {
+  if (numThreads > numColumns)
+    numThreads = numColumns;
+  for (int phase = 0; phase < numPhases; phase++) {
+    std::atomic<int> next(0);
+    std::atomic<int> result(0);
+    // Each thread takes the next column until all are configured.
+    auto worker = [&]() {
+      for (int i = next++; i < numColumns; i = next++) {
+        int rc = phases[phase](ctx, columns[i]);
+        int ok = 0;
+        if (rc != 0)
+          result.compare_exchange_strong(ok, rc);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < numThreads; t++)
+      threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+      thread.join();
+    if (result != 0) {
+      printf("Failed to configure phase %d of the columns.\n", phase);
+      return result;
+    }
+  }
+  return 0;
+}
+
 /// @brief Read a value from the data memory of a particular tile memory
 /// @param addr The address in the given tile.
 /// @return The data
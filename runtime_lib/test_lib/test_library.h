@@ -122,6 +122,26 @@ int mlir_aie_release_lock(aie_libxaie_ctx_t *ctx, int col, int row, int lockid,
                           int lockval, int timeout);
 u32 mlir_aie_read32(aie_libxaie_ctx_t *ctx, u64 addr);
 void mlir_aie_write32(aie_libxaie_ctx_t *ctx, u64 addr, u32 val);
+
+/// Counts of the register operations of a transaction.
+struct mlir_aie_transaction_stats {
+  u32 recorded;  // Operations recorded by libXAIE
+  u32 submitted; // Operations submitted after coalescing
+  u32 writes;    // 32-bit words written by the submitted operations
+};
+
+int mlir_aie_start_transaction(aie_libxaie_ctx_t *ctx);
+int mlir_aie_submit_transaction(aie_libxaie_ctx_t *ctx,
+                                struct mlir_aie_transaction_stats *stats);
+
+/// A function configuring the tiles of one column, like the
+/// mlir_aie_*_column functions generated in aie_inc.cpp.
+typedef int (*mlir_aie_column_fn)(aie_libxaie_ctx_t *ctx, int col);
+
+int mlir_aie_configure_columns(aie_libxaie_ctx_t *ctx,
+                               const mlir_aie_column_fn *phases, int numPhases,
+                               const int *columns, int numColumns,
+                               int numThreads);
 u32 mlir_aie_data_mem_rd_word(aie_libxaie_ctx_t *ctx, int col, int row,
                               u64 addr);
 void mlir_aie_data_mem_wr_word(aie_libxaie_ctx_t *ctx, int col, int row,
@@ -0,0 +1,58 @@
+//===- config_image.mlir ---------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-translate --aie-generate-config-image --config-image-text %s | FileCheck %s
+// RUN: aie-translate --aie-generate-config-image %s | od -An -tx4 -N8 | FileCheck --check-prefix=BINARY %s
+
+// CHECK: image AIE2
+// CHECK-NEXT: cores core_reset 7 3 16
+// CHECK-NEXT: cores core_reset 7 4 16
+// CHECK-NEXT: cores load_elf 7 4 custom_7_4.elf
+// CHECK-NEXT: start_cores core_enable 7 3
+// CHECK-NEXT: start_cores core_enable 7 4
+// CHECK-NEXT: dmas bd 7 4 0 31 3 -1 4 1 1024 512 1 5 2 0 0
+// CHECK-NEXT: dmas bd 7 4 1 4 0 0 0 0 1536 512 0 0 0 0 0
+// CHECK-NEXT: dmas dma_start 7 4 0 1 0
+// CHECK-NEXT: locks lock_init 7 4 3 2
+// CHECK-NEXT: switchboxes connect 7 4 1 0 4 1
+
+// BINARY: 43454941 00000001
+
+module @aie_module {
+  AIE.device(xcve2802) {
+    %t73 = AIE.tile(7, 3)
+    %t74 = AIE.tile(7, 4)
+
+    %buf = AIE.buffer(%t74) {address = 1024 : i32, sym_name = "buf"} : memref<256xi32>
+    %lock1 = AIE.lock(%t74, 3) { init = 2 : i32 }
+    %lock2 = AIE.lock(%t74, 4)
+
+    %sb74 = AIE.switchbox(%t74) {
+      AIE.connect<DMA : 0, South : 1>
+    }
+
+    %m74 = AIE.mem(%t74) {
+        %srcDma = AIE.dmaStart("MM2S", 0, ^bd0, ^end)
+      ^bd0:
+        AIE.useLock(%lock1, AcquireGreaterEqual, 1)
+        AIE.dmaBdPacket(2, 5)
+        AIE.dmaBd(<%buf : memref<256xi32>, 0, 128>, 0)
+        AIE.useLock(%lock2, Release, 1)
+        AIE.nextBd ^bd1
+      ^bd1:
+        AIE.dmaBd(<%buf : memref<256xi32>, 128, 128>, 0)
+        AIE.nextBd ^end
+      ^end:
+        AIE.end
+    }
+
+    %c74 = AIE.core(%t74) { AIE.end } { elf_file = "custom_7_4.elf" }
+  }
+}
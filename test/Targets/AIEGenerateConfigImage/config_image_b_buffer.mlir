@@ -0,0 +1,32 @@
+//===- config_image_b_buffer.mlir ------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: not aie-translate --aie-generate-config-image --config-image-text %s |& FileCheck %s
+
+// CHECK: error: 'AIE.dmaBd' op B buffers cannot be used in a configuration image
+
+module @config_image_b_buffer {
+  AIE.device(xcvc1902) {
+    %t73 = AIE.tile(7, 3)
+    %buf = AIE.buffer(%t73) {address = 4096 : i32, sym_name = "buf"} : memref<16xi32>
+    %lock = AIE.lock(%t73, 0)
+
+    %mem73 = AIE.mem(%t73) {
+      %dma = AIE.dmaStart(S2MM, 0, ^bd0, ^end)
+    ^bd0:
+      AIE.useLock(%lock, Acquire, 0)
+      AIE.dmaBd(<%buf : memref<16xi32>, 0, 16>, 1)
+      AIE.useLock(%lock, Release, 1)
+      AIE.nextBd ^bd0
+    ^end:
+      AIE.end
+    }
+  }
+}
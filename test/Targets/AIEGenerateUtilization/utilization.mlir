@@ -0,0 +1,83 @@
+//===- utilization.mlir ----------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-translate --aie-generate-utilization %s | FileCheck %s
+
+// The objectFifo "of" could grow by 14 elements: the memory has room for 29
+// more, but only 14 locks and 14 BDs are left.
+
+// CHECK: "device": "xcvc1902",
+// CHECK: "bds": {
+// CHECK-NEXT: "available": 16,
+// CHECK-NEXT: "used": 2
+// CHECK: "col": 3,
+// CHECK: "dma_channels": {
+// CHECK-NEXT: "mm2s": 0,
+// CHECK-NEXT: "s2mm": 1
+// CHECK: "locks": {
+// CHECK-NEXT: "available": 16,
+// CHECK-NEXT: "used": 2
+// CHECK: "memory": {
+// CHECK-NEXT: "buffers": 2048,
+// CHECK-NEXT: "free": 29696,
+// CHECK-NEXT: "size": 32768,
+// CHECK-NEXT: "stack": 1024,
+// CHECK-NEXT: "used": 3072
+// CHECK: "objectfifos": [
+// CHECK-NEXT: {
+// CHECK-NEXT: "depth": 2,
+// CHECK-NEXT: "element_size": 1024,
+// CHECK-NEXT: "extra_depth": 14,
+// CHECK-NEXT: "name": "of"
+// CHECK: "row": 3,
+// CHECK: "switchbox": {
+// CHECK: "DMA": {
+// CHECK-NEXT: "masters": {
+// CHECK-NEXT: "available": 2,
+// CHECK-NEXT: "used": 1
+// CHECK: "South": {
+// CHECK: "slaves": {
+// CHECK-NEXT: "available": 6,
+// CHECK-NEXT: "used": 1
+// CHECK: "type": "core"
+
+module @utilization {
+ AIE.device(xcvc1902) {
+  %t33 = AIE.tile(3, 3)
+  %buf0 = AIE.buffer(%t33) {address = 1024 : i32, sym_name = "of_buff_0"} : memref<256xi32>
+  %buf1 = AIE.buffer(%t33) {address = 2048 : i32, sym_name = "of_buff_1"} : memref<256xi32>
+  %lock0 = AIE.lock(%t33, 0)
+  %lock1 = AIE.lock(%t33, 1)
+
+  %m33 = AIE.mem(%t33) {
+      %dma = AIE.dmaStart(S2MM, 0, ^bd0, ^end)
+    ^bd0:
+      AIE.useLock(%lock0, Acquire, 0)
+      AIE.dmaBd(<%buf0 : memref<256xi32>, 0, 256>, 0)
+      AIE.useLock(%lock0, Release, 1)
+      AIE.nextBd ^bd1
+    ^bd1:
+      AIE.useLock(%lock1, Acquire, 0)
+      AIE.dmaBd(<%buf1 : memref<256xi32>, 0, 256>, 0)
+      AIE.useLock(%lock1, Release, 1)
+      AIE.nextBd ^bd0
+    ^end:
+      AIE.end
+  }
+
+  %s33 = AIE.switchbox(%t33) {
+    AIE.connect<South : 0, DMA : 0>
+  }
+
+  %c33 = AIE.core(%t33) {
+    AIE.end
+  }
+ }
+}
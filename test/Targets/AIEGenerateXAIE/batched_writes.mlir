@@ -0,0 +1,69 @@
+//===- batched_writes.mlir -------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-translate --aie-generate-xaie %s | FileCheck %s
+
+// The register writes of the DMA, lock and switchbox configuration are
+// bracketed so that they are recorded into a single transaction when the
+// generated code is compiled with MLIR_AIE_BATCHED_WRITES.
+
+// CHECK: #ifdef MLIR_AIE_BATCHED_WRITES
+// CHECK: mlir_aie_start_transaction(ctx)
+// CHECK: mlir_aie_submit_transaction(ctx, NULL)
+// CHECK: #define __mlir_aie_try(x)
+// CHECK-NEXT: AieRC ret = (x);
+// CHECK-NEXT: if(ret != XAIE_OK) {
+// CHECK-NEXT: __mlir_aie_batch_end();
+// CHECK-NEXT: return ret;
+
+// CHECK-LABEL: int mlir_aie_configure_cores(
+// CHECK-NOT: __mlir_aie_batch_begin
+// CHECK: } // mlir_aie_configure_cores
+
+// CHECK-LABEL: int mlir_aie_configure_dmas(
+// CHECK-NEXT: __mlir_aie_batch_begin();
+// CHECK: XAie_DmaWriteBd
+// CHECK: XAie_DmaChannelEnable
+// CHECK: __mlir_aie_batch_end();
+// CHECK-NEXT: return XAIE_OK;
+
+// CHECK-LABEL: int mlir_aie_initialize_locks(
+// CHECK-NEXT: __mlir_aie_batch_begin();
+// CHECK-NEXT: XAie_LockSetValue
+// CHECK-NEXT: __mlir_aie_batch_end();
+// CHECK-NEXT: return XAIE_OK;
+
+// CHECK-LABEL: int mlir_aie_configure_switchboxes(
+// CHECK-NEXT: int x, y;
+// CHECK-NEXT: __mlir_aie_batch_begin();
+// CHECK: XAie_StrmConnCctEnable
+// CHECK: __mlir_aie_batch_end();
+// CHECK-NEXT: return XAIE_OK;
+
+module {
+  AIE.device(xcvc1902) {
+    %t33 = AIE.tile(3, 3)
+    %buf = AIE.buffer(%t33) {sym_name = "buf"} : memref<16xi32>
+    %lock = AIE.lock(%t33, 0) {init = 1 : i32}
+    %sw = AIE.switchbox(%t33) {
+      AIE.connect<DMA : 0, North : 1>
+    }
+    %mem = AIE.mem(%t33) {
+      %dma = AIE.dmaStart(MM2S, 0, ^bd0, ^end)
+    ^bd0:
+      AIE.useLock(%lock, Acquire, 1)
+      AIE.dmaBd(<%buf : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%lock, Release, 0)
+      AIE.nextBd ^bd0
+    ^end:
+      AIE.end
+    }
+  }
+}
@@ -0,0 +1,53 @@
+//===- buffer_block_accessors.mlir -----------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-translate --aie-generate-xaie %s | FileCheck %s
+
+// CHECK-LABEL: const int a_offset = 4096;
+// CHECK: int mlir_aie_read_buffer_a_block(aie_libxaie_ctx_t* ctx, int offset, int32_t *values, size_t count) {
+// CHECK-NEXT: if (offset < 0 || (size_t)offset + count > 256)
+// CHECK-NEXT: return XAIE_INVALID_ARGS;
+// CHECK-NEXT: u32 addr = a_offset + offset * 4;
+// CHECK-NEXT: return XAie_DataMemBlockRead(&(ctx->DevInst), XAie_TileLoc(3,3), addr, values, count * 4);
+// CHECK: int mlir_aie_write_buffer_a_block(aie_libxaie_ctx_t* ctx, int offset, const int32_t *values, size_t count) {
+// CHECK: return XAie_DataMemBlockWrite(&(ctx->DevInst), XAie_TileLoc(3,3), addr, (void *)values, count * 4);
+// CHECK: int32_t mlir_aie_read_buffer_a(
+// CHECK: int mlir_aie_write_buffer_a(
+
+// CHECK-LABEL: const int b_offset = 5120;
+// CHECK: int mlir_aie_read_buffer_b_block(aie_libxaie_ctx_t* ctx, int offset, int8_t *values, size_t count) {
+// CHECK: if (offset < 0 || (size_t)offset + count > 64)
+// CHECK: u32 addr = b_offset + offset * 1;
+// CHECK: return XAie_DataMemBlockRead(&(ctx->DevInst), XAie_TileLoc(3,3), addr, values, count * 1);
+// CHECK: int mlir_aie_write_buffer_b_block(aie_libxaie_ctx_t* ctx, int offset, const int8_t *values, size_t count) {
+// CHECK-NOT: mlir_aie_read_buffer_b(
+
+// CHECK-LABEL: const int c_offset = 5184;
+// CHECK: int mlir_aie_read_buffer_c_block(aie_libxaie_ctx_t* ctx, int offset, float *values, size_t count) {
+// CHECK: u32 addr = c_offset + offset * 2;
+// CHECK: return __mlir_aie_read_bf16_block(&(ctx->DevInst), XAie_TileLoc(3,3), addr, values, count);
+// CHECK: int mlir_aie_write_buffer_c_block(aie_libxaie_ctx_t* ctx, int offset, const float *values, size_t count) {
+// CHECK: return __mlir_aie_write_bf16_block(&(ctx->DevInst), XAie_TileLoc(3,3), addr, values, count);
+// CHECK-NOT: mlir_aie_read_buffer_c(
+
+// CHECK-LABEL: const int d_offset = 5312;
+// CHECK: int mlir_aie_write_buffer_d_block(aie_libxaie_ctx_t* ctx, int offset, const float *values, size_t count) {
+// CHECK: (void *)values, count * 4);
+// CHECK: float mlir_aie_read_buffer_d(
+
+module {
+  AIE.device(xcve2802) {
+    %t33 = AIE.tile(3, 3)
+    %a = AIE.buffer(%t33) {address = 4096 : i32, sym_name = "a"} : memref<256xi32>
+    %b = AIE.buffer(%t33) {address = 5120 : i32, sym_name = "b"} : memref<64xi8>
+    %c = AIE.buffer(%t33) {address = 5184 : i32, sym_name = "c"} : memref<8x8xbf16>
+    %d = AIE.buffer(%t33) {address = 5312 : i32, sym_name = "d"} : memref<16xf32>
+  }
+}
@@ -0,0 +1,103 @@
+//===- per_column.mlir -----------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-translate --aie-generate-xaie %s | FileCheck %s
+
+// Besides the functions configuring the whole device, the configuration of
+// each column is generated separately so that columns can be configured by
+// concurrent threads.
+
+// CHECK-LABEL: int mlir_aie_configure_cores_column(aie_libxaie_ctx_t* ctx, int col) {
+// CHECK-NEXT: switch (col) {
+// CHECK-NEXT: case 1: {
+// CHECK-NEXT: XAie_CoreReset(&(ctx->DevInst), XAie_TileLoc(1,3))
+// CHECK-NOT: XAie_TileLoc(2,3)
+// CHECK: break;
+// CHECK-NEXT: }
+// CHECK-NEXT: case 2: {
+// CHECK-NEXT: XAie_CoreReset(&(ctx->DevInst), XAie_TileLoc(2,3))
+// CHECK: default:
+
+// CHECK-LABEL: int mlir_aie_configure_switchboxes_column(aie_libxaie_ctx_t* ctx, int col) {
+// CHECK-NEXT: int x, y;
+// CHECK-NEXT: switch (col) {
+// CHECK-NEXT: case 1: {
+// CHECK-NEXT: // Core Stream Switch column 1 row 3
+// CHECK-NEXT: x = 1;
+// CHECK-NEXT: y = 3;
+// CHECK-NEXT: XAie_StrmConnCctEnable(&(ctx->DevInst), XAie_TileLoc(x,y), DMA, 0, EAST, 1)
+// CHECK-NEXT: break;
+// CHECK-NEXT: }
+// CHECK-NEXT: case 2: {
+// CHECK-NEXT: // Core Stream Switch column 2 row 3
+// CHECK-NEXT: x = 2;
+// CHECK-NEXT: y = 3;
+// CHECK-NEXT: XAie_StrmConnCctEnable(&(ctx->DevInst), XAie_TileLoc(x,y), WEST, 1, DMA, 0)
+
+// CHECK-LABEL: int mlir_aie_initialize_locks_column(aie_libxaie_ctx_t* ctx, int col) {
+// CHECK: case 2: {
+// CHECK-NEXT: XAie_LockSetValue(&(ctx->DevInst), XAie_TileLoc(2,3), XAie_LockInit(0, 1))
+// CHECK-NEXT: break;
+
+// CHECK-LABEL: int mlir_aie_configure_dmas_column(aie_libxaie_ctx_t* ctx, int col) {
+// CHECK: case 1: {
+// CHECK: XAie_DmaChannelEnable(&(ctx->DevInst), XAie_TileLoc(1,3), /* ChNum */ 0, /* dmaDir */ DMA_MM2S)
+// CHECK: case 2: {
+// CHECK: XAie_DmaChannelEnable(&(ctx->DevInst), XAie_TileLoc(2,3), /* ChNum */ 0, /* dmaDir */ DMA_S2MM)
+
+// CHECK-LABEL: int mlir_aie_configure_parallel(aie_libxaie_ctx_t* ctx, int numThreads) {
+// CHECK: static const int columns[] = {1, 2, };
+// CHECK-NEXT: return mlir_aie_configure_columns(ctx, phases, 4, columns, 2, numThreads);
+
+module {
+  AIE.device(xcve2802) {
+    %t13 = AIE.tile(1, 3)
+    %t23 = AIE.tile(2, 3)
+    %buf13 = AIE.buffer(%t13) {address = 4096 : i32, sym_name = "a"} : memref<16xi32>
+    %buf23 = AIE.buffer(%t23) {address = 4096 : i32, sym_name = "b"} : memref<16xi32>
+    %lock13 = AIE.lock(%t13, 0) {init = 0 : i32}
+    %lock23 = AIE.lock(%t23, 0) {init = 1 : i32}
+
+    %sw13 = AIE.switchbox(%t13) {
+      AIE.connect<DMA : 0, East : 1>
+    }
+    %sw23 = AIE.switchbox(%t23) {
+      AIE.connect<West : 1, DMA : 0>
+    }
+
+    %core13 = AIE.core(%t13) {
+      AIE.end
+    }
+    %core23 = AIE.core(%t23) {
+      AIE.end
+    }
+
+    %mem13 = AIE.mem(%t13) {
+      %dma = AIE.dmaStart(MM2S, 0, ^bd0, ^end)
+    ^bd0:
+      AIE.useLock(%lock13, AcquireGreaterEqual, 1)
+      AIE.dmaBd(<%buf13 : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%lock13, Release, 1)
+      AIE.nextBd ^bd0
+    ^end:
+      AIE.end
+    }
+    %mem23 = AIE.mem(%t23) {
+      %dma = AIE.dmaStart(S2MM, 0, ^bd0, ^end)
+    ^bd0:
+      AIE.useLock(%lock23, AcquireGreaterEqual, 1)
+      AIE.dmaBd(<%buf23 : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%lock23, Release, 1)
+      AIE.nextBd ^bd0
+    ^end:
+      AIE.end
+    }
+  }
+}
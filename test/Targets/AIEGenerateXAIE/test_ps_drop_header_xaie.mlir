@@ -0,0 +1,44 @@
+//===- test_ps_drop_header_xaie.mlir ---------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-translate --aie-generate-xaie %s | FileCheck %s
+
+// The East master port drops the packet header because of its drop_header
+// attribute, the DMA master port always drops it, and the Core master port
+// keeps it.
+
+// CHECK: mlir_aie_configure_switchboxes
+// CHECK: x = 1;
+// CHECK: y = 3;
+// CHECK: __mlir_aie_try(XAie_StrmPktSwMstrPortEnable(&(ctx->DevInst), XAie_TileLoc(x,y), EAST, 0, {{.*}} XAIE_SS_PKT_DROP_HEADER, {{.*}} 0, {{.*}} 0x1));
+// CHECK: __mlir_aie_try(XAie_StrmPktSwMstrPortEnable(&(ctx->DevInst), XAie_TileLoc(x,y), CORE, 0, {{.*}} XAIE_SS_PKT_DONOT_DROP_HEADER, {{.*}} 0, {{.*}} 0x2));
+// CHECK: __mlir_aie_try(XAie_StrmPktSwMstrPortEnable(&(ctx->DevInst), XAie_TileLoc(x,y), DMA, 0, {{.*}} XAIE_SS_PKT_DROP_HEADER, {{.*}} 1, {{.*}} 0x1));
+
+module @test_ps_drop_header_xaie {
+ AIE.device(xcvc1902) {
+  %t13 = AIE.tile(1, 3)
+
+  AIE.switchbox(%t13) {
+    %a0_0 = AIE.amsel<0>(0)
+    %a0_1 = AIE.amsel<0>(1)
+    %a1_0 = AIE.amsel<1>(0)
+
+    AIE.masterset(East : 0, %a0_0) {drop_header}
+    AIE.masterset(Core : 0, %a0_1)
+    AIE.masterset(DMA : 0, %a1_0)
+
+    AIE.packetrules(West : 0) {
+      AIE.rule(0x1F, 0x0, %a0_0)
+      AIE.rule(0x1F, 0x1, %a0_1)
+      AIE.rule(0x1F, 0x2, %a1_0)
+    }
+  }
+ }
+}
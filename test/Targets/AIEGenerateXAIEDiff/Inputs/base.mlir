@@ -0,0 +1,52 @@
+//===- base.mlir -----------------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+module @base {
+  AIE.device(xcvc1902) {
+    %t13 = AIE.tile(1, 3)
+    %t23 = AIE.tile(2, 3)
+    %buf13 = AIE.buffer(%t13) {address = 4096 : i32, sym_name = "a"} : memref<16xi32>
+    %buf23 = AIE.buffer(%t23) {address = 4096 : i32, sym_name = "b"} : memref<16xi32>
+    %lock13 = AIE.lock(%t13, 0)
+
+    %sw13 = AIE.switchbox(%t13) {
+      AIE.connect<DMA : 0, North : 1>
+    }
+    %sw23 = AIE.switchbox(%t23) {
+      AIE.connect<South : 0, Core : 0>
+    }
+
+    %core13 = AIE.core(%t13) {
+      %c = arith.constant 7 : i32
+      %i = arith.constant 0 : index
+      memref.store %c, %buf13[%i] : memref<16xi32>
+      AIE.end
+    }
+    %core23 = AIE.core(%t23) {
+      %c = arith.constant 7 : i32
+      %i = arith.constant 0 : index
+      AIE.useLock(%lock13, Acquire, 0)
+      memref.store %c, %buf23[%i] : memref<16xi32>
+      AIE.useLock(%lock13, Release, 1)
+      AIE.end
+    }
+
+    %mem13 = AIE.mem(%t13) {
+      %dma = AIE.dmaStart(MM2S, 0, ^bd0, ^end)
+    ^bd0:
+      AIE.useLock(%lock13, Acquire, 1)
+      AIE.dmaBd(<%buf13 : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%lock13, Release, 0)
+      AIE.nextBd ^bd0
+    ^end:
+      AIE.end
+    }
+  }
+}
@@ -0,0 +1,108 @@
+//===- reconfigure.mlir ----------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-translate --aie-generate-xaie-diff --xaie-diff-base=%S/Inputs/base.mlir %s | FileCheck %s
+// RUN: aie-translate --aie-generate-xaie-diff --xaie-diff-base=%s %s | FileCheck --check-prefix=SAME %s
+
+// Compared to Inputs/base.mlir, the core of tile(1, 3) stores another value
+// and its DMA goes east instead of north. The BDs of the DMA of tile(1, 3)
+// are unchanged, but they use the locks reset for the new core, so the DMA
+// is stopped and configured again. The unchanged core of tile(2, 3) uses
+// these locks too, so it is stopped before and restarted after the
+// reconfiguration of all columns, like the core of tile(1, 3).
+
+// CHECK: const int mlir_aie_reconfigured_columns[] = {1, 2, -1};
+// CHECK-LABEL: int mlir_aie_reconfigure_stop_cores(
+// CHECK-NEXT: XAie_CoreReset(&(ctx->DevInst), XAie_TileLoc(1,3))
+// CHECK-NEXT: XAie_CoreDisable(&(ctx->DevInst), XAie_TileLoc(1,3))
+// CHECK-NEXT: XAie_CoreReset(&(ctx->DevInst), XAie_TileLoc(2,3))
+// CHECK-NEXT: XAie_CoreDisable(&(ctx->DevInst), XAie_TileLoc(2,3))
+// CHECK-NEXT: return XAIE_OK;
+// CHECK-LABEL: int mlir_aie_reconfigure_column_1(
+// CHECK-NEXT: __mlir_aie_batch_begin();
+// CHECK-NEXT: // Tile column 1 row 3
+// CHECK-NEXT: XAie_DmaChannelDisable(&(ctx->DevInst), XAie_TileLoc(1,3), /* ChNum */ 0, /* dmaDir */ DMA_MM2S)
+// CHECK-NEXT: XAie_StrmConnCctDisable(&(ctx->DevInst), XAie_TileLoc(1,3), DMA, 0, NORTH, 1)
+// CHECK-NEXT: XAie_StrmConnCctEnable(&(ctx->DevInst), XAie_TileLoc(1,3), DMA, 0, EAST, 1)
+// CHECK-NEXT: XAie_LockRelease(&(ctx->DevInst), XAie_TileLoc(1,3), XAie_LockInit(0, 0x0), 0)
+// CHECK-NEXT: {
+// CHECK-NEXT: XAie_LoadElf(&(ctx->DevInst), XAie_TileLoc(1,3), (const char*)"core_1_3.elf",0);
+// CHECK: XAie_DmaDescInit(&(ctx->DevInst), {{.*}}, XAie_TileLoc(1,3))
+// CHECK: XAie_DmaChannelEnable(&(ctx->DevInst), XAie_TileLoc(1,3), /* ChNum */ 0, /* dmaDir */ DMA_MM2S)
+// CHECK-NEXT: __mlir_aie_batch_end();
+// CHECK-NEXT: return XAIE_OK;
+// CHECK-LABEL: int mlir_aie_reconfigure_column_2(
+// CHECK-NEXT: __mlir_aie_batch_begin();
+// CHECK-NEXT: // Tile column 2 row 3
+// CHECK-NEXT: {
+// CHECK-NEXT: XAie_LoadElf(&(ctx->DevInst), XAie_TileLoc(2,3), (const char*)"core_2_3.elf",0);
+// CHECK-NOT: XAie_
+// CHECK: __mlir_aie_batch_end();
+// CHECK-LABEL: int mlir_aie_reconfigure_start_cores(
+// CHECK-NEXT: XAie_CoreUnreset(&(ctx->DevInst), XAie_TileLoc(1,3))
+// CHECK-NEXT: XAie_CoreEnable(&(ctx->DevInst), XAie_TileLoc(1,3))
+// CHECK-NEXT: XAie_CoreUnreset(&(ctx->DevInst), XAie_TileLoc(2,3))
+// CHECK-NEXT: XAie_CoreEnable(&(ctx->DevInst), XAie_TileLoc(2,3))
+// CHECK-NEXT: return XAIE_OK;
+// CHECK-LABEL: int mlir_aie_reconfigure(
+// CHECK-NEXT: mlir_aie_reconfigure_stop_cores(ctx)
+// CHECK-NEXT: mlir_aie_reconfigure_column_1(ctx)
+// CHECK-NEXT: mlir_aie_reconfigure_column_2(ctx)
+// CHECK-NEXT: mlir_aie_reconfigure_start_cores(ctx)
+
+// SAME: const int mlir_aie_reconfigured_columns[] = {-1};
+// SAME-LABEL: int mlir_aie_reconfigure_stop_cores(
+// SAME-NEXT: return XAIE_OK;
+// SAME-NOT: mlir_aie_reconfigure_column_
+// SAME-LABEL: int mlir_aie_reconfigure_start_cores(
+// SAME-NEXT: return XAIE_OK;
+
+module @reconfigure {
+  AIE.device(xcvc1902) {
+    %t13 = AIE.tile(1, 3)
+    %t23 = AIE.tile(2, 3)
+    %buf13 = AIE.buffer(%t13) {address = 4096 : i32, sym_name = "c"} : memref<16xi32>
+    %buf23 = AIE.buffer(%t23) {address = 4096 : i32, sym_name = "d"} : memref<16xi32>
+    %lock13 = AIE.lock(%t13, 0)
+
+    %sw13 = AIE.switchbox(%t13) {
+      AIE.connect<DMA : 0, East : 1>
+    }
+    %sw23 = AIE.switchbox(%t23) {
+      AIE.connect<South : 0, Core : 0>
+    }
+
+    %core13 = AIE.core(%t13) {
+      %c = arith.constant 8 : i32
+      %i = arith.constant 0 : index
+      memref.store %c, %buf13[%i] : memref<16xi32>
+      AIE.end
+    }
+    %core23 = AIE.core(%t23) {
+      %c = arith.constant 7 : i32
+      %i = arith.constant 0 : index
+      AIE.useLock(%lock13, Acquire, 0)
+      memref.store %c, %buf23[%i] : memref<16xi32>
+      AIE.useLock(%lock13, Release, 1)
+      AIE.end
+    }
+
+    %mem13 = AIE.mem(%t13) {
+      %dma = AIE.dmaStart(MM2S, 0, ^bd0, ^end)
+    ^bd0:
+      AIE.useLock(%lock13, Acquire, 1)
+      AIE.dmaBd(<%buf13 : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%lock13, Release, 0)
+      AIE.nextBd ^bd0
+    ^end:
+      AIE.end
+    }
+  }
+}
@@ -0,0 +1,57 @@
+//===- bank_aware.mlir -----------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-assign-buffer-addresses="bank-aware=true bank-report=true" %s 2>&1 | FileCheck %s
+// RUN: aie-opt --aie-assign-buffer-addresses --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck --check-prefix=STATS %s
+
+// The DMA channel alternates between "a" and "b", and the core loop reads "a"
+// and writes "c". Packed by size, "a" and "b" share bank 0. Bank-aware, "b"
+// and "c" are placed in bank 1.
+
+// CHECK: remark: placed at 0x400 in bank 0 of 8
+// CHECK: remark: placed at 0x1000 in bank 1 of 8
+// CHECK: remark: placed at 0x1400 in bank 1 of 8
+// CHECK: AIE.buffer({{.*}}) {address = 1024 : i32, sym_name = "a"} : memref<512xi32>
+// CHECK: AIE.buffer({{.*}}) {address = 4096 : i32, sym_name = "b"} : memref<256xi32>
+// CHECK: AIE.buffer({{.*}}) {address = 5120 : i32, sym_name = "c"} : memref<128xi32>
+
+// STATS: (S) 1 bank-conflicts
+
+module @test {
+ AIE.device(xcvc1902) {
+  %t33 = AIE.tile(3, 3)
+  %a = AIE.buffer(%t33) { sym_name = "a" } : memref<512xi32>
+  %b = AIE.buffer(%t33) { sym_name = "b" } : memref<256xi32>
+  %c = AIE.buffer(%t33) { sym_name = "c" } : memref<128xi32>
+
+  %m33 = AIE.mem(%t33) {
+      %dma = AIE.dmaStart(S2MM, 0, ^bd0, ^end)
+    ^bd0:
+      AIE.dmaBd(<%a : memref<512xi32>, 0, 512>, 0)
+      AIE.nextBd ^bd1
+    ^bd1:
+      AIE.dmaBd(<%b : memref<256xi32>, 0, 256>, 0)
+      AIE.nextBd ^bd0
+    ^end:
+      AIE.end
+  }
+
+  %c33 = AIE.core(%t33) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c128 = arith.constant 128 : index
+    scf.for %i = %c0 to %c128 step %c1 {
+      %v = memref.load %a[%i] : memref<512xi32>
+      memref.store %v, %c[%i] : memref<128xi32>
+    }
+    AIE.end
+  }
+ }
+}
@@ -0,0 +1,58 @@
+//===- overlay.mlir --------------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-assign-buffer-addresses="overlay=true" %s | FileCheck %s
+// RUN: aie-opt --aie-assign-buffer-addresses="overlay=true" --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck --check-prefix=STATS %s
+
+// The scratch buffers "s1" and "s2" are used in separate loops of the core and
+// share their addresses. "d" is used by the DMA and is always live. Without
+// overlaying, the buffers do not fit in the memory of the tile.
+
+// CHECK: AIE.buffer({{.*}}) {address = 1024 : i32, sym_name = "s1"} : memref<4096xi32>
+// CHECK: AIE.buffer({{.*}}) {address = 1024 : i32, sym_name = "s2"} : memref<4000xi32>
+// CHECK: AIE.buffer({{.*}}) {address = 17408 : i32, sym_name = "d"} : memref<1024xi32>
+
+// STATS: (S) 16000 overlaid-bytes
+
+module @test {
+ AIE.device(xcvc1902) {
+  %t33 = AIE.tile(3, 3)
+  %s1 = AIE.buffer(%t33) { sym_name = "s1" } : memref<4096xi32>
+  %s2 = AIE.buffer(%t33) { sym_name = "s2" } : memref<4000xi32>
+  %d = AIE.buffer(%t33) { sym_name = "d" } : memref<1024xi32>
+
+  %m33 = AIE.mem(%t33) {
+      %dma = AIE.dmaStart(MM2S, 0, ^bd0, ^end)
+    ^bd0:
+      AIE.dmaBd(<%d : memref<1024xi32>, 0, 1024>, 0)
+      AIE.nextBd ^bd0
+    ^end:
+      AIE.end
+  }
+
+  %c33 = AIE.core(%t33) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c1024 = arith.constant 1024 : index
+    %c7 = arith.constant 7 : i32
+    scf.for %i = %c0 to %c1024 step %c1 {
+      memref.store %c7, %s1[%i] : memref<4096xi32>
+      %v = memref.load %s1[%i] : memref<4096xi32>
+      memref.store %v, %d[%i] : memref<1024xi32>
+    }
+    scf.for %i = %c0 to %c1024 step %c1 {
+      memref.store %c7, %s2[%i] : memref<4000xi32>
+      %v = memref.load %s2[%i] : memref<4000xi32>
+      memref.store %v, %d[%i] : memref<1024xi32>
+    }
+    AIE.end
+  }
+ }
+}
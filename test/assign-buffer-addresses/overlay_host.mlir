@@ -0,0 +1,52 @@
+//===- overlay_host.mlir ---------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-assign-buffer-addresses="overlay=true" %s | FileCheck %s
+
+// The core reads "in" before writing it, so "in" holds an input from before
+// the core starts and is live from the start of the core. The core writes
+// "out" last, so the host may read it after the core is done and "out" is
+// live until the end of the core. Neither shares its addresses with the
+// scratch buffers "s" and "t", which share addresses with each other.
+
+// CHECK: AIE.buffer({{.*}}) {address = 1024 : i32, sym_name = "s"} : memref<1024xi32>
+// CHECK: AIE.buffer({{.*}}) {address = 5120 : i32, sym_name = "in"} : memref<1000xi32>
+// CHECK: AIE.buffer({{.*}}) {address = 9120 : i32, sym_name = "out"} : memref<960xi32>
+// CHECK: AIE.buffer({{.*}}) {address = 1024 : i32, sym_name = "t"} : memref<900xi32>
+
+module @test {
+ AIE.device(xcvc1902) {
+  %t33 = AIE.tile(3, 3)
+  %s = AIE.buffer(%t33) { sym_name = "s" } : memref<1024xi32>
+  %in = AIE.buffer(%t33) { sym_name = "in" } : memref<1000xi32>
+  %out = AIE.buffer(%t33) { sym_name = "out" } : memref<960xi32>
+  %t = AIE.buffer(%t33) { sym_name = "t" } : memref<900xi32>
+
+  %c33 = AIE.core(%t33) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c900 = arith.constant 900 : index
+    %c7 = arith.constant 7 : i32
+    scf.for %i = %c0 to %c900 step %c1 {
+      memref.store %c7, %s[%i] : memref<1024xi32>
+      %v = memref.load %s[%i] : memref<1024xi32>
+      memref.store %v, %out[%i] : memref<960xi32>
+    }
+    scf.for %i = %c0 to %c900 step %c1 {
+      memref.store %c7, %t[%i] : memref<900xi32>
+      %v = memref.load %t[%i] : memref<900xi32>
+      %w = memref.load %in[%i] : memref<1000xi32>
+      %sum = arith.addi %v, %w : i32
+      memref.store %sum, %t[%i] : memref<900xi32>
+    }
+    AIE.end
+  }
+ }
+}
@@ -0,0 +1,41 @@
+//===- spill.mlir ----------------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-assign-buffer-addresses="spill=true" %s | FileCheck %s
+// RUN: aie-opt --aie-assign-buffer-addresses="spill=true" %s | aie-translate --tilecol=3 --tilerow=3 --aie-generate-ldscript | FileCheck --check-prefix=LD %s
+
+// The buffers of tile (3, 3) and its stack do not fit in 32KB. "a" is only
+// used by the core of tile (3, 3), so it moves to the memory module to the
+// south, which the core reaches at 0x20000.
+
+// CHECK: %[[T32:.*]] = AIE.tile(3, 2)
+// CHECK: %[[T33:.*]] = AIE.tile(3, 3)
+// CHECK: AIE.buffer(%[[T32]]) {address = 0 : i32, sym_name = "a"} : memref<6000xi32>
+// CHECK: AIE.buffer(%[[T33]]) {address = 1024 : i32, sym_name = "b"} : memref<2048xi32>
+
+// LD: . = 0x20000;
+// LD-NEXT: a = .;
+// LD: . = 0x38400;
+// LD-NEXT: b = .;
+
+module @test {
+ AIE.device(xcvc1902) {
+  %t33 = AIE.tile(3, 3)
+  %a = AIE.buffer(%t33) { sym_name = "a" } : memref<6000xi32>
+  %b = AIE.buffer(%t33) { sym_name = "b" } : memref<2048xi32>
+
+  %c33 = AIE.core(%t33) {
+    %c0 = arith.constant 0 : index
+    %v = memref.load %a[%c0] : memref<6000xi32>
+    memref.store %v, %b[%c0] : memref<2048xi32>
+    AIE.end
+  }
+ }
+}
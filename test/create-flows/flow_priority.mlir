@@ -0,0 +1,48 @@
+//===- flow_priority.mlir --------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// In each of two identical pairs of tiles, the circuit-switched connections
+// leave a single East channel to the neighbour tile, where two flows compete
+// for it. Without a priority, the flow declared first keeps the direct path
+// and the other one detours through the shim row. With a priority, the flow
+// declared second is routed first and, as each hop counts less against the
+// congestion, keeps the direct path instead.
+
+// RUN: aie-opt --aie-create-pathfinder-flows="hop-report=true" %s -o /dev/null 2>&1 | FileCheck %s
+
+// CHECK: remark: routed through 3 switchbox hops with priority 0
+// CHECK: remark: routed through 1 switchbox hops with priority 5
+// CHECK: remark: routed through 1 switchbox hops with priority 0
+// CHECK: remark: routed through 3 switchbox hops with priority 0
+
+module {
+    AIE.device(xcvc1902) {
+        %t11 = AIE.tile(1, 1)
+        %t21 = AIE.tile(2, 1)
+        %t51 = AIE.tile(5, 1)
+        %t61 = AIE.tile(6, 1)
+
+        AIE.switchbox(%t11) {
+            AIE.connect<South : 0, East : 0>
+            AIE.connect<South : 1, East : 1>
+            AIE.connect<South : 2, East : 2>
+        }
+        AIE.switchbox(%t51) {
+            AIE.connect<South : 0, East : 0>
+            AIE.connect<South : 1, East : 1>
+            AIE.connect<South : 2, East : 2>
+        }
+
+        AIE.flow(%t11, DMA : 0, %t21, DMA : 0)
+        AIE.flow(%t11, DMA : 1, %t21, DMA : 1) {priority = 5 : i32}
+        AIE.flow(%t51, DMA : 0, %t61, DMA : 0)
+        AIE.flow(%t51, DMA : 1, %t61, DMA : 1)
+    }
+}
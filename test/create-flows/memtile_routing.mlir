@@ -0,0 +1,35 @@
+//===- memtile_routing.mlir ------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023, Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// The switchboxes of AIE2 mem tiles have no East/West connections, so a flow
+// between two mem tiles of the same row is routed through the shim row.
+
+// RUN: aie-opt --aie-create-pathfinder-flows %s | FileCheck %s
+// RUN: aie-opt --aie-create-pathfinder-flows %s | FileCheck --check-prefix=MEMROW %s
+// RUN: aie-opt --aie-create-pathfinder-flows --aie-find-flows %s | FileCheck --check-prefix=FLOWS %s
+
+// CHECK-DAG: AIE.tile(1, 0)
+// CHECK-DAG: AIE.tile(2, 0)
+
+// MEMROW-NOT: AIE.tile(1, 1)
+// MEMROW-NOT: AIE.tile(2, 1)
+
+// FLOWS: %[[T01:.*]] = AIE.tile(0, 1)
+// FLOWS: %[[T31:.*]] = AIE.tile(3, 1)
+// FLOWS: AIE.flow(%[[T01]], DMA : 0, %[[T31]], DMA : 0)
+
+module {
+    AIE.device(xcve2802) {
+        %t01 = AIE.tile(0, 1)
+        %t31 = AIE.tile(3, 1)
+
+        AIE.flow(%t01, DMA : 0, %t31, DMA : 0)
+    }
+}
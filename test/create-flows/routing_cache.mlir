@@ -0,0 +1,40 @@
+//===- routing_cache.mlir --------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: aie-opt --aie-create-pathfinder-flows="cache-dir=%t/cache" %s > %t/miss.mlir
+// RUN: ls %t/cache | FileCheck --check-prefix=CACHE %s
+// RUN: aie-opt --aie-create-pathfinder-flows="cache-dir=%t/cache" %s > %t/hit.mlir
+// RUN: diff %t/miss.mlir %t/hit.mlir
+// RUN: aie-opt --aie-find-flows %t/hit.mlir | FileCheck %s
+
+// CACHE: {{^[0-9a-f]+}}.route
+
+// CHECK: %[[T01:.*]] = AIE.tile(0, 1)
+// CHECK: %[[T12:.*]] = AIE.tile(1, 2)
+// CHECK: %[[T22:.*]] = AIE.tile(2, 2)
+// CHECK: %[[T31:.*]] = AIE.tile(3, 1)
+// CHECK-DAG: AIE.flow(%[[T01]], DMA : 0, %[[T22]], DMA : 0)
+// CHECK-DAG: AIE.flow(%[[T01]], DMA : 0, %[[T31]], DMA : 1)
+// CHECK-DAG: AIE.flow(%[[T12]], Core : 0, %[[T31]], Core : 0)
+// CHECK-DAG: AIE.flow(%[[T31]], DMA : 0, %[[T01]], DMA : 1)
+
+module {
+  AIE.device(xcvc1902) {
+    %t01 = AIE.tile(0, 1)
+    %t12 = AIE.tile(1, 2)
+    %t22 = AIE.tile(2, 2)
+    %t31 = AIE.tile(3, 1)
+    AIE.flow(%t01, DMA : 0, %t22, DMA : 0)
+    AIE.flow(%t01, DMA : 0, %t31, DMA : 1)
+    AIE.flow(%t12, Core : 0, %t31, Core : 0)
+    AIE.flow(%t31, DMA : 0, %t01, DMA : 1)
+  }
+}
@@ -9,6 +9,9 @@
 //===----------------------------------------------------------------------===//
 
 // RUN: aie-opt --aie-create-pathfinder-flows --aie-find-flows %s | FileCheck %s
+// RUN: aie-opt --aie-create-pathfinder-flows="incremental=true" --aie-find-flows %s | FileCheck %s
+// RUN: aie-opt --aie-create-pathfinder-flows="astar=true" --aie-find-flows %s | FileCheck %s
+// RUN: aie-opt --aie-create-pathfinder-flows="threads=4" --aie-find-flows %s | FileCheck %s
 // CHECK: %[[T2:.*]] = AIE.tile(47, 0)
 // CHECK: %[[T4:.*]] = AIE.tile(10, 5)
 // CHECK: %[[T15:.*]] = AIE.tile(46, 0)
@@ -0,0 +1,44 @@
+//===- test_create_packet_flows_nested.mlir --------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-create-packet-flows %s | FileCheck %s
+// RUN: aie-opt --aie-create-packet-flows="pathfinder=true" %s | FileCheck %s
+
+// The outer flow 0x1 delivers packets to East : 0 of tile (7, 2), which drops
+// the outer header. The inner flows route them on from West : 0 of tile (8, 2)
+// by their inner header.
+module @test_create_packet_flows_nested {
+ AIE.device(xcvc1902) {
+// CHECK-LABEL: module @test_create_packet_flows_nested {
+// CHECK:         %[[T72:.*]] = AIE.tile(7, 2)
+// CHECK:         AIE.switchbox(%[[T72]]) {
+// CHECK:           AIE.masterset(East : 0, %{{.*}}) {drop_header}
+// CHECK:         %[[T82:.*]] = AIE.tile(8, 2)
+// CHECK:         AIE.switchbox(%[[T82]]) {
+// CHECK-NOT:       drop_header
+// CHECK:           AIE.packetrules(West : 0) {
+  %t72 = AIE.tile(7, 2)
+  %t82 = AIE.tile(8, 2)
+  %t83 = AIE.tile(8, 3)
+
+  AIE.packet_flow(0x1) {
+    AIE.packet_source<%t72, DMA : 0>
+    AIE.packet_dest<%t72, East : 0> {drop_header}
+  }
+  AIE.packet_flow(0x5) {
+    AIE.packet_source<%t82, West : 0>
+    AIE.packet_dest<%t82, DMA : 0>
+  }
+  AIE.packet_flow(0x6) {
+    AIE.packet_source<%t82, West : 0>
+    AIE.packet_dest<%t83, DMA : 0>
+  }
+ }
+}
@@ -0,0 +1,47 @@
+//===- test_create_packet_flows_pathfinder.mlir ----------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-create-packet-flows="pathfinder=true" %s | FileCheck %s
+
+// The circuit-switched connections of tile (1, 1) use East 0 to 2, so the
+// packet flows share the remaining East port.
+module @test_create_packet_flows_pathfinder {
+ AIE.device(xcvc1902) {
+// CHECK-LABEL:   module @test_create_packet_flows_pathfinder {
+// CHECK:           %[[T11:.*]] = AIE.tile(1, 1)
+// CHECK:           %[[T21:.*]] = AIE.tile(2, 1)
+// CHECK:           AIE.switchbox(%[[T21]]) {
+// CHECK:             AIE.packetrules(West : 3) {
+// CHECK:           AIE.switchbox(%[[T11]]) {
+// CHECK:             AIE.connect<DMA : 0, East : 0>
+// CHECK:             AIE.connect<DMA : 1, East : 1>
+// CHECK:             AIE.connect<Core : 0, East : 2>
+// CHECK:             AIE.masterset(East : 3, %{{.*}})
+// CHECK:             AIE.packetrules(West : 0) {
+  %t11 = AIE.tile(1, 1)
+  %t21 = AIE.tile(2, 1)
+
+  AIE.switchbox(%t11) {
+    AIE.connect<DMA : 0, East : 0>
+    AIE.connect<DMA : 1, East : 1>
+    AIE.connect<Core : 0, East : 2>
+  }
+
+  AIE.packet_flow(0x0) {
+    AIE.packet_source<%t11, West : 0>
+    AIE.packet_dest<%t21, Core : 0>
+  }
+
+  AIE.packet_flow(0x1) {
+    AIE.packet_source<%t11, West : 0>
+    AIE.packet_dest<%t21, Core : 1>
+  }
+ }
+}
@@ -0,0 +1,63 @@
+//===- test_create_packet_flows_pathfinder_slots.mlir ----------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-create-packet-flows="pathfinder=true" %s | FileCheck %s
+
+// The circuit-switched connections of tile (1, 2) use East 0 to 2, so the
+// shortest route of all five flows enters tile (2, 2) through West 3. The
+// flows go to five different sets of master ports there, which need five
+// slots of that slave port when it only has four. Negotiation moves at least
+// one flow onto a longer route that enters tile (2, 2) from another side.
+
+// CHECK:           %[[T22:.*]] = AIE.tile(2, 2)
+// CHECK:           AIE.switchbox(%[[T22]]) {
+// CHECK-DAG:         AIE.packetrules(West : 3) {
+// CHECK-DAG:         AIE.packetrules({{North|South}} : {{[0-9]}}) {
+// CHECK:           }
+module @test_create_packet_flows_pathfinder_slots {
+ AIE.device(xcvc1902) {
+  %t12 = AIE.tile(1, 2)
+  %t22 = AIE.tile(2, 2)
+  %t13 = AIE.tile(1, 3)
+  %t23 = AIE.tile(2, 3)
+
+  AIE.switchbox(%t12) {
+    AIE.connect<DMA : 1, East : 0>
+    AIE.connect<Core : 0, East : 1>
+    AIE.connect<Core : 1, East : 2>
+  }
+
+  AIE.packet_flow(0x0) {
+    AIE.packet_source<%t12, DMA : 0>
+    AIE.packet_dest<%t22, Core : 0>
+  }
+
+  AIE.packet_flow(0x1) {
+    AIE.packet_source<%t12, DMA : 0>
+    AIE.packet_dest<%t22, Core : 1>
+  }
+
+  AIE.packet_flow(0x2) {
+    AIE.packet_source<%t12, DMA : 0>
+    AIE.packet_dest<%t22, DMA : 0>
+  }
+
+  AIE.packet_flow(0x3) {
+    AIE.packet_source<%t12, DMA : 0>
+    AIE.packet_dest<%t22, DMA : 1>
+  }
+
+  AIE.packet_flow(0x4) {
+    AIE.packet_source<%t12, DMA : 0>
+    AIE.packet_dest<%t22, Core : 0>
+    AIE.packet_dest<%t22, Core : 1>
+  }
+ }
+}
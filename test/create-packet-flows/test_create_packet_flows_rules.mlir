@@ -0,0 +1,62 @@
+//===- test_create_packet_flows_rules.mlir ---------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-create-packet-flows %s | FileCheck %s
+// RUN: aie-opt --aie-create-packet-flows --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck --check-prefix=STATS %s
+
+// IDs 0-3 and 6 go to Core 0 and IDs 4 and 5 to Core 1. A single rule for
+// IDs 0-3 and 6 would also match IDs 4 and 5, so they need two rules.
+module @test_create_packet_flows_rules {
+ AIE.device(xcvc1902) {
+// CHECK-LABEL: module @test_create_packet_flows_rules {
+// CHECK:         %[[T11:.*]] = AIE.tile(1, 1)
+// CHECK:         AIE.switchbox(%[[T11]]) {
+// CHECK-DAG:       AIE.masterset(Core : 0, %[[CORE0:.*]])
+// CHECK-DAG:       AIE.masterset(Core : 1, %[[CORE1:.*]])
+// CHECK:           AIE.packetrules(DMA : 0) {
+// CHECK-DAG:         AIE.rule(28, 0, %[[CORE0]])
+// CHECK-DAG:         AIE.rule(31, 6, %[[CORE0]])
+// CHECK-DAG:         AIE.rule(30, 4, %[[CORE1]])
+// CHECK:           }
+
+// STATS-DAG: (S) 7 packet-rules-unmerged
+// STATS-DAG: (S) 3 packet-rules -
+  %t11 = AIE.tile(1, 1)
+
+  AIE.packet_flow(0x0) {
+    AIE.packet_source<%t11, DMA : 0>
+    AIE.packet_dest<%t11, Core : 0>
+  }
+  AIE.packet_flow(0x1) {
+    AIE.packet_source<%t11, DMA : 0>
+    AIE.packet_dest<%t11, Core : 0>
+  }
+  AIE.packet_flow(0x2) {
+    AIE.packet_source<%t11, DMA : 0>
+    AIE.packet_dest<%t11, Core : 0>
+  }
+  AIE.packet_flow(0x3) {
+    AIE.packet_source<%t11, DMA : 0>
+    AIE.packet_dest<%t11, Core : 0>
+  }
+  AIE.packet_flow(0x4) {
+    AIE.packet_source<%t11, DMA : 0>
+    AIE.packet_dest<%t11, Core : 1>
+  }
+  AIE.packet_flow(0x5) {
+    AIE.packet_source<%t11, DMA : 0>
+    AIE.packet_dest<%t11, Core : 1>
+  }
+  AIE.packet_flow(0x6) {
+    AIE.packet_source<%t11, DMA : 0>
+    AIE.packet_dest<%t11, Core : 0>
+  }
+ }
+}
@@ -0,0 +1,28 @@
+//===- badobjectfifo_dimensions.mlir ---------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --split-input-file --verify-diagnostics %s
+
+AIE.device(xcve2302) {
+  %tile12 = AIE.tile(1, 2)
+  %tile13 = AIE.tile(1, 3)
+  %tile33 = AIE.tile(3, 3)
+  // expected-error@+1 {{'AIE.objectFifo' op does not have fromStream dimensions for each consumer.}}
+  AIE.objectFifo @of (%tile12, {%tile13, %tile33}, 2 : i32) fromStream [[<1, 16>]] : !AIE.objectFifo<memref<16xi32>>
+}
+
+// -----
+
+AIE.device(xcvc1902) {
+  %tile12 = AIE.tile(1, 2)
+  %tile33 = AIE.tile(3, 3)
+  // expected-error@+1 {{'AIE.objectFifo' op DMA dimensions are not supported on AIE1 devices}}
+  AIE.objectFifo @of (%tile12, {%tile33}, 2 : i32) toStream [<1, 16>] : !AIE.objectFifo<memref<16xi32>>
+}
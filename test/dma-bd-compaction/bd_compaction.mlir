@@ -0,0 +1,96 @@
+//===- bd_compaction.mlir --------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-dma-bd-compaction %s | FileCheck %s
+// RUN: aie-opt --aie-dma-bd-compaction="report=true" %s -o /dev/null 2>&1 | FileCheck --check-prefix=REPORT %s
+// RUN: aie-opt --aie-dma-bd-compaction --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck --check-prefix=STATS %s
+
+// The cycle of MM2S channel 0 repeats the BDs of "a" and "b" twice and keeps
+// one period. MM2S channel 1 then runs an equivalent cycle and starts at the
+// same BDs. The cycle of S2MM channel 0 uses other locks and is kept.
+
+// CHECK: AIE.mem(%{{.*}}) {
+// CHECK:   AIE.dmaStart(MM2S, 0, ^[[A:bb[0-9]+]], ^[[CH1:bb[0-9]+]])
+// CHECK: ^[[A]]:
+// CHECK:   AIE.dmaBd(<%[[BUFA:.*]] : memref<16xi32>, 0, 16>, 0)
+// CHECK:   AIE.nextBd ^[[B:bb[0-9]+]]
+// CHECK: ^[[B]]:
+// CHECK:   AIE.dmaBd(<%[[BUFB:.*]] : memref<16xi32>, 0, 16>, 0)
+// CHECK:   AIE.nextBd ^[[A]]
+// CHECK: ^[[CH1]]:
+// CHECK:   AIE.dmaStart(MM2S, 1, ^[[A]], ^[[CH2:bb[0-9]+]])
+// CHECK: ^[[CH2]]:
+// CHECK:   AIE.dmaStart(S2MM, 0, ^[[C:bb[0-9]+]], ^[[END:bb[0-9]+]])
+// CHECK: ^[[C]]:
+// CHECK:   AIE.dmaBd(<%[[BUFA]] : memref<16xi32>, 0, 16>, 0)
+// CHECK:   AIE.nextBd ^[[C]]
+// CHECK: ^[[END]]:
+// CHECK:   AIE.end
+
+// REPORT: remark: saved 4 of 7 BDs in tile (1, 3)
+
+// STATS: (S) 4 bds-saved
+
+module @bd_compaction {
+ AIE.device(xcve2302) {
+  %t13 = AIE.tile(1, 3)
+  %a = AIE.buffer(%t13) { sym_name = "a" } : memref<16xi32>
+  %b = AIE.buffer(%t13) { sym_name = "b" } : memref<16xi32>
+  %prod = AIE.lock(%t13, 0) { init = 2 : i32, sym_name = "prod" }
+  %cons = AIE.lock(%t13, 1) { init = 0 : i32, sym_name = "cons" }
+  %in_prod = AIE.lock(%t13, 2) { init = 1 : i32, sym_name = "in_prod" }
+  %in_cons = AIE.lock(%t13, 3) { init = 0 : i32, sym_name = "in_cons" }
+
+  %m13 = AIE.mem(%t13) {
+      %dma0 = AIE.dmaStart(MM2S, 0, ^bd0, ^ch1)
+    ^bd0:
+      AIE.useLock(%cons, AcquireGreaterEqual, 1)
+      AIE.dmaBd(<%a : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%prod, Release, 1)
+      AIE.nextBd ^bd1
+    ^bd1:
+      AIE.useLock(%cons, AcquireGreaterEqual, 1)
+      AIE.dmaBd(<%b : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%prod, Release, 1)
+      AIE.nextBd ^bd2
+    ^bd2:
+      AIE.useLock(%cons, AcquireGreaterEqual, 1)
+      AIE.dmaBd(<%a : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%prod, Release, 1)
+      AIE.nextBd ^bd3
+    ^bd3:
+      AIE.useLock(%cons, AcquireGreaterEqual, 1)
+      AIE.dmaBd(<%b : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%prod, Release, 1)
+      AIE.nextBd ^bd0
+    ^ch1:
+      %dma1 = AIE.dmaStart(MM2S, 1, ^bd4, ^ch2)
+    ^bd4:
+      AIE.useLock(%cons, AcquireGreaterEqual, 1)
+      AIE.dmaBd(<%a : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%prod, Release, 1)
+      AIE.nextBd ^bd5
+    ^bd5:
+      AIE.useLock(%cons, AcquireGreaterEqual, 1)
+      AIE.dmaBd(<%b : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%prod, Release, 1)
+      AIE.nextBd ^bd4
+    ^ch2:
+      %dma2 = AIE.dmaStart(S2MM, 0, ^bd6, ^end)
+    ^bd6:
+      AIE.useLock(%in_prod, AcquireGreaterEqual, 1)
+      AIE.dmaBd(<%a : memref<16xi32>, 0, 16>, 0)
+      AIE.useLock(%in_cons, Release, 1)
+      AIE.nextBd ^bd6
+    ^end:
+      AIE.end
+  }
+ }
+}
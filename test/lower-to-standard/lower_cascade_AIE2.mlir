@@ -0,0 +1,58 @@
+//===- lower_cascade_AIE2.mlir ---------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-objectFifo-stateful-transform="cascade=true" %s | aie-opt --aie-standard-lowering="tilecol=1 tilerow=3" | FileCheck --check-prefix=CHECK13 %s
+// RUN: aie-opt --aie-objectFifo-stateful-transform="cascade=true" %s | aie-opt --aie-standard-lowering="tilecol=2 tilerow=3" | FileCheck --check-prefix=CHECK23 %s
+
+// The 512-bit cascade values of AIE2 are passed to the AIE2 cascade
+// intrinsics as vectors of 16 words.
+
+// CHECK13: func.func private @llvm.aie2.mcd.write.vec(vector<16xi32>, i32)
+// CHECK13: func.func @core_1_3() {
+// CHECK13:   %[[BCAST:.*]] = vector.broadcast %{{.*}} : i512 to vector<1xi512>
+// CHECK13:   %[[VEC:.*]] = vector.bitcast %[[BCAST]] : vector<1xi512> to vector<16xi32>
+// CHECK13:   %[[EN:.*]] = arith.constant 1 : i32
+// CHECK13:   call @llvm.aie2.mcd.write.vec(%[[VEC]], %[[EN]]) : (vector<16xi32>, i32) -> ()
+
+// CHECK23: func.func private @llvm.aie2.scd.read.vec(i32) -> vector<16xi32>
+// CHECK23: func.func @core_2_3() {
+// CHECK23:   %[[EN:.*]] = arith.constant 1 : i32
+// CHECK23:   %[[VEC:.*]] = call @llvm.aie2.scd.read.vec(%[[EN]]) : (i32) -> vector<16xi32>
+// CHECK23:   %[[WIDE:.*]] = vector.bitcast %[[VEC]] : vector<16xi32> to vector<1xi512>
+// CHECK23:   %[[VAL:.*]] = vector.extract %[[WIDE]][0] : vector<1xi512>
+// CHECK23:   arith.trunci %[[VAL]] : i512 to i32
+
+module @lower_cascade_AIE2 {
+ AIE.device(xcve2802) {
+  %tile13 = AIE.tile(1, 3)
+  %tile23 = AIE.tile(2, 3)
+
+  AIE.objectFifo @cascade (%tile13, {%tile23}, 2 : i32) : !AIE.objectFifo<memref<2xi32>>
+
+  %core13 = AIE.core(%tile13) {
+    %c0 = arith.constant 0 : index
+    %v = arith.constant 7 : i32
+    %sub = AIE.objectFifo.acquire @cascade (Produce, 1) : !AIE.objectFifoSubview<memref<2xi32>>
+    %elem = AIE.objectFifo.subview.access %sub[0] : !AIE.objectFifoSubview<memref<2xi32>> -> memref<2xi32>
+    memref.store %v, %elem[%c0] : memref<2xi32>
+    AIE.objectFifo.release @cascade (Produce, 1)
+    AIE.end
+  }
+
+  %core23 = AIE.core(%tile23) {
+    %c0 = arith.constant 0 : index
+    %sub = AIE.objectFifo.acquire @cascade (Consume, 1) : !AIE.objectFifoSubview<memref<2xi32>>
+    %elem = AIE.objectFifo.subview.access %sub[0] : !AIE.objectFifoSubview<memref<2xi32>> -> memref<2xi32>
+    %x = memref.load %elem[%c0] : memref<2xi32>
+    AIE.objectFifo.release @cascade (Consume, 1)
+    AIE.end
+  }
+ }
+}
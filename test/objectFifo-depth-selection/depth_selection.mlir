@@ -0,0 +1,124 @@
+//===- depth_selection.mlir ------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-objectFifo-depth-selection %s | FileCheck %s
+// RUN: aie-opt --aie-objectFifo-depth-selection="dry-run=true" %s 2>&1 | FileCheck --check-prefix=DRY %s
+// RUN: aie-opt --aie-objectFifo-depth-selection --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck --check-prefix=STATS %s
+
+// @of_shared is held by its producer and its consumer at the same time, which
+// acquire 1 and 2 elements. @of_split is split between (1, 2) and (3, 3), and
+// its cores are faster than the DMA: about 256 cycles per element. A transfer
+// takes 32 + 2 * 3 + 256 cycles, so each core needs 2 more elements than it
+// acquires. @of_big needs 4 elements in (5, 2) for the same reason, but only 3
+// elements of 16KB and the stack fit in the memory of the tile.
+
+// DRY: remark: depth 4 -> 3 in tile (1, 2)
+// DRY: remark: depth 2 -> 3 in tile (1, 2)
+// DRY: remark: depth 3 -> 4 in tile (3, 3)
+// DRY: remark: depth 3 -> 3 in tile (5, 2)
+// DRY: remark: depth 2 -> 3 in tile (7, 3)
+// DRY: AIE.objectFifo @of_shared({{.*}}, {%{{.*}}}, 4 : i32)
+// DRY: AIE.objectFifo @of_split({{.*}}, {%{{.*}}}, 2 : i32)
+// DRY: AIE.objectFifo @of_big({{.*}}, {%{{.*}}}, 2 : i32)
+
+// CHECK: AIE.objectFifo @of_shared({{.*}}, {%{{.*}}}, 3 : i32)
+// CHECK: AIE.objectFifo @of_split({{.*}}, {%{{.*}}}, [3 : i32, 4 : i32])
+// CHECK: AIE.objectFifo @of_big({{.*}}, {%{{.*}}}, [3 : i32, 3 : i32])
+
+// STATS: (S) 3 changed-objectFifos
+
+module @depth_selection {
+ AIE.device(xcve2302) {
+  func.func private @kernel(memref<256xi32>) -> ()
+
+  %t12 = AIE.tile(1, 2)
+  %t13 = AIE.tile(1, 3)
+  %t33 = AIE.tile(3, 3)
+  %t52 = AIE.tile(5, 2)
+  %t73 = AIE.tile(7, 3)
+
+  AIE.objectFifo @of_shared (%t12, {%t13}, 4 : i32) : !AIE.objectFifo<memref<256xi32>>
+  AIE.objectFifo @of_split (%t12, {%t33}, 2 : i32) : !AIE.objectFifo<memref<256xi32>>
+  AIE.objectFifo @of_big (%t52, {%t73}, 2 : i32) : !AIE.objectFifo<memref<4096xi32>>
+
+  %core12 = AIE.core(%t12) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c16 = arith.constant 16 : index
+    %v = arith.constant 7 : i32
+    scf.for %i = %c0 to %c16 step %c1 {
+      %sub = AIE.objectFifo.acquire @of_shared (Produce, 1) : !AIE.objectFifoSubview<memref<256xi32>>
+      %elem = AIE.objectFifo.subview.access %sub[0] : !AIE.objectFifoSubview<memref<256xi32>> -> memref<256xi32>
+      func.call @kernel(%elem) : (memref<256xi32>) -> ()
+      AIE.objectFifo.release @of_shared (Produce, 1)
+    }
+    scf.for %i = %c0 to %c16 step %c1 {
+      %sub = AIE.objectFifo.acquire @of_split (Produce, 1) : !AIE.objectFifoSubview<memref<256xi32>>
+      %elem = AIE.objectFifo.subview.access %sub[0] : !AIE.objectFifoSubview<memref<256xi32>> -> memref<256xi32>
+      memref.store %v, %elem[%c0] : memref<256xi32>
+      AIE.objectFifo.release @of_split (Produce, 1)
+    }
+    AIE.end
+  }
+
+  %core13 = AIE.core(%t13) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c15 = arith.constant 15 : index
+    scf.for %i = %c0 to %c15 step %c1 {
+      %sub = AIE.objectFifo.acquire @of_shared (Consume, 2) : !AIE.objectFifoSubview<memref<256xi32>>
+      %elem = AIE.objectFifo.subview.access %sub[1] : !AIE.objectFifoSubview<memref<256xi32>> -> memref<256xi32>
+      func.call @kernel(%elem) : (memref<256xi32>) -> ()
+      AIE.objectFifo.release @of_shared (Consume, 1)
+    }
+    AIE.end
+  }
+
+  %core33 = AIE.core(%t33) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c15 = arith.constant 15 : index
+    scf.for %i = %c0 to %c15 step %c1 {
+      %sub = AIE.objectFifo.acquire @of_split (Consume, 2) : !AIE.objectFifoSubview<memref<256xi32>>
+      %elem = AIE.objectFifo.subview.access %sub[1] : !AIE.objectFifoSubview<memref<256xi32>> -> memref<256xi32>
+      %x = memref.load %elem[%c0] : memref<256xi32>
+      AIE.objectFifo.release @of_split (Consume, 1)
+    }
+    AIE.end
+  }
+
+  %core52 = AIE.core(%t52) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c16 = arith.constant 16 : index
+    %v = arith.constant 7 : i32
+    scf.for %i = %c0 to %c16 step %c1 {
+      %sub = AIE.objectFifo.acquire @of_big (Produce, 2) : !AIE.objectFifoSubview<memref<4096xi32>>
+      %elem = AIE.objectFifo.subview.access %sub[0] : !AIE.objectFifoSubview<memref<4096xi32>> -> memref<4096xi32>
+      memref.store %v, %elem[%c0] : memref<4096xi32>
+      AIE.objectFifo.release @of_big (Produce, 1)
+    }
+    AIE.end
+  }
+
+  %core73 = AIE.core(%t73) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c16 = arith.constant 16 : index
+    scf.for %i = %c0 to %c16 step %c1 {
+      %sub = AIE.objectFifo.acquire @of_big (Consume, 1) : !AIE.objectFifoSubview<memref<4096xi32>>
+      %elem = AIE.objectFifo.subview.access %sub[0] : !AIE.objectFifoSubview<memref<4096xi32>> -> memref<4096xi32>
+      %x = memref.load %elem[%c0] : memref<4096xi32>
+      AIE.objectFifo.release @of_big (Consume, 1)
+    }
+    AIE.end
+  }
+ }
+}
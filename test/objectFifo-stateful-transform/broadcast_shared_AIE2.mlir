@@ -0,0 +1,110 @@
+//===- broadcast_shared_AIE2.mlir ------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-objectFifo-stateful-transform %s | FileCheck %s
+// RUN: aie-opt --aie-objectFifo-stateful-transform --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck --check-prefix=STATS %s
+
+// On AIE2 a core accesses its own memory and the memories of the tiles west,
+// north and south of it. Tile(3, 4) (east) and tile(2, 5) (north) can
+// therefore access the memory of tile(2, 4), so they read the elements of the
+// broadcast in place, each with its own pair of locks. Only tile(5, 5) gets a
+// copy through the DMA of tile(2, 4).
+
+// CHECK: %[[T24:.*]] = AIE.tile(2, 4)
+// CHECK: %[[T55:.*]] = AIE.tile(5, 5)
+// CHECK-NOT: of_0_cons
+// CHECK-NOT: of_1_cons
+// CHECK: AIE.flow(%[[T24]], DMA : 0, %[[T55]], DMA : 0)
+// CHECK: %[[B0:.*]] = AIE.buffer(%[[T24]]) {sym_name = "of_buff_0"} : memref<16xi32>
+// CHECK: %[[B1:.*]] = AIE.buffer(%[[T24]]) {sym_name = "of_buff_1"} : memref<16xi32>
+// CHECK: %[[PROD:.*]] = AIE.lock(%[[T24]], 0) {init = 2 : i32, sym_name = "of_prod_lock"}
+// CHECK: %[[CONS:.*]] = AIE.lock(%[[T24]], 1) {init = 0 : i32, sym_name = "of_cons_lock"}
+// CHECK: %[[PROD0:.*]] = AIE.lock(%[[T24]], 2) {init = 2 : i32, sym_name = "of_0_prod_lock"}
+// CHECK: %[[CONS0:.*]] = AIE.lock(%[[T24]], 3) {init = 0 : i32, sym_name = "of_0_cons_lock"}
+// CHECK: %[[PROD1:.*]] = AIE.lock(%[[T24]], 4) {init = 2 : i32, sym_name = "of_1_prod_lock"}
+// CHECK: %[[CONS1:.*]] = AIE.lock(%[[T24]], 5) {init = 0 : i32, sym_name = "of_1_cons_lock"}
+// CHECK: AIE.buffer(%[[T55]]) {sym_name = "of_2_cons_buff_0"}
+// CHECK: AIE.core(%[[T24]])
+// CHECK:   AIE.useLock(%[[PROD]], AcquireGreaterEqual, 1)
+// CHECK:   AIE.useLock(%[[PROD0]], AcquireGreaterEqual, 1)
+// CHECK:   AIE.useLock(%[[PROD1]], AcquireGreaterEqual, 1)
+// CHECK:   func.call @produce(%[[B0]])
+// CHECK:   AIE.useLock(%[[CONS]], Release, 1)
+// CHECK:   AIE.useLock(%[[CONS0]], Release, 1)
+// CHECK:   AIE.useLock(%[[CONS1]], Release, 1)
+// CHECK: AIE.core(%[[T34:.*]])
+// CHECK-NOT: AIE.useLock(%[[CONS1]]
+// CHECK:   AIE.useLock(%[[CONS0]], AcquireGreaterEqual, 1)
+// CHECK:   func.call @consume(%[[B0]])
+// CHECK:   AIE.useLock(%[[PROD0]], Release, 1)
+// CHECK-NOT: AIE.useLock(%[[PROD1]]
+// CHECK: AIE.core(%[[T25:.*]])
+// CHECK-NOT: AIE.useLock(%[[CONS0]]
+// CHECK:   AIE.useLock(%[[CONS1]], AcquireGreaterEqual, 1)
+// CHECK:   func.call @consume(%[[B0]])
+// CHECK:   AIE.useLock(%[[PROD1]], Release, 1)
+// CHECK: AIE.mem(%[[T24]])
+// CHECK:   AIE.dmaStart(MM2S, 0
+// CHECK:   AIE.useLock(%[[CONS]], AcquireGreaterEqual, 1)
+// CHECK:   AIE.dmaBd(<%[[B0]] : memref<16xi32>, 0, 16>, 0)
+// CHECK:   AIE.useLock(%[[PROD]], Release, 1)
+
+// STATS: 1 shared-broadcasts
+
+module @broadcast_shared {
+  AIE.device(xcve2802) {
+    %tile24 = AIE.tile(2, 4)
+    %tile34 = AIE.tile(3, 4)
+    %tile25 = AIE.tile(2, 5)
+    %tile55 = AIE.tile(5, 5)
+
+    AIE.objectFifo @of (%tile24, {%tile34, %tile25, %tile55}, 2 : i32) : !AIE.objectFifo<memref<16xi32>>
+
+    func.func @produce(%buf : memref<16xi32>) -> () {
+      return
+    }
+
+    func.func @consume(%buf : memref<16xi32>) -> () {
+      return
+    }
+
+    %core24 = AIE.core(%tile24) {
+      %subview = AIE.objectFifo.acquire @of (Produce, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+      %elem0 = AIE.objectFifo.subview.access %subview[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      func.call @produce(%elem0) : (memref<16xi32>) -> ()
+      AIE.objectFifo.release @of (Produce, 1)
+      AIE.end
+    }
+
+    %core34 = AIE.core(%tile34) {
+      %subview = AIE.objectFifo.acquire @of (Consume, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+      %elem0 = AIE.objectFifo.subview.access %subview[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      func.call @consume(%elem0) : (memref<16xi32>) -> ()
+      AIE.objectFifo.release @of (Consume, 1)
+      AIE.end
+    }
+
+    %core25 = AIE.core(%tile25) {
+      %subview = AIE.objectFifo.acquire @of (Consume, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+      %elem0 = AIE.objectFifo.subview.access %subview[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      func.call @consume(%elem0) : (memref<16xi32>) -> ()
+      AIE.objectFifo.release @of (Consume, 1)
+      AIE.end
+    }
+
+    %core55 = AIE.core(%tile55) {
+      %subview = AIE.objectFifo.acquire @of (Consume, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+      %elem0 = AIE.objectFifo.subview.access %subview[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      func.call @consume(%elem0) : (memref<16xi32>) -> ()
+      AIE.objectFifo.release @of (Consume, 1)
+      AIE.end
+    }
+  }
+}
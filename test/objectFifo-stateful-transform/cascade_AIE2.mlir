@@ -0,0 +1,82 @@
+//===- cascade_AIE2.mlir ---------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-objectFifo-stateful-transform="cascade=true" %s | FileCheck %s --implicit-check-not="{{cascade_.*lock}}"
+// RUN: aie-opt --aie-objectFifo-stateful-transform="cascade=true" --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck --check-prefix=STATS %s
+// RUN: aie-opt --aie-objectFifo-stateful-transform %s | FileCheck --check-prefix=DEFAULT %s
+
+// Tile(2, 3) is the cascade neighbour of tile(1, 3), so with cascade=true the
+// objectFifo between them is lowered to the cascade stream, with one buffer
+// on each tile and no locks. Tile(1, 4) is not a cascade neighbour and keeps
+// the default lowering. The elements are packed into the 512-bit cascade
+// values of AIE2.
+
+// CHECK: %[[PROD:.*]] = AIE.buffer(%{{.*}}) {sym_name = "cascade_buff_0"} : memref<2xi32>
+// CHECK: %[[CONS:.*]] = AIE.buffer(%{{.*}}) {sym_name = "cascade_cons_buff_0"} : memref<2xi32>
+// CHECK: AIE.core
+// CHECK:   func.call @produce(%[[PROD]])
+// CHECK:   %[[ZERO:.*]] = arith.constant 0 : i512
+// CHECK:   %[[E0:.*]] = memref.load %[[PROD]][%{{.*}}] : memref<2xi32>
+// CHECK:   %[[X0:.*]] = arith.extui %[[E0]] : i32 to i512
+// CHECK:   %[[V0:.*]] = arith.ori %[[ZERO]], %[[X0]] : i512
+// CHECK:   %[[E1:.*]] = memref.load %[[PROD]][%{{.*}}] : memref<2xi32>
+// CHECK:   %[[X1:.*]] = arith.extui %[[E1]] : i32 to i512
+// CHECK:   %[[S1:.*]] = arith.constant 32 : i512
+// CHECK:   %[[SH1:.*]] = arith.shli %[[X1]], %[[S1]] : i512
+// CHECK:   %[[V1:.*]] = arith.ori %[[V0]], %[[SH1]] : i512
+// CHECK:   AIE.putCascade(%[[V1]] : i512)
+// CHECK: AIE.core
+// CHECK:   %[[IN:.*]] = AIE.getCascade() : i512
+// CHECK:   %[[T0:.*]] = arith.trunci %[[IN]] : i512 to i32
+// CHECK:   memref.store %[[T0]], %[[CONS]][%{{.*}}] : memref<2xi32>
+// CHECK:   %[[U1:.*]] = arith.shrui %[[IN]], %{{.*}} : i512
+// CHECK:   %[[T1:.*]] = arith.trunci %[[U1]] : i512 to i32
+// CHECK:   memref.store %[[T1]], %[[CONS]][%{{.*}}] : memref<2xi32>
+// CHECK:   func.call @consume(%[[CONS]])
+
+// STATS: 1 cascade-objectFifos
+
+// DEFAULT-NOT: AIE.putCascade
+// DEFAULT: AIE.buffer(%{{.*}}) {sym_name = "cascade_buff_0"} : memref<2xi32>
+// DEFAULT: AIE.buffer(%{{.*}}) {sym_name = "cascade_buff_1"} : memref<2xi32>
+
+module @cascade {
+    AIE.device(xcve2802) {
+        %tile13 = AIE.tile(1, 3)
+        %tile14 = AIE.tile(1, 4)
+        %tile23 = AIE.tile(2, 3)
+
+        AIE.objectFifo @cascade (%tile13, {%tile23}, 2 : i32) : !AIE.objectFifo<memref<2xi32>>
+        AIE.objectFifo @of (%tile13, {%tile14}, 2 : i32) : !AIE.objectFifo<memref<2xi32>>
+
+        func.func @produce(%buf : memref<2xi32>) -> () {
+            return
+        }
+        func.func @consume(%buf : memref<2xi32>) -> () {
+            return
+        }
+
+        %core13 = AIE.core(%tile13) {
+            %subview = AIE.objectFifo.acquire @cascade (Produce, 1) : !AIE.objectFifoSubview<memref<2xi32>>
+            %elem = AIE.objectFifo.subview.access %subview[0] : !AIE.objectFifoSubview<memref<2xi32>> -> memref<2xi32>
+            func.call @produce(%elem) : (memref<2xi32>) -> ()
+            AIE.objectFifo.release @cascade (Produce, 1)
+            AIE.end
+        }
+
+        %core23 = AIE.core(%tile23) {
+            %subview = AIE.objectFifo.acquire @cascade (Consume, 1) : !AIE.objectFifoSubview<memref<2xi32>>
+            %elem = AIE.objectFifo.subview.access %subview[0] : !AIE.objectFifoSubview<memref<2xi32>> -> memref<2xi32>
+            func.call @consume(%elem) : (memref<2xi32>) -> ()
+            AIE.objectFifo.release @cascade (Consume, 1)
+            AIE.end
+        }
+    }
+}
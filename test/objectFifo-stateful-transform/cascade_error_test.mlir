@@ -0,0 +1,28 @@
+//===- cascade_error_test.mlir ---------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: not aie-opt --aie-objectFifo-stateful-transform %s |& FileCheck %s
+
+// CHECK: error: 'AIE.objectFifo' op cannot be lowered to a cascade: its consumer is not the cascade neighbour of its producer
+
+module @cascade_error {
+    AIE.device(xcve2302) {
+        %tile13 = AIE.tile(1, 3)
+        %tile33 = AIE.tile(3, 3)
+        %core13 = AIE.core(%tile13) {
+            AIE.end
+        }
+        %core33 = AIE.core(%tile33) {
+            AIE.end
+        }
+
+        AIE.objectFifo @cascade (%tile13, {%tile33}, 2 : i32) {cascade} : !AIE.objectFifo<memref<16xi32>>
+    }
+}
@@ -0,0 +1,65 @@
+//===- dynamic_index_AIE1.mlir ---------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-objectFifo-stateful-transform="unroll-limit=2" %s | FileCheck %s
+
+// On AIE1 each element has its own lock, so the locks are selected at runtime
+// like the buffers.
+
+// CHECK: %[[BUFF_0:.*]] = AIE.buffer(%{{.*}}) {sym_name = "of_buff_0"} : memref<16xi32>
+// CHECK: %[[BUFF_1:.*]] = AIE.buffer(%{{.*}}) {sym_name = "of_buff_1"} : memref<16xi32>
+// CHECK: %[[BUFF_2:.*]] = AIE.buffer(%{{.*}}) {sym_name = "of_buff_2"} : memref<16xi32>
+// CHECK: %[[LOCK_0:.*]] = AIE.lock(%{{.*}}) {init = 0 : i32, sym_name = "of_lock_0"}
+// CHECK: %[[LOCK_1:.*]] = AIE.lock(%{{.*}}) {init = 0 : i32, sym_name = "of_lock_1"}
+// CHECK: %[[LOCK_2:.*]] = AIE.lock(%{{.*}}) {init = 0 : i32, sym_name = "of_lock_2"}
+// CHECK: AIE.core
+// CHECK: scf.for
+// CHECK:   scf.index_switch %{{.*}}
+// CHECK:   case 1 {
+// CHECK:     AIE.useLock(%[[LOCK_1]], Acquire, 0)
+// CHECK:   case 2 {
+// CHECK:     AIE.useLock(%[[LOCK_2]], Acquire, 0)
+// CHECK:   default {
+// CHECK:     AIE.useLock(%[[LOCK_0]], Acquire, 0)
+// CHECK:   %[[BUFF:.*]] = scf.index_switch %{{.*}} -> memref<16xi32>
+// CHECK:     scf.yield %[[BUFF_1]] : memref<16xi32>
+// CHECK:     scf.yield %[[BUFF_2]] : memref<16xi32>
+// CHECK:     scf.yield %[[BUFF_0]] : memref<16xi32>
+// CHECK:   memref.store %{{.*}}, %[[BUFF]][%{{.*}}] : memref<16xi32>
+// CHECK:   scf.index_switch %{{.*}}
+// CHECK:   case 1 {
+// CHECK:     AIE.useLock(%[[LOCK_1]], Release, 1)
+// CHECK:   case 2 {
+// CHECK:     AIE.useLock(%[[LOCK_2]], Release, 1)
+// CHECK:   default {
+// CHECK:     AIE.useLock(%[[LOCK_0]], Release, 1)
+
+module @dynamic_index_AIE1 {
+ AIE.device(xcvc1902) {
+  %tile12 = AIE.tile(1, 2)
+  %tile13 = AIE.tile(1, 3)
+
+  AIE.objectFifo @of (%tile12, {%tile13}, 3 : i32) : !AIE.objectFifo<memref<16xi32>>
+
+  %core12 = AIE.core(%tile12) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c7 = arith.constant 7 : index
+    %v = arith.constant 7 : i32
+    scf.for %i = %c0 to %c7 step %c1 {
+      %sub = AIE.objectFifo.acquire @of (Produce, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+      %elem = AIE.objectFifo.subview.access %sub[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      memref.store %v, %elem[%c0] : memref<16xi32>
+      AIE.objectFifo.release @of (Produce, 1)
+    }
+    AIE.end
+  }
+ }
+}
@@ -0,0 +1,110 @@
+//===- dynamic_index_AIE2.mlir ---------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-objectFifo-stateful-transform="unroll-limit=4" %s | FileCheck %s --implicit-check-not=dynamic_objectFifo_index
+// RUN: aie-opt --aie-objectFifo-stateful-transform="unroll-limit=4" --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck --check-prefix=STATS %s
+
+// The loops use objectFifos of 3 and 4 elements, which would unroll them 12
+// times. With unroll-limit=4 they stay rolled and the buffers are selected
+// with the iteration modulo the size of each objectFifo. After 25 iterations,
+// both objectFifos continue from their second element.
+
+// CHECK: %[[OF3_0:.*]] = AIE.buffer(%{{.*}}) {sym_name = "of3_buff_0"} : memref<16xi32>
+// CHECK: %[[OF3_1:.*]] = AIE.buffer(%{{.*}}) {sym_name = "of3_buff_1"} : memref<16xi32>
+// CHECK: %[[OF3_2:.*]] = AIE.buffer(%{{.*}}) {sym_name = "of3_buff_2"} : memref<16xi32>
+// CHECK: %[[OF3_PROD:.*]] = AIE.lock(%{{.*}}) {init = 3 : i32, sym_name = "of3_prod_lock"}
+// CHECK: %[[OF4_0:.*]] = AIE.buffer(%{{.*}}) {sym_name = "of4_buff_0"} : memref<16xi32>
+// CHECK: %[[OF4_1:.*]] = AIE.buffer(%{{.*}}) {sym_name = "of4_buff_1"} : memref<16xi32>
+// CHECK: %[[OF4_2:.*]] = AIE.buffer(%{{.*}}) {sym_name = "of4_buff_2"} : memref<16xi32>
+// CHECK: %[[OF4_3:.*]] = AIE.buffer(%{{.*}}) {sym_name = "of4_buff_3"} : memref<16xi32>
+// CHECK: AIE.core
+// CHECK: scf.for %[[IV:.*]] = %[[LB:.*]] to %{{.*}} step %[[STEP:.*]] {
+// CHECK:   AIE.useLock(%[[OF3_PROD]], AcquireGreaterEqual, 1)
+// CHECK:   %[[SIZE:.*]] = arith.constant 3 : index
+// CHECK:   %[[FIRST:.*]] = arith.constant 0 : index
+// CHECK:   %[[SUB:.*]] = arith.subi %[[IV]], %[[LB]] : index
+// CHECK:   %[[ITER:.*]] = arith.divui %[[SUB]], %[[STEP]] : index
+// CHECK:   %[[REM:.*]] = arith.remui %[[ITER]], %[[SIZE]] : index
+// CHECK:   %[[ADVANCE:.*]] = arith.constant 1 : index
+// CHECK:   %[[OFFSET:.*]] = arith.muli %[[REM]], %[[ADVANCE]] : index
+// CHECK:   %[[SUM:.*]] = arith.addi %[[FIRST]], %[[OFFSET]] : index
+// CHECK:   %[[INDEX:.*]] = arith.remui %[[SUM]], %[[SIZE]] : index
+// CHECK:   %[[BUFF:.*]] = scf.index_switch %[[INDEX]] -> memref<16xi32>
+// CHECK:   case 1 {
+// CHECK:     scf.yield %[[OF3_1]] : memref<16xi32>
+// CHECK:   case 2 {
+// CHECK:     scf.yield %[[OF3_2]] : memref<16xi32>
+// CHECK:   default {
+// CHECK:     scf.yield %[[OF3_0]] : memref<16xi32>
+// CHECK:   memref.store %{{.*}}, %[[BUFF]][%{{.*}}] : memref<16xi32>
+// CHECK:   scf.index_switch %{{.*}} -> memref<16xi32>
+// CHECK:     scf.yield %[[OF4_1]] : memref<16xi32>
+// CHECK:     scf.yield %[[OF4_2]] : memref<16xi32>
+// CHECK:     scf.yield %[[OF4_3]] : memref<16xi32>
+// CHECK:     scf.yield %[[OF4_0]] : memref<16xi32>
+// CHECK: }
+// CHECK: AIE.useLock(%[[OF3_PROD]], AcquireGreaterEqual, 1)
+// CHECK: memref.store %{{.*}}, %[[OF3_1]][%{{.*}}] : memref<16xi32>
+// CHECK: memref.store %{{.*}}, %[[OF4_1]][%{{.*}}] : memref<16xi32>
+
+// STATS: (S) 2 dynamic-loops
+
+module @dynamic_index_AIE2 {
+ AIE.device(xcve2302) {
+  %tile12 = AIE.tile(1, 2)
+  %tile13 = AIE.tile(1, 3)
+
+  AIE.objectFifo @of3 (%tile12, {%tile13}, 3 : i32) : !AIE.objectFifo<memref<16xi32>>
+  AIE.objectFifo @of4 (%tile12, {%tile13}, 4 : i32) : !AIE.objectFifo<memref<16xi32>>
+
+  %core12 = AIE.core(%tile12) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c25 = arith.constant 25 : index
+    %v = arith.constant 7 : i32
+    scf.for %i = %c0 to %c25 step %c1 {
+      %sub3 = AIE.objectFifo.acquire @of3 (Produce, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+      %elem3 = AIE.objectFifo.subview.access %sub3[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      memref.store %v, %elem3[%c0] : memref<16xi32>
+      %sub4 = AIE.objectFifo.acquire @of4 (Produce, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+      %elem4 = AIE.objectFifo.subview.access %sub4[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      memref.store %v, %elem4[%c0] : memref<16xi32>
+      AIE.objectFifo.release @of3 (Produce, 1)
+      AIE.objectFifo.release @of4 (Produce, 1)
+    }
+    %sub3 = AIE.objectFifo.acquire @of3 (Produce, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+    %elem3 = AIE.objectFifo.subview.access %sub3[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+    memref.store %v, %elem3[%c0] : memref<16xi32>
+    %sub4 = AIE.objectFifo.acquire @of4 (Produce, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+    %elem4 = AIE.objectFifo.subview.access %sub4[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+    memref.store %v, %elem4[%c0] : memref<16xi32>
+    AIE.objectFifo.release @of3 (Produce, 1)
+    AIE.objectFifo.release @of4 (Produce, 1)
+    AIE.end
+  }
+
+  %core13 = AIE.core(%tile13) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c26 = arith.constant 26 : index
+    scf.for %i = %c0 to %c26 step %c1 {
+      %sub3 = AIE.objectFifo.acquire @of3 (Consume, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+      %elem3 = AIE.objectFifo.subview.access %sub3[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      %x = memref.load %elem3[%c0] : memref<16xi32>
+      %sub4 = AIE.objectFifo.acquire @of4 (Consume, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+      %elem4 = AIE.objectFifo.subview.access %sub4[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      %y = memref.load %elem4[%c0] : memref<16xi32>
+      AIE.objectFifo.release @of3 (Consume, 1)
+      AIE.objectFifo.release @of4 (Consume, 1)
+    }
+    AIE.end
+  }
+ }
+}
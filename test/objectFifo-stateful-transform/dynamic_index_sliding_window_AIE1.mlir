@@ -0,0 +1,48 @@
+//===- dynamic_index_sliding_window_AIE1.mlir ------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-objectFifo-stateful-transform="unroll-limit=2" %s | FileCheck %s --implicit-check-not=scf.index_switch
+
+// The loop keeps a sliding window over the objectFifo: the first iteration
+// acquires two elements while the later ones only acquire one new element.
+// The lowering of the first iteration cannot be reused, so the loop is
+// unrolled even though that exceeds unroll-limit=2.
+
+// CHECK: %[[LOCK_0:.*]] = AIE.lock(%{{.*}}) {init = 0 : i32, sym_name = "of_lock_0"}
+// CHECK: %[[LOCK_1:.*]] = AIE.lock(%{{.*}}) {init = 0 : i32, sym_name = "of_lock_1"}
+// CHECK: AIE.core
+// CHECK: scf.for
+// CHECK:   AIE.useLock(%[[LOCK_0]], Acquire, 1)
+// CHECK:   AIE.useLock(%[[LOCK_1]], Acquire, 1)
+// CHECK:   AIE.useLock(%[[LOCK_0]], Release, 0)
+
+module @dynamic_index_sliding_window_AIE1 {
+ AIE.device(xcvc1902) {
+  %tile12 = AIE.tile(1, 2)
+  %tile13 = AIE.tile(1, 3)
+
+  AIE.objectFifo @of (%tile12, {%tile13}, 3 : i32) : !AIE.objectFifo<memref<16xi32>>
+
+  %core13 = AIE.core(%tile13) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c7 = arith.constant 7 : index
+    scf.for %i = %c0 to %c7 step %c1 {
+      %sub = AIE.objectFifo.acquire @of (Consume, 2) : !AIE.objectFifoSubview<memref<16xi32>>
+      %elem0 = AIE.objectFifo.subview.access %sub[0] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      %elem1 = AIE.objectFifo.subview.access %sub[1] : !AIE.objectFifoSubview<memref<16xi32>> -> memref<16xi32>
+      %x = memref.load %elem0[%c0] : memref<16xi32>
+      %y = memref.load %elem1[%c0] : memref<16xi32>
+      AIE.objectFifo.release @of (Consume, 1)
+    }
+    AIE.end
+  }
+ }
+}
@@ -0,0 +1,44 @@
+//===- link_test_dimensions_AIE2.mlir --------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-objectFifo-stateful-transform %s | FileCheck %s
+
+// The mem tile transposes the 8x8 elements of @of2 while it sends them.
+// Tile(2, 2) receives them as they are, and tile(2, 3) writes them as 32 pairs
+// of integers, the first of each pair in the first half of its buffer.
+
+// CHECK: %[[T21:.*]] = AIE.tile(2, 1)
+// CHECK: %[[T22:.*]] = AIE.tile(2, 2)
+// CHECK: %[[T23:.*]] = AIE.tile(2, 3)
+// CHECK: AIE.memTileDMA(%[[T21]]) {
+// CHECK:   AIE.dmaStart(S2MM, 0, ^bb1, ^bb3)
+// CHECK:   AIE.dmaBd(<%{{.*}} : memref<64xi32>, 0, 64>, 0)
+// CHECK:   AIE.dmaStart(MM2S, 0, ^bb4, ^bb6)
+// CHECK:   AIE.dmaBd(<%{{.*}} : memref<64xi32>, 0, 64>, 0, [<1, 8>, <8, 8>])
+// CHECK:   AIE.dmaBd(<%{{.*}} : memref<64xi32>, 0, 64>, 0, [<1, 8>, <8, 8>])
+// CHECK: AIE.mem(%[[T22]]) {
+// CHECK:   AIE.dmaBd(<%{{.*}} : memref<64xi32>, 0, 64>, 0)
+// CHECK:   AIE.dmaBd(<%{{.*}} : memref<64xi32>, 0, 64>, 0)
+// CHECK: AIE.mem(%[[T23]]) {
+// CHECK:   AIE.dmaBd(<%{{.*}} : memref<64xi32>, 0, 64>, 0, [<1, 32>, <32, 2>])
+// CHECK:   AIE.dmaBd(<%{{.*}} : memref<64xi32>, 0, 64>, 0, [<1, 32>, <32, 2>])
+
+module @link_dimensions_AIE2 {
+    AIE.device(xcve2302) {
+        %tile21 = AIE.tile(2, 1)
+        %tile22 = AIE.tile(2, 2)
+        %tile23 = AIE.tile(2, 3)
+        %tile33 = AIE.tile(3, 3)
+
+        AIE.objectFifo @of1 (%tile33, {%tile21}, 2 : i32) : !AIE.objectFifo<memref<64xi32>>
+        AIE.objectFifo @of2 (%tile21, {%tile22, %tile23}, 2 : i32) toStream [<1, 8>, <8, 8>] fromStream [[], [<1, 32>, <32, 2>]] : !AIE.objectFifo<memref<64xi32>>
+        AIE.objectFifo.link [@of1] -> [@of2] ()
+    }
+}
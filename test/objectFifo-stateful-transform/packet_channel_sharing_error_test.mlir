@@ -0,0 +1,42 @@
+//===- packet_channel_sharing_error_test.mlir ------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: not aie-opt --aie-objectFifo-stateful-transform %s |& FileCheck %s
+
+// Tile(1, 3) releases two elements of @of3 for each element of @of2, so the
+// two objectFifos cannot take turns on a shared DMA channel.
+
+// CHECK: error: 'AIE.objectFifo' op cannot share a DMA channel with 'of2': they are not produced at the same rate
+
+module @packet_channel_sharing_error {
+    AIE.device(xcve2302) {
+        %tile13 = AIE.tile(1, 3)
+        %tile33 = AIE.tile(3, 3)
+        %tile43 = AIE.tile(4, 3)
+        %tile53 = AIE.tile(5, 3)
+
+        AIE.objectFifo @of1 (%tile13, {%tile33}, 2 : i32) : !AIE.objectFifo<memref<16xi32>>
+        AIE.objectFifo @of2 (%tile13, {%tile43}, 2 : i32) : !AIE.objectFifo<memref<16xi32>>
+        AIE.objectFifo @of3 (%tile13, {%tile53}, 2 : i32) : !AIE.objectFifo<memref<16xi32>>
+
+        %core13 = AIE.core(%tile13) {
+            %c0 = arith.constant 0 : index
+            %c1 = arith.constant 1 : index
+            %c4 = arith.constant 4 : index
+            scf.for %it = %c0 to %c4 step %c1 {
+                %subview2 = AIE.objectFifo.acquire @of2 (Produce, 1) : !AIE.objectFifoSubview<memref<16xi32>>
+                AIE.objectFifo.release @of2 (Produce, 1)
+                %subview3 = AIE.objectFifo.acquire @of3 (Produce, 2) : !AIE.objectFifoSubview<memref<16xi32>>
+                AIE.objectFifo.release @of3 (Produce, 2)
+            }
+            AIE.end
+        }
+    }
+}
@@ -0,0 +1,67 @@
+//===- packet_channel_sharing_test.mlir ------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aie-opt --aie-objectFifo-stateful-transform %s | FileCheck %s
+// RUN: aie-opt --aie-objectFifo-stateful-transform --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck --check-prefix=STATS %s
+
+// Tile(1, 3) sends three objectFifos but only has two MM2S channels. @of1
+// keeps channel 0, while @of2 and @of3 share channel 1 as packet flows.
+
+// CHECK: %[[T13:.*]] = AIE.tile(1, 3)
+// CHECK: %[[T33:.*]] = AIE.tile(3, 3)
+// CHECK: %[[T34:.*]] = AIE.tile(3, 4)
+// CHECK: %[[T35:.*]] = AIE.tile(3, 5)
+// CHECK: AIE.flow(%[[T13]], DMA : 0, %[[T33]], DMA : 0)
+// CHECK: AIE.packet_flow(0) {
+// CHECK:   AIE.packet_source<%[[T13]], DMA : 1>
+// CHECK:   AIE.packet_dest<%[[T34]], DMA : 0> {drop_header}
+// CHECK: }
+// CHECK: AIE.packet_flow(1) {
+// CHECK:   AIE.packet_source<%[[T13]], DMA : 1>
+// CHECK:   AIE.packet_dest<%[[T35]], DMA : 0> {drop_header}
+// CHECK: }
+// CHECK: %[[OF2_0:.*]] = AIE.buffer(%[[T13]]) {sym_name = "of2_buff_0"}
+// CHECK: %[[OF2_1:.*]] = AIE.buffer(%[[T13]]) {sym_name = "of2_buff_1"}
+// CHECK: %[[OF3_0:.*]] = AIE.buffer(%[[T13]]) {sym_name = "of3_buff_0"}
+// CHECK: %[[OF3_1:.*]] = AIE.buffer(%[[T13]]) {sym_name = "of3_buff_1"}
+// CHECK: AIE.mem(%[[T13]]) {
+// CHECK:   AIE.dmaStart(MM2S, 0, ^bb1, ^{{.*}})
+// CHECK:   AIE.dmaStart(MM2S, 1, ^[[BD0:bb[0-9]+]], ^{{.*}})
+// CHECK: ^[[BD0]]:
+// CHECK:   AIE.dmaBdPacket(0, 0)
+// CHECK:   AIE.dmaBd(<%[[OF2_0]] : memref<16xi32>, 0, 16>, 0)
+// CHECK:   AIE.nextBd ^[[BD1:bb[0-9]+]]
+// CHECK: ^[[BD1]]:
+// CHECK:   AIE.dmaBdPacket(0, 1)
+// CHECK:   AIE.dmaBd(<%[[OF3_0]] : memref<16xi32>, 0, 16>, 0)
+// CHECK:   AIE.nextBd ^[[BD2:bb[0-9]+]]
+// CHECK: ^[[BD2]]:
+// CHECK:   AIE.dmaBdPacket(0, 0)
+// CHECK:   AIE.dmaBd(<%[[OF2_1]] : memref<16xi32>, 0, 16>, 0)
+// CHECK:   AIE.nextBd ^[[BD3:bb[0-9]+]]
+// CHECK: ^[[BD3]]:
+// CHECK:   AIE.dmaBdPacket(0, 1)
+// CHECK:   AIE.dmaBd(<%[[OF3_1]] : memref<16xi32>, 0, 16>, 0)
+// CHECK:   AIE.nextBd ^[[BD0]]
+
+// STATS: 2 packet-objectFifos
+
+module @packet_channel_sharing {
+    AIE.device(xcve2802) {
+        %tile13 = AIE.tile(1, 3)
+        %tile33 = AIE.tile(3, 3)
+        %tile34 = AIE.tile(3, 4)
+        %tile35 = AIE.tile(3, 5)
+
+        AIE.objectFifo @of1 (%tile13, {%tile33}, 2 : i32) : !AIE.objectFifo<memref<16xi32>>
+        AIE.objectFifo @of2 (%tile13, {%tile34}, 2 : i32) : !AIE.objectFifo<memref<16xi32>>
+        AIE.objectFifo @of3 (%tile13, {%tile35}, 2 : i32) : !AIE.objectFifo<memref<16xi32>>
+    }
+}
@@ -0,0 +1,99 @@
+//===- test.cpp -------------------------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2023 Advanced Micro Devices, Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "test_library.h"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <stdlib.h>
+#include <unistd.h>
+#include <xaiengine.h>
+
+#define MLIR_AIE_BATCHED_WRITES
+#include "aie_inc.cpp"
+
+// A batch of writes whose last one fails: lock 100 does not exist.
+int write_then_fail(aie_libxaie_ctx_t *ctx) {
+  __mlir_aie_batch_begin();
+  __mlir_aie_try(XAie_DataMemWrWord(&(ctx->DevInst), XAie_TileLoc(1, 3),
+                                    a_offset, 42));
+  __mlir_aie_try(XAie_LockSetValue(&(ctx->DevInst), XAie_TileLoc(1, 3),
+                                   XAie_LockInit(100, 0)));
+  __mlir_aie_batch_end();
+  return XAIE_OK;
+}
+
+int main(int argc, char *argv[]) {
+  printf("test start.\n");
+
+  aie_libxaie_ctx_t *_xaie = mlir_aie_init_libxaie();
+  mlir_aie_init_device(_xaie);
+
+  mlir_aie_clear_tile_memory(_xaie, 1, 3);
+
+  mlir_aie_configure_cores(_xaie);
+  mlir_aie_configure_switchboxes(_xaie);
+  mlir_aie_configure_dmas(_xaie);
+  mlir_aie_initialize_locks(_xaie);
+
+  int errors = 0;
+
+  // Writes to contiguous words are submitted as a single block write.
+  struct mlir_aie_transaction_stats stats;
+  mlir_aie_start_transaction(_xaie);
+  for (int i = 0; i < 16; i++)
+    mlir_aie_write_buffer_a(_xaie, i, i + 1);
+  if (mlir_aie_submit_transaction(_xaie, &stats)) {
+    errors++;
+    printf("ERROR: transaction failed!\n");
+  }
+  mlir_aie_check("Recorded writes:", stats.recorded, 16, errors);
+  mlir_aie_check("Submitted writes:", stats.submitted, 1, errors);
+  mlir_aie_check("Written words:", stats.writes, 16, errors);
+  for (int i = 0; i < 16; i++)
+    mlir_aie_check("After transaction:", mlir_aie_read_buffer_a(_xaie, i),
+                   i + 1, errors);
+
+  // A failure ends the batch: the writes before it are submitted, and the
+  // next batch starts a new transaction.
+  if (write_then_fail(_xaie) == XAIE_OK) {
+    errors++;
+    printf("ERROR: invalid lock accepted!\n");
+  }
+  if (__mlir_aie_batching) {
+    errors++;
+    printf("ERROR: batch not ended!\n");
+  }
+  mlir_aie_check("After failed batch:", mlir_aie_read_buffer_a(_xaie, 0), 42,
+                 errors);
+  mlir_aie_start_transaction(_xaie);
+  mlir_aie_write_buffer_a(_xaie, 1, 43);
+  if (mlir_aie_submit_transaction(_xaie, &stats)) {
+    errors++;
+    printf("ERROR: transaction failed!\n");
+  }
+  mlir_aie_check("Recorded writes after failed batch:", stats.recorded, 1,
+                 errors);
+  mlir_aie_check("After next batch:", mlir_aie_read_buffer_a(_xaie, 1), 43,
+                 errors);
+
+  int res = 0;
+  if (!errors) {
+    printf("PASS!\n");
+    res = 0;
+  } else {
+    printf("Fail!\n");
+    res = -1;
+  }
+  mlir_aie_deinit_libxaie(_xaie);
+
+  printf("test done.\n");
+  return res;
+}
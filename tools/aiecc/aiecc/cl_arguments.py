@@ -138,6 +138,50 @@ def parse_args():
             default=False,
             action='store_true',
             help='Show progress visualization')
+    parser.add_argument('--routing-cache-dir',
+            dest="routing_cache_dir",
+            default=None,
+            help='Directory used to cache routing solutions between runs')
+    parser.add_argument('--bank-aware-buffers',
+            dest="bank_aware_buffers",
+            default=False,
+            action='store_true',
+            help='Place concurrently accessed buffers in different memory banks')
+    parser.add_argument('--overlay-buffers',
+            dest="overlay_buffers",
+            default=False,
+            action='store_true',
+            help='Let buffers that are never live at the same time share addresses')
+    parser.add_argument('--spill-buffers',
+            dest="spill_buffers",
+            default=False,
+            action='store_true',
+            help='Move buffers of full tiles to the memory of neighbouring tiles')
+    parser.add_argument('--auto-objectfifo-depth',
+            dest="auto_objectfifo_depth",
+            default=False,
+            action='store_true',
+            help='Select the depths of objectFifos from the rates of their producers and consumers')
+    parser.add_argument('--objectfifo-unroll-limit',
+            dest="objectfifo_unroll_limit",
+            default=0,
+            action='store',
+            help='Keep loops that would be unrolled more times than this rolled, and select their objectFifo elements at runtime (default is 0, always unroll)')
+    parser.add_argument('--compact-bds',
+            dest="compact_bds",
+            default=False,
+            action='store_true',
+            help='Reduce the number of BDs used by the DMAs of each tile')
+    parser.add_argument('--config-image',
+            dest="config_image",
+            default=False,
+            action='store_true',
+            help='Also write the configuration of the design to aie_config.bin, for the generic loader of the runtime library')
+    parser.add_argument('--objectfifo-cascade',
+            dest="objectfifo_cascade",
+            default=False,
+            action='store_true',
+            help='Lower objectFifos between cascade neighbours to the cascade stream when possible')
 
 
     opts = parser.parse_args(sys.argv[1:])
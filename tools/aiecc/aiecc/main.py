@@ -249,9 +249,14 @@ class flow_runner:
 
       # Generate the included host interface
       file_physical = os.path.join(self.tmpdirname, 'input_physical.mlir')
-      await self.do_call(task, ['aie-opt', '--aie-create-pathfinder-flows', '--aie-lower-broadcast-packet', '--aie-create-packet-flows', '--aie-lower-multicast', self.file_with_addresses, '-o', file_physical]);
+      pathfinder_pass = '--aie-create-pathfinder-flows'
+      if(opts.routing_cache_dir):
+        pathfinder_pass += '=cache-dir=' + os.path.abspath(opts.routing_cache_dir)
+      await self.do_call(task, ['aie-opt', pathfinder_pass, '--aie-lower-broadcast-packet', '--aie-create-packet-flows', '--aie-lower-multicast', self.file_with_addresses, '-o', file_physical]);
       file_inc_cpp = os.path.join(self.tmpdirname, 'aie_inc.cpp')
       await self.do_call(task, ['aie-translate', '--aie-generate-xaie', file_physical, '-o', file_inc_cpp])
+      if(opts.config_image):
+        await self.do_call(task, ['aie-translate', '--aie-generate-config-image', file_physical, '-o', 'aie_config.bin'])
 
       cmd = ['clang++','-std=c++11']
       if(opts.host_target):
@@ -284,7 +289,7 @@ class flow_runner:
       cmd += ['-L%s' % xaiengine_lib_path]
 
       cmd += ['-I%s' % self.tmpdirname]
-      cmd += ['-fuse-ld=lld','-lm','-lxaiengine']
+      cmd += ['-fuse-ld=lld','-lm','-lxaiengine','-lpthread']
 
       cmd += self.aie_target_defines()
 
@@ -418,16 +423,39 @@ aiesimulator --pkg-dir=${prj_name}/sim --dump-vcd ${vcd_filename}
         progress_bar.task = progress_bar.add_task("[green] MLIR compilation:", total=1, command="1 Worker")
 
         self.file_with_addresses = os.path.join(self.tmpdirname, 'input_with_addresses.mlir')
+        assign_buffers_options = []
+        if(opts.bank_aware_buffers):
+          assign_buffers_options.append('bank-aware=true')
+        if(opts.overlay_buffers):
+          assign_buffers_options.append('overlay=true')
+        if(opts.spill_buffers):
+          assign_buffers_options.append('spill=true')
+        assign_buffers_pass = '--aie-assign-buffer-addresses'
+        if(assign_buffers_options):
+          assign_buffers_pass += '=' + ' '.join(assign_buffers_options)
+        objectFifo_passes = ['--aie-register-objectFifos']
+        if(opts.auto_objectfifo_depth):
+          objectFifo_passes.append('--aie-objectFifo-depth-selection')
+        stateful_transform_options = []
+        if(int(opts.objectfifo_unroll_limit) > 0):
+          stateful_transform_options.append('unroll-limit=' + str(opts.objectfifo_unroll_limit))
+        if(opts.objectfifo_cascade):
+          stateful_transform_options.append('cascade=true')
+        stateful_transform_pass = '--aie-objectFifo-stateful-transform'
+        if(stateful_transform_options):
+          stateful_transform_pass += '=' + ' '.join(stateful_transform_options)
+        objectFifo_passes.append(stateful_transform_pass)
+        if(opts.compact_bds):
+          objectFifo_passes.append('--aie-dma-bd-compaction')
         await self.do_call(progress_bar.task, ['aie-opt',
                                           '--lower-affine',
                                           '--aie-canonicalize-device',
                                           '--aie-assign-lock-ids',
-                                          '--aie-register-objectFifos',
-                                          '--aie-objectFifo-stateful-transform',
+                                          *objectFifo_passes,
                                           '--aie-lower-broadcast-packet',
                                           '--aie-create-packet-flows',
                                           '--aie-lower-multicast',
-                                          '--aie-assign-buffer-addresses',
+                                          assign_buffers_pass,
                                           '-convert-scf-to-cf', opts.filename, '-o', self.file_with_addresses], True)
         t = self.do_run(['aie-translate', '--aie-generate-corelist', self.file_with_addresses])
         cores = eval(t.stdout)